@@ -0,0 +1,123 @@
+#include "bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+
+namespace bench {
+
+namespace {
+
+double seconds_for(const Body& body, std::int64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// JSON string literal; benchmark names and context values are plain ASCII
+std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+void Runner::run(const std::string& name, double items_per_iteration, const Body& body) {
+    if (!selected(name)) {
+        return;
+    }
+
+    // Calibrate: grow the iteration count until one run lasts a tenth of min_time, then
+    // scale it up to the full min_time
+    std::int64_t iterations = 1;
+    double elapsed = seconds_for(body, iterations);
+    while (elapsed < options_.min_time * 0.1 && iterations < (std::int64_t{1} << 40)) {
+        iterations *= 10;
+        elapsed = seconds_for(body, iterations);
+    }
+    if (elapsed > 0.0 && elapsed < options_.min_time) {
+        iterations = std::max<std::int64_t>(
+            1, static_cast<std::int64_t>(iterations * options_.min_time / elapsed));
+    }
+
+    std::vector<double> ns(static_cast<std::size_t>(std::max(1, options_.repetitions)));
+    for (double& t : ns) {
+        t = seconds_for(body, iterations) * 1e9 / static_cast<double>(iterations);
+    }
+    std::nth_element(ns.begin(), ns.begin() + ns.size() / 2, ns.end());
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_iteration = ns[ns.size() / 2];
+    result.items_per_second =
+        items_per_iteration > 0.0 ? items_per_iteration * 1e9 / result.ns_per_iteration : 0.0;
+    results_.push_back(result);
+
+    // Progress goes to stderr so `--json -` keeps stdout machine-readable
+    std::fprintf(stderr, "%-40s %14.1f ns\n", name.c_str(), result.ns_per_iteration);
+}
+
+void Runner::print_table(std::ostream& out) const {
+    out << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "ns/iter"
+        << std::setw(14) << "iterations" << std::setw(16) << "items/s" << "\n";
+    for (const Result& r : results_) {
+        out << std::left << std::setw(40) << r.name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << r.ns_per_iteration << std::setw(14)
+            << r.iterations << std::setw(16) << std::setprecision(0) << r.items_per_second
+            << "\n";
+    }
+}
+
+void Runner::write_json(std::ostream& out,
+                        const std::vector<std::pair<std::string, std::string>>& context) const {
+    out << "{\n  \"context\": {\n";
+    for (std::size_t i = 0; i < context.size(); ++i) {
+        out << "    " << quoted(context[i].first) << ": " << quoted(context[i].second)
+            << (i + 1 < context.size() ? ",\n" : "\n");
+    }
+    out << "  },\n  \"benchmarks\": [\n";
+    out << std::setprecision(17);
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+        const Result& r = results_[i];
+        out << "    {\n"
+            << "      \"name\": " << quoted(r.name) << ",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"repetitions\": " << options_.repetitions << ",\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.ns_per_iteration << ",\n"
+            << "      \"cpu_time\": " << r.ns_per_iteration << ",\n"
+            << "      \"time_unit\": \"ns\"";
+        if (r.items_per_second > 0.0) {
+            out << ",\n      \"items_per_second\": " << r.items_per_second;
+        }
+        out << "\n    }" << (i + 1 < results_.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--min-time" && has_value) {
+            options.min_time = std::stod(argv[++i]);
+        } else if (arg == "--repetitions" && has_value) {
+            options.repetitions = std::stoi(argv[++i]);
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && has_value) {
+            options.json_path = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.min_time > 0.0 && options.repetitions > 0;
+}
+
+} // namespace bench
@@ -0,0 +1,82 @@
+#ifndef FLAPPY_BENCH_BENCH_H
+#define FLAPPY_BENCH_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Minimal self-contained benchmark harness for flappy_bench, so the target builds without
+// fetching anything. Each case is calibrated to a minimum run time, repeated, and reported by
+// its median; the JSON output follows the Google Benchmark schema ("context" + "benchmarks"
+// with real_time / cpu_time / items_per_second) so its comparison tooling works unchanged.
+namespace bench {
+
+// Keep the compiler from optimizing away a value the benchmark computes
+template <class T>
+inline void do_not_optimize(const T& value) {
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+struct Options {
+    double min_time = 0.2;           // seconds per repetition, after calibration
+    int repetitions = 5;             // the median repetition is reported
+    std::string filter;              // run only cases whose name contains this
+    std::string json_path;           // write JSON here; "-" for stdout
+};
+
+struct Result {
+    std::string name;
+    std::int64_t iterations = 0;     // per repetition
+    double ns_per_iteration = 0.0;   // median over repetitions
+    double items_per_second = 0.0;   // 0 when the case counts no items
+};
+
+// One benchmark body: runs `iterations` times back to back. Setup belongs outside it.
+using Body = std::function<void(std::int64_t iterations)>;
+
+class Runner {
+public:
+    explicit Runner(Options options) : options_(std::move(options)) {}
+
+    // Time body; items_per_iteration scales the reported throughput (steps, samples, ...)
+    void run(const std::string& name, double items_per_iteration, const Body& body);
+
+    // Whether `name` passes the --filter option; lets callers skip expensive setup
+    bool selected(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+    // Human-readable table, one line per result
+    void print_table(std::ostream& out) const;
+
+    // Google Benchmark compatible JSON; `context` entries are emitted as strings
+    void write_json(std::ostream& out,
+                    const std::vector<std::pair<std::string, std::string>>& context) const;
+
+private:
+    Options options_;
+    std::vector<Result> results_;
+};
+
+// Parse --min-time, --repetitions, --filter and --json; false on an unknown argument
+bool parse_options(int argc, char** argv, Options& options);
+
+} // namespace bench
+
+#endif // FLAPPY_BENCH_BENCH_H
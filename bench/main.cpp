@@ -0,0 +1,320 @@
+#include "bench.h"
+#include "env_flappy/env_flappy.h"
+#include "env_flappy/vec_env.h"
+#include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/adam.h"
+#include "rl_dqn/dqn_agent.h"
+#include "rl_dqn/fixed_network.h"
+#include "rl_dqn/kernels.h"
+#include "rl_dqn/mapped_replay_buffer.h"
+#include "rl_dqn/network.h"
+#include "rl_dqn/quantized_network.h"
+#include "rl_dqn/replay_buffer.h"
+#include "core/core.h"
+#include "core/rng.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// flappy_bench: headless throughput of the environment, network kernels, optimizer, replay
+// sampling and full training steps, on the default DQNConfig topology. Run with --json PATH
+// to record results for regression tracking between releases.
+
+namespace {
+
+using env_flappy::Action;
+using env_flappy::Observation;
+
+const std::vector<int> kTopology = rl_dqn::DQNConfig().layer_sizes;
+
+// Deterministic pseudo-random inputs in [-1, 1)
+std::vector<float> make_inputs(std::size_t n, std::uint64_t seed) {
+    core::Pcg32 rng(seed);
+    std::vector<float> data(n);
+    for (float& x : data) {
+        x = rng.uniform() * 2.0f - 1.0f;
+    }
+    return data;
+}
+
+Observation random_observation(core::Pcg32& rng) {
+    return {rng.uniform(), rng.uniform() - 0.5f, rng.uniform(), rng.uniform() - 0.5f};
+}
+
+rl_dqn::Experience random_experience(core::Pcg32& rng) {
+    Action action = rng.uniform() < 0.5f ? Action::NO_FLAP : Action::FLAP;
+    return {random_observation(rng), action, rng.uniform(), random_observation(rng),
+            rng.uniform() < 0.05f};
+}
+
+void bench_env(bench::Runner& runner) {
+    runner.run("env/step", 1, [](std::int64_t iterations) {
+        env_flappy::FlappyEnv env(1);
+        core::Pcg32 rng(2);
+        for (std::int64_t i = 0; i < iterations; ++i) {
+            Action action = rng.uniform() < 0.1f ? Action::FLAP : Action::NO_FLAP;
+            env_flappy::StepResult result = env.step(action);
+            bench::do_not_optimize(result);
+            if (result.done) {
+                env.reset(static_cast<std::uint64_t>(i));
+            }
+        }
+    });
+
+    // Branching rollouts: restore a saved state, then roll 16 steps ahead of it
+    runner.run("env/rollout_branch/16", 16, [](std::int64_t iterations) {
+        env_flappy::FlappyEnv env(1);
+        for (int t = 0; t < 30; ++t) {
+            env.step(t % 10 == 0 ? Action::FLAP : Action::NO_FLAP);
+        }
+        const env_flappy::EnvState root = env.save_state();
+        core::Pcg32 rng(2);
+        for (std::int64_t i = 0; i < iterations; ++i) {
+            env.restore_state(root);
+            for (int t = 0; t < 16; ++t) {
+                Action action = rng.uniform() < 0.1f ? Action::FLAP : Action::NO_FLAP;
+                bench::do_not_optimize(env.step(action));
+            }
+        }
+    });
+
+    for (std::size_t num_envs : {16u, 256u}) {
+        runner.run("vec_env/step/" + std::to_string(num_envs), static_cast<double>(num_envs),
+                   [num_envs](std::int64_t iterations) {
+            env_flappy::FlappyVecEnv envs(num_envs, 1);
+            std::vector<Observation> observations(num_envs);
+            std::vector<Action> actions(num_envs);
+            std::vector<float> rewards(num_envs);
+            std::vector<std::uint8_t> dones(num_envs);
+            core::Pcg32 rng(2);
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                for (Action& a : actions) {
+                    a = rng.uniform() < 0.1f ? Action::FLAP : Action::NO_FLAP;
+                }
+                envs.step(actions, observations, rewards, dones);
+                bench::do_not_optimize(observations.data());
+            }
+        });
+    }
+}
+
+// Forward latency and throughput plus backward for one network implementation
+template <class Net>
+void bench_network(bench::Runner& runner, const std::string& prefix, const Net& net) {
+    runner.run(prefix + "/forward/1", 1, [&net](std::int64_t iterations) {
+        std::vector<float> input = make_inputs(rl_dqn::kObservationSize, 3);
+        for (std::int64_t i = 0; i < iterations; ++i) {
+            std::vector<float> q = net.forward(input);
+            bench::do_not_optimize(q.data());
+        }
+    });
+
+    for (int batch : {1, 32, 256}) {
+        runner.run(prefix + "/forward_batch/" + std::to_string(batch), batch,
+                   [&net, batch](std::int64_t iterations) {
+            std::vector<float> inputs = make_inputs(batch * rl_dqn::kObservationSize, 4);
+            rl_dqn::Network::BatchCache cache;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                const float* q = net.forward_batch(inputs, batch, cache);
+                bench::do_not_optimize(q);
+            }
+        });
+    }
+
+    // Forward plus backward, as train() runs them
+    for (int batch : {32, 256}) {
+        runner.run(prefix + "/backward_batch/" + std::to_string(batch), batch,
+                   [&net, batch](std::int64_t iterations) {
+            std::vector<float> inputs = make_inputs(batch * rl_dqn::kObservationSize, 5);
+            std::vector<float> output_gradients = make_inputs(batch * 2, 6);
+            std::vector<float> gradients(net.parameters().size());
+            rl_dqn::Network::BatchCache cache;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                net.forward_batch(inputs, batch, cache);
+                std::fill(gradients.begin(), gradients.end(), 0.0f);
+                net.backward_batch(cache, output_gradients, gradients);
+                bench::do_not_optimize(gradients.data());
+            }
+        });
+    }
+}
+
+void bench_networks(bench::Runner& runner) {
+    rl_dqn::Network network(kTopology, 1);
+    bench_network(runner, "network", network);
+
+    auto fixed = std::make_unique<rl_dqn::DefaultFixedNetwork>(1);
+    bench_network(runner, "fixed_network", *fixed);
+
+    rl_dqn::QuantizedNetwork quantized(network);
+    for (int batch : {1, 256}) {
+        runner.run("quantized/forward_batch/" + std::to_string(batch), batch,
+                   [&quantized, batch](std::int64_t iterations) {
+            std::vector<float> inputs = make_inputs(batch * rl_dqn::kObservationSize, 4);
+            rl_dqn::Network::BatchCache cache;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                const float* q = quantized.forward_batch(inputs, batch, cache);
+                bench::do_not_optimize(q);
+            }
+        });
+    }
+}
+
+void bench_adam(bench::Runner& runner) {
+    rl_dqn::Network network(kTopology, 1);
+    const std::size_t n = network.parameters().size();
+    runner.run("adam/update", static_cast<double>(n), [&network, n](std::int64_t iterations) {
+        std::vector<float> gradients = make_inputs(n, 7);
+        rl_dqn::AdamOptimizer optimizer(1e-4f);
+        for (std::int64_t i = 0; i < iterations; ++i) {
+            optimizer.update(network.parameters(), gradients);
+        }
+        bench::do_not_optimize(network.parameters().data());
+    });
+}
+
+void bench_replay(bench::Runner& runner) {
+    const std::size_t batch_size = rl_dqn::DQNConfig().batch_size;
+    for (std::size_t capacity : {std::size_t{10000}, std::size_t{1000000}}) {
+        std::string suffix = capacity >= 1000000 ? "1M" : std::to_string(capacity / 1000) + "k";
+        bool uniform = runner.selected("replay/sample/" + suffix);
+        bool prioritized = runner.selected("replay/sample_prioritized/" + suffix);
+        bool mapped = runner.selected("replay/sample_mapped/" + suffix);
+        if (!uniform && !prioritized && !mapped) {
+            continue;  // filling a 1M buffer is not free
+        }
+
+        rl_dqn::ReplayBuffer buffer(capacity, 1);
+        rl_dqn::PrioritizedReplayBuffer prioritized_buffer(capacity, 0.6f, 1e-6f, 1);
+        // 16 segments sealed on disk; sampling reads them through the page cache
+        const std::filesystem::path directory =
+            std::filesystem::temp_directory_path() / ("flappy_bench_replay_" + suffix);
+        rl_dqn::MappedReplayBuffer mapped_buffer(directory.string(), capacity, capacity / 16, 1);
+        mapped_buffer.clear();
+        core::Pcg32 rng(8);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            rl_dqn::Experience experience = random_experience(rng);
+            buffer.push(experience);
+            prioritized_buffer.push(experience);
+            mapped_buffer.push(experience);
+        }
+
+        runner.run("replay/sample/" + suffix, static_cast<double>(batch_size),
+                   [&buffer, batch_size](std::int64_t iterations) {
+            rl_dqn::TransitionBatch batch;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                buffer.sample(batch_size, batch);
+                bench::do_not_optimize(batch.states.data());
+            }
+        });
+        runner.run("replay/sample_prioritized/" + suffix, static_cast<double>(batch_size),
+                   [&prioritized_buffer, batch_size](std::int64_t iterations) {
+            rl_dqn::TransitionBatch batch;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                prioritized_buffer.sample(batch_size, batch);
+                bench::do_not_optimize(batch.states.data());
+            }
+        });
+        runner.run("replay/sample_mapped/" + suffix, static_cast<double>(batch_size),
+                   [&mapped_buffer, batch_size](std::int64_t iterations) {
+            rl_dqn::TransitionBatch batch;
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                mapped_buffer.sample(batch_size, batch);
+                bench::do_not_optimize(batch.states.data());
+            }
+        });
+        mapped_buffer.clear();
+    }
+}
+
+// One full DQN gradient step: sample, targets, forward, backward, Adam
+template <class Agent>
+void bench_train(bench::Runner& runner, const std::string& name,
+                 const rl_dqn::DQNConfig& config = rl_dqn::DQNConfig()) {
+    if (!runner.selected(name)) {
+        return;
+    }
+    auto agent = std::make_unique<Agent>(config);
+    core::Pcg32 rng(9);
+    for (std::size_t i = 0; i < config.replay_buffer_size; ++i) {
+        rl_dqn::Experience e = random_experience(rng);
+        agent->store_experience(e.state, e.action, e.reward, e.next_state, e.done);
+    }
+
+    runner.run(name, static_cast<double>(config.batch_size), [&agent](std::int64_t iterations) {
+        for (std::int64_t i = 0; i < iterations; ++i) {
+            float loss = agent->train();
+            bench::do_not_optimize(loss);
+        }
+    });
+}
+
+void print_usage() {
+    std::cout << "Usage: flappy_bench [options]\n"
+              << "  --filter TEXT     run only benchmarks whose name contains TEXT\n"
+              << "  --min-time S      seconds per repetition (default 0.2)\n"
+              << "  --repetitions N   repetitions, the median is reported (default 5)\n"
+              << "  --json PATH       write results as JSON ('-' for stdout)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    core::init();
+    rl_dqn::init();
+
+    bench::Options options;
+    if (!bench::parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    bench::Runner runner(options);
+    bench_env(runner);
+    bench_networks(runner);
+    bench_adam(runner);
+    bench_replay(runner);
+    bench_train<rl_dqn::DQNAgent>(runner, "agent/train");
+    bench_train<rl_dqn::FixedDQNAgent>(runner, "fixed_agent/train");
+
+    // Data-parallel learner on a large batch: shards per step = threads
+    for (int threads : {1, 2, 4}) {
+        rl_dqn::DQNConfig config;
+        config.batch_size = 512;
+        config.learner_threads = threads;
+        bench_train<rl_dqn::FixedDQNAgent>(
+            runner, "fixed_agent/train/512/threads:" + std::to_string(threads), config);
+    }
+
+    const std::vector<std::pair<std::string, std::string>> context = {
+        {"executable", "flappy_bench"},
+        {"kernels", rl_dqn::kernels::active().name},
+        {"num_cpus", std::to_string(std::thread::hardware_concurrency())},
+#ifdef NDEBUG
+        {"library_build_type", "release"},
+#else
+        {"library_build_type", "debug"},
+#endif
+    };
+
+    if (options.json_path.empty()) {
+        runner.print_table(std::cout);
+    } else if (options.json_path == "-") {
+        runner.write_json(std::cout, context);
+    } else {
+        std::ofstream out(options.json_path);
+        if (!out) {
+            std::cerr << "Cannot open " << options.json_path << std::endl;
+            return 1;
+        }
+        runner.write_json(out, context);
+        runner.print_table(std::cout);
+    }
+    return 0;
+}
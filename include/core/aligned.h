@@ -0,0 +1,54 @@
+#ifndef CORE_ALIGNED_H
+#define CORE_ALIGNED_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace core {
+
+// Cache-line alignment used for all hot numeric buffers
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// Minimal allocator returning storage aligned to `Alignment` bytes
+template <typename T, std::size_t Alignment = kCacheLineSize>
+struct AlignedAllocator {
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+// Contiguous vector whose data() is cache-line aligned
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace core
+
+#endif // CORE_ALIGNED_H
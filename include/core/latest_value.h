@@ -0,0 +1,64 @@
+#ifndef CORE_LATEST_VALUE_H
+#define CORE_LATEST_VALUE_H
+
+#include "core/aligned.h"
+#include <atomic>
+#include <cstdint>
+
+namespace core {
+
+// Lock-free single-producer/single-consumer handoff of the most recent value (a triple
+// buffer).
+//
+// The producer writes into a private back slot and swaps it with the shared middle slot; the
+// consumer swaps the middle slot with its private front slot when it holds something new.
+// Neither side ever waits for the other or sees a half-written value, and values the consumer
+// never looked at are simply overwritten. T must be default constructible and copy assignable.
+template <typename T>
+class LatestValue {
+public:
+    LatestValue() = default;
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    // Producer: make `value` the latest
+    void publish(const T& value) {
+        slots_[back_].value = value;
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Consumer: move to the latest value if one was published since the previous call.
+    // Returns false (and keeps the current value) otherwise.
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    // Consumer: the value taken by the last successful update() (T() before the first one)
+    const T& value() const { return slots_[front_].value; }
+
+private:
+    static constexpr std::uint8_t kIndexMask = 0x3;
+    static constexpr std::uint8_t kFresh = 0x4;   // middle slot holds an unread value
+
+    struct alignas(kCacheLineSize) Slot {
+        T value{};
+    };
+    Slot slots_[3];
+
+    alignas(kCacheLineSize) std::atomic<std::uint8_t> middle_{1};
+
+    // Producer side
+    alignas(kCacheLineSize) std::uint8_t back_ = 0;
+
+    // Consumer side
+    alignas(kCacheLineSize) std::uint8_t front_ = 2;
+};
+
+} // namespace core
+
+#endif // CORE_LATEST_VALUE_H
@@ -0,0 +1,44 @@
+#ifndef CORE_MAPPED_FILE_H
+#define CORE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace core {
+
+// Read-only memory mapping of a whole file.
+// Pages are loaded lazily by the OS and shared through the page cache, so any number of
+// processes mapping the same file hold one physical copy. Move-only; unmaps on destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // Mapping base is page aligned
+    const std::byte* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::span<const std::byte> bytes() const { return {data_, size_}; }
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+
+    void unmap() noexcept;
+};
+
+} // namespace core
+
+#endif // CORE_MAPPED_FILE_H
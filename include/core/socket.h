@@ -0,0 +1,77 @@
+#ifndef CORE_SOCKET_H
+#define CORE_SOCKET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace core {
+
+// Blocking TCP stream socket (Winsock or BSD sockets). Move-only; closes on destruction.
+// Meant to be driven by one dedicated I/O thread per direction: send_all() and recv_all()
+// may run concurrently on two threads, and shutdown() from any thread wakes both.
+class TcpSocket {
+public:
+    TcpSocket() = default;
+
+    // Connect to host:port (name or numeric address); throws std::runtime_error on failure
+    static TcpSocket connect(const std::string& host, std::uint16_t port);
+
+    TcpSocket(TcpSocket&& other) noexcept;
+    TcpSocket& operator=(TcpSocket&& other) noexcept;
+    TcpSocket(const TcpSocket&) = delete;
+    TcpSocket& operator=(const TcpSocket&) = delete;
+    ~TcpSocket();
+
+    bool valid() const { return handle_ != kInvalid; }
+
+    // Write every byte; throws std::runtime_error if the connection fails
+    void send_all(std::span<const std::byte> data);
+
+    // Fill `data` completely. Returns false on an orderly close before the first byte;
+    // throws std::runtime_error on errors or a close in the middle of `data`.
+    bool recv_all(std::span<std::byte> data);
+
+    // Disable Nagle's algorithm, so small frames leave immediately
+    void set_no_delay(bool enabled);
+
+    // Stop both directions; blocked send_all()/recv_all() calls return or throw
+    void shutdown() noexcept;
+
+private:
+    friend class TcpListener;
+    static constexpr std::intptr_t kInvalid = -1;
+    std::intptr_t handle_ = kInvalid;
+
+    explicit TcpSocket(std::intptr_t handle) : handle_(handle) {}
+    void close() noexcept;
+};
+
+// Listening TCP socket accepting connections on all interfaces
+class TcpListener {
+public:
+    // Port 0 picks a free port (see port()); throws std::runtime_error on failure
+    explicit TcpListener(std::uint16_t port);
+
+    TcpListener(const TcpListener&) = delete;
+    TcpListener& operator=(const TcpListener&) = delete;
+    ~TcpListener();
+
+    std::uint16_t port() const { return port_; }
+
+    // Wait for the next connection; returns an invalid socket once shutdown() was called
+    TcpSocket accept();
+
+    // Wake a blocked accept() and refuse further connections
+    void shutdown() noexcept;
+
+private:
+    std::atomic<std::intptr_t> handle_{TcpSocket::kInvalid};  // reset by shutdown() on Windows
+    std::uint16_t port_ = 0;
+};
+
+} // namespace core
+
+#endif // CORE_SOCKET_H
@@ -0,0 +1,90 @@
+#ifndef CORE_SPSC_QUEUE_H
+#define CORE_SPSC_QUEUE_H
+
+#include "core/aligned.h"
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace core {
+
+// Bounded lock-free single-producer/single-consumer ring.
+//
+// Exactly one thread may push and exactly one (other) thread may pop. The producer and
+// consumer indices live on separate cache lines, and each side keeps a cached copy of the
+// other's index so the shared line is only re-read when the ring looks full (or empty).
+template <typename T>
+class SpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscQueue capacity must be positive");
+        }
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    std::size_t capacity() const { return slots_.size(); }
+
+    // Producer: returns false (and leaves the queue untouched) when full
+    bool try_push(const T& item) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == slots_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: pop up to max_items into out, returns how many were popped
+    std::size_t try_pop(T* out, std::size_t max_items) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ == head) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        std::size_t available = cached_tail_ - head;
+        std::size_t count = available < max_items ? available : max_items;
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = slots_[(head + i) & mask_];
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Approximate number of queued items (exact when called by either endpoint while the
+    // other is idle)
+    std::size_t size_approx() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+
+    // Consumer side
+    alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+
+    // Producer side
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+};
+
+} // namespace core
+
+#endif // CORE_SPSC_QUEUE_H
@@ -0,0 +1,136 @@
+#ifndef CORE_TELEMETRY_H
+#define CORE_TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+
+// Hot-path timing probes.
+//
+// Every thread records into its own cache-line aligned slot, registered on the thread's first
+// record; after that a record is two relaxed stores, no locks and no shared writes. Readers
+// sum all slots with snapshot() (slots outlive their threads, so totals never go backwards).
+// Probes cost two clock reads each and wrap batch-level calls only (a vectorized env step,
+// a batched forward), never per-element work.
+//
+// Build with FLAPPY_TELEMETRY=0 (CMake option FLAPPY_TELEMETRY=OFF) and the CORE_TELEMETRY_*
+// macros compile to nothing; the classes below stay available either way.
+#ifndef FLAPPY_TELEMETRY
+#define FLAPPY_TELEMETRY 1
+#endif
+
+namespace core::telemetry {
+
+// Instrumented hot paths. Adding one: extend the enum and probe_name().
+enum class Probe : std::uint8_t {
+    kEnvStep,        // FlappyVecEnv::step, items = envs stepped
+    kActionSelect,   // Policy batched action selection, items = observations
+    kReplaySample,   // replay batch sampling in the learner, items = transitions
+    kForward,        // learner forward passes (online and target), items = batch rows
+    kBackward,       // learner backward pass, items = batch rows
+    kOptimizer,      // Adam update
+    kTargetSync,     // hard or Polyak target network update
+    kCount
+};
+
+inline constexpr std::size_t kNumProbes = static_cast<std::size_t>(Probe::kCount);
+inline constexpr bool kEnabled = FLAPPY_TELEMETRY != 0;
+
+// snake_case name used for log columns, e.g. "env_step"
+const char* probe_name(Probe probe);
+
+struct ProbeTotals {
+    std::uint64_t calls = 0;
+    std::uint64_t items = 0;
+    std::uint64_t nanoseconds = 0;
+};
+
+// Totals of every probe summed over all threads
+struct Snapshot {
+    std::array<ProbeTotals, kNumProbes> probes{};
+
+    const ProbeTotals& operator[](Probe probe) const {
+        return probes[static_cast<std::size_t>(probe)];
+    }
+
+    // Per-probe difference, for totals over a logging window
+    Snapshot operator-(const Snapshot& earlier) const;
+};
+
+// Add one call of `probe` to the calling thread's slot
+void record(Probe probe, std::uint64_t nanoseconds, std::uint64_t items = 1);
+
+// Sum of all slots. Concurrent with writers; each field is read atomically.
+Snapshot snapshot();
+
+// Records the lifetime of the scope under `probe`
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Probe probe, std::uint64_t items = 1)
+        : probe_(probe), items_(items), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        record(probe_,
+               static_cast<std::uint64_t>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+               items_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Probe probe_;
+    std::uint64_t items_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// One named value in a log row
+struct Metric {
+    const char* name;
+    double value;
+};
+
+// Periodic training log for scripts/plot_training.py. A path ending in ".json" gets JSON
+// Lines (one object per row), anything else CSV with a header row. Each row holds the given
+// metrics followed by <probe>_ms and <probe>_calls columns for the probe window `probes`.
+// Non-finite values are written as null in JSON and as nan/inf in CSV.
+// Throws std::runtime_error if the file cannot be opened.
+class TrainingLog {
+public:
+    explicit TrainingLog(const std::string& path);
+
+    void write(std::span<const Metric> metrics, const Snapshot& probes);
+
+private:
+    std::ofstream out_;
+    bool json_;
+    bool header_written_ = false;
+};
+
+} // namespace core::telemetry
+
+#define CORE_TELEMETRY_CONCAT_INNER(a, b) a##b
+#define CORE_TELEMETRY_CONCAT(a, b) CORE_TELEMETRY_CONCAT_INNER(a, b)
+
+#if FLAPPY_TELEMETRY
+// Time the rest of the enclosing scope, e.g. CORE_TELEMETRY_SCOPE(kOptimizer)
+#define CORE_TELEMETRY_SCOPE(probe)                                                 \
+    ::core::telemetry::ScopedTimer CORE_TELEMETRY_CONCAT(core_telemetry_, __LINE__)( \
+        ::core::telemetry::Probe::probe)
+// Same, counting `items` units of work (envs, rows, samples)
+#define CORE_TELEMETRY_SCOPE_N(probe, items)                                        \
+    ::core::telemetry::ScopedTimer CORE_TELEMETRY_CONCAT(core_telemetry_, __LINE__)( \
+        ::core::telemetry::Probe::probe, static_cast<std::uint64_t>(items))
+#else
+#define CORE_TELEMETRY_SCOPE(probe) static_cast<void>(0)
+#define CORE_TELEMETRY_SCOPE_N(probe, items) static_cast<void>(0)
+#endif
+
+#endif // CORE_TELEMETRY_H
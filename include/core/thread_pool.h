@@ -0,0 +1,92 @@
+#ifndef CORE_THREAD_POOL_H
+#define CORE_THREAD_POOL_H
+
+#include "core/aligned.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace core {
+
+// Fixed pool of workers running parallel_for loops with work stealing.
+//
+// Each loop starts with the index range split evenly, one contiguous slice per worker. A
+// worker takes indices from the front of its own slice; once that is empty it steals the back
+// half of the next non-empty slice, scanning from its neighbour, and continues there. Slices
+// are single packed 64-bit words updated by CAS, so owners and thieves never lock. Iterations
+// that take wildly different amounts of time (a long episode next to instant deaths) end up
+// spread over all workers instead of stalling the one that drew them.
+//
+// The calling thread works as worker 0, so a pool of size() == 1 spawns no threads at all.
+// One loop runs at a time; concurrent parallel_for calls are serialized and calling it from
+// inside one of its own loop bodies throws std::logic_error. Bodies may run loops on other
+// pools, e.g. a single-threaded evaluation pool per worker.
+class ThreadPool {
+public:
+    // `threads` workers including the caller; 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return slices_.size(); }
+
+    // Call body(index, worker) for every index in [0, count) and wait for all of them.
+    // `worker` is in [0, size()) and unique among concurrently running bodies, so it can index
+    // per-worker scratch. The first exception thrown by a body is rethrown here after the
+    // loop drains; remaining indices are skipped.
+    template <class Body>
+    void parallel_for(std::size_t count, Body&& body) {
+        using Fn = std::remove_reference_t<Body>;
+        run(count, [](void* context, std::size_t index, std::size_t worker) {
+            (*static_cast<Fn*>(context))(index, worker);
+        }, const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+private:
+    using Invoke = void (*)(void* context, std::size_t index, std::size_t worker);
+
+    // [begin, end) packed as begin << 32 | end
+    struct alignas(kCacheLineSize) Slice {
+        std::atomic<std::uint64_t> range{0};
+    };
+
+    std::vector<Slice> slices_;
+    std::vector<std::thread> threads_;
+
+    // Current loop, published under mutex_ with a new generation
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::uint64_t generation_ = 0;
+    std::size_t active_ = 0;         // helper threads still inside the current loop
+    bool stopping_ = false;
+    Invoke invoke_ = nullptr;
+    void* context_ = nullptr;
+    std::atomic<std::size_t> remaining_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+
+    std::mutex run_mutex_;           // serializes parallel_for callers
+
+    void run(std::size_t count, Invoke invoke, void* context);
+    void worker_main(std::size_t worker);
+    void work(std::size_t worker);
+    bool pop_own(std::size_t worker, std::size_t& index);
+    bool steal(std::size_t worker, std::size_t& index);
+};
+
+// Pin the calling thread to logical CPU `cpu` modulo the CPU count, e.g. a pool worker to
+// its worker index. Best effort: false where thread affinity is not supported.
+bool pin_current_thread(std::size_t cpu);
+
+} // namespace core
+
+#endif // CORE_THREAD_POOL_H
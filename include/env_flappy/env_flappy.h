@@ -1,10 +1,13 @@
 #ifndef ENV_FLAPPY_H
 #define ENV_FLAPPY_H
 
+#include "core/rng.h"
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <array>
-#include <vector>
-#include <random>
+#include <string_view>
+#include <type_traits>
 
 namespace env_flappy {
     
@@ -20,6 +23,55 @@ namespace env_flappy {
         float dy_to_gap = 0.0f;
     };
 
+    // Network input layout of an Observation. A row of an observation matrix holds one float
+    // per field in declaration order, which is exactly the struct's bytes, so rows are written
+    // with a single copy. Observation matrices are row-major [batch x kSize], the layout
+    // Network::forward_batch consumes.
+    //
+    // kLow/kHigh bound each field under the default Config and define the optional
+    // normalization onto [-1, 1] (DQNConfig::normalize_observations). rl_dqn trains the
+    // first dense layer's weights for normalized inputs and runs it on a copy with the
+    // normalization folded in, so observations are never rewritten.
+    struct ObservationSchema {
+        static constexpr std::size_t kSize = 4;
+        enum Field : std::size_t { kY, kVy, kDxToPipe, kDyToGap };
+
+        static constexpr std::array<std::string_view, kSize> kNames = {
+            "y", "vy", "dx_to_pipe", "dy_to_gap"};
+        // y: floor to ceiling; vy: term_vy to max_vy; dx: from half a pipe width behind the
+        // bird to the first pipe; dy: gap centers in [gap_y_min, gap_y_max] minus y
+        static constexpr std::array<float, kSize> kLow = {0.0f, -3.0f, -0.05f, -0.7f};
+        static constexpr std::array<float, kSize> kHigh = {1.0f, 2.5f, 0.8f, 0.7f};
+
+        // Normalized field: scale(i) * x + shift(i), mapping [kLow, kHigh] onto [-1, 1]
+        static constexpr float scale(std::size_t i) { return 2.0f / (kHigh[i] - kLow[i]); }
+        static constexpr float shift(std::size_t i) {
+            return -(kHigh[i] + kLow[i]) / (kHigh[i] - kLow[i]);
+        }
+
+        static void write(const Observation& observation, float* row) noexcept {
+            std::memcpy(row, &observation, sizeof(Observation));
+        }
+        static Observation read(const float* row) noexcept {
+            return {row[kY], row[kVy], row[kDxToPipe], row[kDyToGap]};
+        }
+    };
+
+    inline constexpr std::size_t kObservationSize = ObservationSchema::kSize;
+
+    static_assert(std::is_trivially_copyable_v<Observation> &&
+                  sizeof(Observation) == kObservationSize * sizeof(float),
+                  "Observation must be exactly one matrix row of floats");
+    // Fields must follow ObservationSchema order
+    static_assert(offsetof(Observation, y) ==
+                  ObservationSchema::kY * sizeof(float));
+    static_assert(offsetof(Observation, vy) ==
+                  ObservationSchema::kVy * sizeof(float));
+    static_assert(offsetof(Observation, dx_to_pipe) ==
+                  ObservationSchema::kDxToPipe * sizeof(float));
+    static_assert(offsetof(Observation, dy_to_gap) ==
+                  ObservationSchema::kDyToGap * sizeof(float));
+
     struct StepResult {
         Observation observation;
         float reward = 0.0f;
@@ -51,61 +103,158 @@ namespace env_flappy {
     };
 
 
+    // Everything FlappyEnv changes while it runs, as one trivially copyable block of two cache
+    // lines: bird, pipe ring (in scroll coordinates, on-screen x = pipe.x - scroll), RNG,
+    // step counter and flags. Saving or restoring it is a plain copy, which is what branching
+    // rollouts (try each action, roll out, restore) need. The Config is not part of the
+    // state; a state only restores into an env with the config it was saved from.
+    struct EnvState {
+        static constexpr std::size_t kMaxPipes = 8;
+
+        struct Pipe { float x; float gap_y; };
+
+        core::Pcg32 rng;
+        float y = 0.5f;
+        float vy = 0.0f;
+        float scroll = 0.0f;              // folded back into the pipes whenever one retires
+        std::int32_t steps = 0;
+        std::array<Pipe, kMaxPipes> pipes{};
+        std::uint8_t pipe_head = 0;       // ring slot of the oldest live pipe
+        std::uint8_t pipe_count = 0;
+        std::uint8_t current_pipe = 0;    // index from the oldest live pipe
+        bool done = false;
+        bool passed_flag = false;         // reset when a new pipe becomes "current"
+    };
+
     class FlappyEnv {
         public:
+            // World layout shared with FlappyVecEnv and the renderer
+            static constexpr float kBirdX        = 0.20f;  // fixed horizontal bird position
+            static constexpr float kFirstPipeX   = 1.0f;   // first pipe after a reset
+            static constexpr float kSpawnHorizon = 3.0f;   // keep pipes spawned up to here
+
+            // Capacity of the inline pipe ring; validate_config() rejects configs needing more
+            static constexpr std::size_t kMaxPipes = EnvState::kMaxPipes;
 
             explicit FlappyEnv(std::uint64_t seed, const Config& config = Config())
-                : config_(config), rng_(static_cast<std::mt19937::result_type>(seed)) { reset(seed); }
+                : config_(config) {
+                validate_config(config_);
+                reset(seed);
+            }
+
+            // Throws std::invalid_argument if the config cannot be simulated with kMaxPipes
+            static void validate_config(const Config& config);
             
             Observation reset(std::uint64_t seed);
             StepResult   step(Action action);
             Observation  observe() const;
+
+            // Current observation as one row of an observation matrix (kObservationSize floats)
+            void observe(float* row) const { ObservationSchema::write(compute_observation(), row); }
             
-            bool done()  const noexcept { return done_; }
-            int  steps() const noexcept { return steps_; }
+            bool done()  const noexcept { return state_.done; }
+            int  steps() const noexcept { return state_.steps; }
             const Config& config() const noexcept { return config_; }
 
+            // O(1) snapshot of the running episode; restore_state() continues exactly where
+            // save_state() left off, including the pipes still to be spawned
+            const EnvState& save_state() const noexcept { return state_; }
+            void restore_state(const EnvState& state) noexcept { state_ = state; }
+
+            // Live pipes, oldest first, for rendering: on-screen x of pipe k's center and
+            // the center of its gap
+            std::size_t num_pipes() const noexcept { return state_.pipe_count; }
+            float pipe_center_x(std::size_t k) const { return pipe_x(k); }
+            float pipe_gap_y(std::size_t k) const { return pipe(k).gap_y; }
+
 #ifdef FLAPPY_ENV_TESTING
             // Test-only hooks (compile only in tests)
-            void _set_bird(float y, float vy) { y_ = y; vy_ = vy; }
+            void _set_bird(float y, float vy) { state_.y = y; state_.vy = vy; }
             void _set_current_pipe(float x, float gap_y) {
-                if (current_pipe_idx_ < pipes_.size()) {
-                    pipes_[current_pipe_idx_] = {x, gap_y};
+                if (state_.current_pipe < state_.pipe_count) {
+                    pipe(state_.current_pipe) = {x + state_.scroll, gap_y};
                 }
             }
 #endif
 
         private:
-            // constants
-            static constexpr float kBirdX = 0.20f;
-            
-            // config & rng
             Config config_;
-            std::mt19937 rng_;
-            std::uniform_real_distribution<float> uni01_{0.0f, 1.0f};
-            
-            // bird
-            float y_  = 0.5f;
-            float vy_ = 0.0f;
-            
-            // pipes
-            struct Pipe { float x; float gap_y; };
-            std::vector<Pipe> pipes_;
-            std::size_t current_pipe_idx_ = 0;
-            
-            // episode
-            bool done_ = false;
-            bool passed_flag_ = false; // reset when a new pipe becomes "current"
-            int  steps_ = 0;
-            
+            EnvState state_;
+
             // helpers
-            void         add_pipe(float x_after);
+            using Pipe = EnvState::Pipe;
+            Pipe&        pipe(std::size_t k) {
+                return state_.pipes[(state_.pipe_head + k) % kMaxPipes];
+            }
+            const Pipe&  pipe(std::size_t k) const {
+                return state_.pipes[(state_.pipe_head + k) % kMaxPipes];
+            }
+            float        pipe_x(std::size_t k) const { return pipe(k).x - state_.scroll; }
+            float        add_pipe(float x_after);   // returns the new pipe's on-screen x
             bool         check_collision() const;
             bool         passed_pipe() const;       // uses kBirdX vs current pipe center
             Observation  compute_observation() const;
-            float        sample_gap_center();       // uses rng_ and uni01_
         };
 
+    // Per-pipe rules of the game, shared by FlappyEnv and FlappyVecEnv so both simulate
+    // bit-identically without duplicating any of it. Pipe positions are the on-screen x of
+    // the pipe's center.
+    struct PipeRules {
+        // Gap center for a uniform draw t in [0, 1)
+        static float gap_center(const Config& config, float t) {
+            return config.gap_y_min + t * (config.gap_y_max - config.gap_y_min);
+        }
+
+        // The pipe has scrolled fully off the left edge and retires
+        static bool off_screen(const Config& config, float pipe_x) {
+            return pipe_x + 0.5f * config.pipe_width < 0.0f;
+        }
+
+        // The bird is past the pipe's right edge, so the next pipe becomes current
+        static bool behind_bird(const Config& config, float pipe_x) {
+            return pipe_x + 0.5f * config.pipe_width < FlappyEnv::kBirdX;
+        }
+
+        // The bird crossed the pipe's centerline (worth r_pass once per pipe)
+        static bool passed(float pipe_x) { return FlappyEnv::kBirdX > pipe_x; }
+
+        // The bird at height y touches the ground or the ceiling
+        static bool hits_bounds(const Config& config, float y) {
+            return y <= 0.0f || y >= config.world_height;
+        }
+
+        // The bird (a point at (kBirdX, y)) is within the pipe's width but outside its gap
+        static bool hits_pipe(const Config& config, float y, float pipe_x, float gap_y) {
+            float pipe_left = pipe_x - config.pipe_width * 0.5f;
+            float pipe_right = pipe_x + config.pipe_width * 0.5f;
+            if (FlappyEnv::kBirdX < pipe_left || FlappyEnv::kBirdX > pipe_right) {
+                return false;
+            }
+            float gap_top = gap_y + config.pipe_gap * 0.5f;
+            float gap_bottom = gap_y - config.pipe_gap * 0.5f;
+            return y <= gap_bottom || y >= gap_top;
+        }
+
+        // Spawn pipes one spacing apart after the newest one (at furthest_x) until a pipe
+        // reaches kSpawnHorizon. add(x) appends a pipe at x and returns its on-screen x.
+        template <class Add>
+        static void refill(const Config& config, float furthest_x, Add&& add) {
+            while (furthest_x < FlappyEnv::kSpawnHorizon) {
+                furthest_x = add(furthest_x + config.pipe_spacing);
+            }
+        }
+
+        // Observation for a bird at (y, vy) whose current pipe is at pipe_x with its gap at
+        // gap_y; has_pipe false gives the "far away" fallback
+        static Observation observation(float y, float vy, bool has_pipe, float pipe_x,
+                                       float gap_y) {
+            if (!has_pipe) {
+                return {y, vy, 1.0f, 0.0f};
+            }
+            return {y, vy, pipe_x - FlappyEnv::kBirdX, gap_y - y};
+        }
+    };
+
 }
 
 #endif // ENV_FLAPPY_H
@@ -0,0 +1,67 @@
+#ifndef ENV_FLAPPY_RECORDING_H
+#define ENV_FLAPPY_RECORDING_H
+
+#include "env_flappy/env_flappy.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace env_flappy {
+
+// One episode as its seed and action sequence. FlappyEnv is deterministic, so
+// reset(seed) followed by the same actions reproduces every frame, at one bit per step.
+struct EpisodeRecording {
+    std::uint64_t seed = 0;
+    std::uint32_t length = 0;                   // actions recorded
+    std::vector<std::uint64_t> action_bits;     // bit i (word i / 64) set: action i is FLAP
+
+    void push(Action action) {
+        if (length % 64 == 0) {
+            action_bits.push_back(0);
+        }
+        if (action == Action::FLAP) {
+            action_bits.back() |= std::uint64_t{1} << (length % 64);
+        }
+        ++length;
+    }
+
+    Action action(std::size_t step) const {
+        return (action_bits[step / 64] >> (step % 64)) & 1 ? Action::FLAP : Action::NO_FLAP;
+    }
+};
+
+// Recording file format, version 2 (native little-endian; version 1 had the same layout but
+// was recorded with the env's former std::mt19937 pipe generator, so it no longer replays):
+//
+//   RecordingHeader
+//   Config          raw bytes, config_bytes long (the physics every episode ran with)
+//   per episode:    uint64 seed, uint32 length, uint32 reserved,
+//                   uint64 action_bits[(length + 63) / 64]
+//
+// Replays are exact only on builds with the same floating-point behaviour as the recorder.
+struct RecordingHeader {
+    char magic[8];                  // "FLPYRCRD"
+    std::uint32_t version;
+    std::uint32_t config_bytes;     // sizeof(Config) as written by the producer
+    std::uint64_t num_episodes;
+};
+
+inline constexpr std::uint32_t kRecordingVersion = 2;
+
+struct Recording {
+    Config config;
+    std::vector<EpisodeRecording> episodes;
+};
+
+// Throws std::runtime_error on I/O failure
+void write_recording(const std::string& path, const Config& config,
+                     std::span<const EpisodeRecording> episodes);
+
+// Throws std::runtime_error for unreadable, truncated or foreign files
+Recording read_recording(const std::string& path);
+
+} // namespace env_flappy
+
+#endif // ENV_FLAPPY_RECORDING_H
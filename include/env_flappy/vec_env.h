@@ -0,0 +1,113 @@
+#ifndef ENV_FLAPPY_VEC_ENV_H
+#define ENV_FLAPPY_VEC_ENV_H
+
+#include "env_flappy/env_flappy.h"
+#include "core/aligned.h"
+#include "core/rng.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace env_flappy {
+
+    // N independent Flappy environments stepped in lockstep.
+    //
+    // State is stored as structure-of-arrays (one array per field across all envs) and every
+    // env keeps its pipes in a fixed-size ring in scroll coordinates, the same layout FlappyEnv
+    // uses, so a step touches a few dense arrays and never allocates. The per-pipe rules come
+    // from PipeRules, so env i behaves exactly like a FlappyEnv that is reset with
+    // episode_seed(i) at the start of each episode.
+    class FlappyVecEnv {
+        public:
+            // Pipe ring capacity per env; the config must never need more live pipes
+            static constexpr std::size_t kMaxPipes = FlappyEnv::kMaxPipes;
+
+            // Env i starts with seed `seed + i`; see episode_seed() for later episodes
+            FlappyVecEnv(std::size_t num_envs, std::uint64_t seed, const Config& config = Config());
+
+            // Reset every env (env i with seed + i) and write the first observations
+            void reset(std::uint64_t seed, std::span<Observation> observations);
+
+            // Step every env with its action and write observation/reward/done per env.
+            // Envs that finish are reset immediately: for them `observations` holds the first
+            // observation of the next episode, while reward and done describe the final step.
+            void step(std::span<const Action> actions,
+                      std::span<Observation> observations,
+                      std::span<float> rewards,
+                      std::span<std::uint8_t> dones);
+
+            // Current observation of every env
+            void observe(std::span<Observation> observations) const;
+
+            // reset/step/observe writing observations as the rows of a row-major
+            // [size() x kObservationSize] matrix (ObservationSchema), e.g. straight into the
+            // input batch of a network
+            void reset(std::uint64_t seed, std::span<float> observations);
+            void step(std::span<const Action> actions,
+                      std::span<float> observations,
+                      std::span<float> rewards,
+                      std::span<std::uint8_t> dones);
+            void observe(std::span<float> observations) const;
+
+            std::size_t size() const noexcept { return num_envs_; }
+            const Config& config() const noexcept { return config_; }
+
+            // Steps taken in env i's current episode
+            int steps(std::size_t i) const noexcept { return steps_[i]; }
+
+            // Seed env i's current episode was reset with. Episode k of env i (k = 0, 1, ...)
+            // uses seed + i + k * size(), so every episode across all envs is distinct.
+            std::uint64_t episode_seed(std::size_t i) const noexcept { return episode_seeds_[i]; }
+
+            // Episodes finished so far across all envs
+            std::uint64_t episodes_completed() const noexcept { return episodes_completed_; }
+
+        private:
+            Config config_;
+            std::size_t num_envs_;
+            std::uint64_t episodes_completed_ = 0;
+
+            // Hot per-env state (SoA)
+            core::AlignedVector<float> y_;
+            core::AlignedVector<float> vy_;
+            core::AlignedVector<float> scroll_;  // on-screen pipe x = pipe_x_ - scroll_
+            std::vector<int> steps_;
+            std::vector<std::uint8_t> passed_flag_;
+
+            // Pipe rings: env i owns slots [i * kMaxPipes, (i + 1) * kMaxPipes)
+            core::AlignedVector<float> pipe_x_;
+            core::AlignedVector<float> pipe_gap_y_;
+            std::vector<std::uint8_t> pipe_head_;     // ring slot of the oldest live pipe
+            std::vector<std::uint8_t> pipe_count_;    // live pipes in the ring
+            std::vector<std::uint8_t> current_pipe_;  // index of the current pipe, from the oldest
+
+            // Cold per-env state, only touched when a pipe spawns or an episode resets
+            std::vector<core::Pcg32> rngs_;
+            std::vector<std::uint64_t> episode_seeds_;
+
+            // Ring slot of env i's k-th live pipe (k = 0 is the oldest)
+            std::size_t pipe_slot(std::size_t i, std::size_t k) const {
+                return i * kMaxPipes + (pipe_head_[i] + k) % kMaxPipes;
+            }
+
+            // On-screen x of env i's k-th live pipe
+            float screen_x(std::size_t i, std::size_t k) const {
+                return pipe_x_[pipe_slot(i, k)] - scroll_[i];
+            }
+
+            // step() body; write(i, observation) stores env i's new observation
+            template <class Write>
+            void step_envs(std::span<const Action> actions, std::span<float> rewards,
+                           std::span<std::uint8_t> dones, Write&& write);
+
+            void reset_env(std::size_t i, std::uint64_t seed);
+            float add_pipe(std::size_t i, float x);
+            void advance_pipes(std::size_t i);
+            bool check_collision(std::size_t i) const;
+            Observation compute_observation(std::size_t i) const;
+    };
+
+} // namespace env_flappy
+
+#endif // ENV_FLAPPY_VEC_ENV_H
@@ -3,6 +3,8 @@
 
 #include "env_flappy/env_flappy.h"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #ifdef HAVE_SDL2
 #include <SDL2/SDL.h>
@@ -10,6 +12,7 @@
 // Forward declarations when SDL2 is not available
 typedef void SDL_Window;
 typedef void SDL_Renderer;
+typedef void SDL_Surface;
 #endif
 
 namespace render_sdl {
@@ -19,6 +22,8 @@ struct RenderConfig {
     int window_height = 600;
     float scale_x = 1.0f;  // world units to pixels
     float scale_y = 1.0f;
+    bool offscreen = false;  // draw into a memory surface with the software renderer, no window
+    bool vsync = false;      // present() waits for the display's refresh (windowed only)
 };
 
 class Renderer {
@@ -29,8 +34,16 @@ public:
     bool initialize(const RenderConfig& config = RenderConfig());
     void shutdown();
 
+    // Draw one frame and present it
     void render(const env_flappy::FlappyEnv& env);
+
+    // Draw one frame without presenting, e.g. to save it. Geometry is collected per color and
+    // submitted with one SDL_RenderFillRects / SDL_RenderDrawRects call each.
+    void draw(const env_flappy::FlappyEnv& env);
     void present();
+
+    // Write the last drawn frame as a BMP; false when not initialized or on SDL errors
+    bool save_frame(const std::string& path);
     
     bool should_close() const;
     void poll_events();
@@ -55,13 +68,21 @@ private:
 #ifdef HAVE_SDL2
     SDL_Window* window_ = nullptr;
     SDL_Renderer* renderer_ = nullptr;
+    SDL_Surface* target_ = nullptr;     // offscreen frame buffer
+    SDL_Surface* capture_ = nullptr;    // read-back buffer for save_frame() on a window
     const Uint8* keyboard_state_ = nullptr;
     Uint8* previous_keyboard_state_ = nullptr;
     int num_keys_ = 0;
+
+    // Per-frame geometry, one list per draw color, reused across frames
+    std::vector<SDL_Rect> pipe_rects_;
+    std::vector<SDL_Rect> bird_rects_;
+
+    void fill_rects(const std::vector<SDL_Rect>& rects, Uint8 r, Uint8 g, Uint8 b);
 #endif
 
-    void render_bird(float y, float vy);
-    void render_pipe(float x, float gap_y, float pipe_width, float pipe_gap, float world_height);
+    void add_bird(float y);
+    void add_pipe(float x, float gap_y, float pipe_width, float pipe_gap);
     void render_background();
     
     // Convert world coordinates to screen coordinates
@@ -1,8 +1,9 @@
 #ifndef RL_DQN_ADAM_H
 #define RL_DQN_ADAM_H
 
-#include <vector>
+#include "core/aligned.h"
 #include <cstdint>
+#include <span>
 
 namespace rl_dqn {
 
@@ -14,12 +15,9 @@ public:
                   float beta2 = 0.999f,
                   float epsilon = 1e-8f);
     
-    // Apply Adam update to network weights/biases
-    // Modifies weights and biases in place using gradients
-    void update(std::vector<std::vector<std::vector<float>>>& weights,
-                std::vector<std::vector<float>>& biases,
-                const std::vector<std::vector<std::vector<float>>>& weight_gradients,
-                const std::vector<std::vector<float>>& bias_gradients);
+    // Apply one Adam step to a flat parameter buffer in place (e.g. Network::parameters()).
+    // `gradients` must have the same layout; moments are allocated on the first update.
+    void update(std::span<float> parameters, std::span<const float> gradients);
     
     // Reset optimizer state (useful for new networks)
     void reset();
@@ -27,6 +25,16 @@ public:
     // Get current step count
     int get_step() const { return step_; }
 
+    // Optimizer state, for checkpoints (moments are empty before the first update)
+    std::span<const float> first_moments() const { return m_; }
+    std::span<const float> second_moments() const { return v_; }
+    double beta1_power() const { return beta1_power_; }
+    double beta2_power() const { return beta2_power_; }
+
+    // Restore state saved from the accessors above
+    void restore(int step, double beta1_power, double beta2_power,
+                 std::span<const float> first_moments, std::span<const float> second_moments);
+
 private:
     float learning_rate_;
     float beta1_;
@@ -34,18 +42,15 @@ private:
     float epsilon_;
     int step_;
     
-    // Momentum and velocity for weights and biases
-    std::vector<std::vector<std::vector<float>>> m_weights_;  // First moment
-    std::vector<std::vector<std::vector<float>>> v_weights_;   // Second moment
-    std::vector<std::vector<float>> m_biases_;
-    std::vector<std::vector<float>> v_biases_;
+    // Running beta^t, so bias correction needs no pow() per step
+    double beta1_power_;
+    double beta2_power_;
     
-    // Initialize optimizer state for given network structure
-    void initialize_state(const std::vector<std::vector<std::vector<float>>>& weights,
-                         const std::vector<std::vector<float>>& biases);
+    // First and second moments, one entry per parameter
+    core::AlignedVector<float> m_;
+    core::AlignedVector<float> v_;
 };
 
 } // namespace rl_dqn
 
 #endif // RL_DQN_ADAM_H
-
@@ -0,0 +1,96 @@
+#ifndef RL_DQN_CHECKPOINT_H
+#define RL_DQN_CHECKPOINT_H
+
+#include "core/mapped_file.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace rl_dqn {
+
+// Binary checkpoint format, version 1 (native little-endian):
+//
+//   [0, 128)        CheckpointHeader, zero padded
+//   then, each section starting on a 64-byte boundary:
+//   layer sizes     int32[num_layer_sizes]
+//   parameters      float32[num_parameters], Network::parameters() layout
+//   if kHasTrainingState:
+//     target        float32[num_parameters], target network
+//     adam m, v     float32[num_parameters] each
+//
+// The checksum covers every byte after the header. Sections are 64-byte aligned in the
+// file, and so in the (page aligned) mapping, so loaded parameters can feed SIMD kernels
+// straight from the page cache.
+struct CheckpointHeader {
+    char magic[8];                  // "FLPYCKPT"
+    std::uint32_t version;
+    std::uint32_t endian_tag;       // 0x01020304 as written by the producer
+    std::uint32_t dtype;            // kFloat32
+    std::uint32_t flags;            // kHasTrainingState
+    std::uint32_t num_layer_sizes;
+    std::uint32_t reserved;
+    std::uint64_t num_parameters;
+    std::int64_t training_steps;    // learner gradient steps
+    std::int64_t env_steps;         // agent environment steps (drives epsilon)
+    std::int64_t adam_step;
+    double adam_beta1_power;
+    double adam_beta2_power;
+    std::uint64_t checksum;
+};
+
+inline constexpr std::uint32_t kCheckpointVersion = 1;
+inline constexpr std::uint32_t kCheckpointFloat32 = 1;
+inline constexpr std::uint32_t kCheckpointHasTrainingState = 1u << 0;
+inline constexpr std::size_t kCheckpointHeaderSize = 128;
+
+// Everything a checkpoint can hold; spans point at the caller's data
+struct CheckpointContents {
+    std::vector<int> layer_sizes;
+    std::span<const float> parameters;
+
+    // Optional training state; leave target_parameters empty to write an inference-only
+    // file. Empty Adam moments (no update yet) are written as zeros.
+    std::span<const float> target_parameters;
+    std::span<const float> adam_m;
+    std::span<const float> adam_v;
+    std::int64_t training_steps = 0;
+    std::int64_t env_steps = 0;
+    std::int64_t adam_step = 0;
+    double adam_beta1_power = 1.0;
+    double adam_beta2_power = 1.0;
+};
+
+// Write a checkpoint, replacing path atomically (written to path + ".tmp" then renamed).
+// Throws std::runtime_error on I/O failure.
+void write_checkpoint(const std::string& path, const CheckpointContents& contents);
+
+// A memory-mapped checkpoint. Opening validates the header and section sizes (and the
+// checksum unless verify is false) and throws std::runtime_error on any mismatch;
+// accessors then return views into the mapping without copying.
+class Checkpoint {
+public:
+    explicit Checkpoint(const std::string& path, bool verify = true);
+
+    const CheckpointHeader& header() const { return header_; }
+    const std::vector<int>& layer_sizes() const { return layer_sizes_; }
+    bool has_training_state() const { return (header_.flags & kCheckpointHasTrainingState) != 0; }
+
+    std::span<const float> parameters() const { return section(0); }
+    std::span<const float> target_parameters() const { return section(1); }
+    std::span<const float> adam_m() const { return section(2); }
+    std::span<const float> adam_v() const { return section(3); }
+
+private:
+    core::MappedFile file_;
+    CheckpointHeader header_;
+    std::vector<int> layer_sizes_;
+    std::size_t parameters_offset_ = 0;
+
+    // Float section k (0 = parameters); empty if the file does not have it
+    std::span<const float> section(std::size_t k) const;
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_CHECKPOINT_H
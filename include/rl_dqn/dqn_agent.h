@@ -1,53 +1,43 @@
 #ifndef RL_DQN_DQN_AGENT_H
 #define RL_DQN_DQN_AGENT_H
 
+#include "rl_dqn/dqn_config.h"
+#include "rl_dqn/dqn_learner.h"
+#include "rl_dqn/inference.h"
+#include "rl_dqn/n_step.h"
 #include "rl_dqn/network.h"
+#include "rl_dqn/fixed_network.h"
 #include "rl_dqn/replay_buffer.h"
 #include "rl_dqn/adam.h"
 #include "env_flappy/env_flappy.h"
+#include "core/rng.h"
 #include <cstdint>
 #include <cstddef>
+#include <span>
+#include <string>
 
 namespace rl_dqn {
 
-// DQN Agent configuration
-struct DQNConfig {
-    // Network architecture
-    std::vector<int> layer_sizes = {4, 128, 128, 2};  // input, hidden, hidden, output
-    
-    // Training hyperparameters
-    float learning_rate = 0.0001f;
-    float gamma = 0.99f;  // discount factor
-    float epsilon_start = 1.0f;
-    float epsilon_end = 0.01f;
-    int epsilon_decay_steps = 10000;
-    
-    // Replay buffer
-    std::size_t replay_buffer_size = 10000;
-    std::size_t batch_size = 32;
-    
-    // Training schedule
-    int train_frequency = 4;  // train every N steps
-    int target_update_frequency = 100;  // update target network every N steps
-    
-    // Adam optimizer
-    float adam_beta1 = 0.9f;
-    float adam_beta2 = 0.999f;
-    float adam_epsilon = 1e-8f;
-    
-    // Random seed
-    std::uint64_t seed = 12345;
-};
-
-// DQN Agent
-class DQNAgent {
+// Single-threaded DQN agent: epsilon-greedy acting on top of a DQNLearner.
+// Multi-threaded training uses DQNLearner and Policy directly instead.
+// Net selects the network implementation (see BasicDQNLearner): DQNAgent works with any
+// config.layer_sizes, FixedDQNAgent runs the compile-time DefaultFixedNetwork topology.
+template <DenseNetwork Net>
+class BasicDQNAgent {
 public:
-    explicit DQNAgent(const DQNConfig& config = DQNConfig());
+    explicit BasicDQNAgent(const DQNConfig& config = DQNConfig());
     
-    // Select action using epsilon-greedy policy
+    // Select action using epsilon-greedy policy. Allocation-free: exploration draws come
+    // from a persistent PCG32 stream and the greedy pass reuses the agent's inference buffers.
     env_flappy::Action select_action(const env_flappy::Observation& state);
+
+    // Batched select_action: one epsilon-greedy decision per observation with a single
+    // forward pass. Advances the step counter (and epsilon) by states.size().
+    void select_actions(std::span<const env_flappy::Observation> states,
+                        std::span<env_flappy::Action> actions);
     
-    // Store experience in replay buffer
+    // Store experience in replay buffer; consecutive calls must come from one episode stream
+    // (folded into config.n_step returns before storage)
     void store_experience(const env_flappy::Observation& state,
                          env_flappy::Action action,
                          float reward,
@@ -57,7 +47,7 @@ public:
     // Train the network on a batch from replay buffer
     float train();
     
-    // Update target network (copy weights from main network)
+    // Update target network (copy all parameters from main network)
     void update_target_network();
     
     // Get current epsilon (for logging)
@@ -66,39 +56,40 @@ public:
     // Get Q-values for a state (for debugging)
     std::vector<float> get_q_values(const env_flappy::Observation& state) const;
     
-    // Save/load network weights (for model persistence)
+    // Save/load a binary checkpoint (see rl_dqn/checkpoint.h): networks, Adam state and step
+    // counters, so training resumes where it stopped. Loading memory-maps the file and throws
+    // std::runtime_error on a corrupt file, std::invalid_argument on a layer size mismatch.
     void save_weights(const std::string& filepath) const;
     void load_weights(const std::string& filepath);
     
     // Get training statistics
-    int get_training_steps() const { return training_steps_; }
+    int get_training_steps() const { return learner_.training_steps(); }
     int get_total_steps() const { return total_steps_; }
 
+    const BasicDQNLearner<Net>& learner() const { return learner_; }
+    BasicDQNLearner<Net>& learner() { return learner_; }
+
 private:
     DQNConfig config_;
+    BasicDQNLearner<Net> learner_;
     
-    // Networks
-    Network main_network_;
-    Network target_network_;
-    
-    // Replay buffer
-    ReplayBuffer replay_buffer_;
-    
-    // Optimizer
-    AdamOptimizer optimizer_;
-    
-    // Training state
+    // Acting state
     int total_steps_;
-    int training_steps_;
     float current_epsilon_;
-    
-    // Convert observation to network input
-    std::vector<float> observation_to_input(const env_flappy::Observation& obs) const;
-    
-    // Compute target Q-values for a batch
-    std::vector<std::vector<float>> compute_targets(const std::vector<Experience>& batch) const;
+    core::Pcg32 rng_;
+    InferenceContext inference_;
+
+    // Single-stream n-step folding in front of the replay buffer
+    NStepAccumulator n_step_;
+    std::vector<Experience> n_step_out_;
 };
 
+extern template class BasicDQNAgent<Network>;
+extern template class BasicDQNAgent<DefaultFixedNetwork>;
+
+using DQNAgent = BasicDQNAgent<Network>;
+using FixedDQNAgent = BasicDQNAgent<DefaultFixedNetwork>;
+
 } // namespace rl_dqn
 
 #endif // RL_DQN_DQN_AGENT_H
@@ -0,0 +1,78 @@
+#ifndef RL_DQN_DQN_CONFIG_H
+#define RL_DQN_DQN_CONFIG_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rl_dqn {
+
+// DQN Agent configuration
+struct DQNConfig {
+    // Network architecture
+    std::vector<int> layer_sizes = {4, 128, 128, 2};  // input, hidden, hidden, output
+    // Learn on observations mapped from their ObservationSchema ranges to [-1, 1], fused into
+    // the first layer (Network::set_input_transform): its weights are trained for normalized
+    // inputs and it runs on a folded copy, refreshed after every update, so callers still
+    // pass raw observations. Policy snapshots and checkpoints hold the folded weights.
+    bool normalize_observations = false;
+    
+    // Training hyperparameters
+    float learning_rate = 0.0001f;
+    float gamma = 0.99f;  // discount factor
+    int n_step = 1;       // transitions folded into each stored return (rl_dqn/n_step.h)
+    bool double_dqn = false;  // online network picks the bootstrap action, target scores it
+    float epsilon_start = 1.0f;
+    float epsilon_end = 0.01f;
+    int epsilon_decay_steps = 10000;
+    
+    // Replay buffer
+    std::size_t replay_buffer_size = 10000;
+    std::size_t batch_size = 32;
+    // Data-parallel learner: each train() step splits the batch into this many shards, one
+    // per worker thread. Results are bit-identical across runs for a fixed count (but differ
+    // in the last bits between counts, since the gradient sum is grouped per shard).
+    int learner_threads = 1;
+    // On-disk replay (rl_dqn/mapped_replay_buffer.h) when set: transitions live in memory-
+    // mapped segment files here, and a learner reopening the directory resumes with them.
+    // Uniform replay only.
+    std::string replay_directory;
+    std::size_t replay_segment_records = 1 << 16;
+
+    // Prioritized replay (uniform sampling when off)
+    bool prioritized_replay = false;
+    float priority_alpha = 0.6f;
+    float priority_beta_start = 0.4f;   // importance-sampling exponent, annealed to 1
+    int priority_beta_steps = 100000;   // training steps over which beta reaches 1
+    float priority_epsilon = 1e-6f;     // keeps zero-error transitions sampleable
+    
+    // Training schedule
+    int train_frequency = 4;  // train every N steps
+    int target_update_frequency = 100;  // update target network every N steps
+    // Polyak averaging rate: when > 0, train() soft-updates the target network after every
+    // step (target += tau * (online - target)) and the periodic hard sync is not needed
+    float target_tau = 0.0f;
+    
+    // Actors act on an int8 copy of the network (rl_dqn/quantized_network.h)
+    bool quantized_policy = false;
+
+    // Adam optimizer
+    float adam_beta1 = 0.9f;
+    float adam_beta2 = 0.999f;
+    float adam_epsilon = 1e-8f;
+    
+    // Random seed
+    std::uint64_t seed = 12345;
+};
+
+// Linearly decayed exploration rate after `step` environment steps
+inline float linear_epsilon(const DQNConfig& config, long long step) {
+    float progress = std::min(1.0f, static_cast<float>(step) / config.epsilon_decay_steps);
+    return config.epsilon_start + (config.epsilon_end - config.epsilon_start) * progress;
+}
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_DQN_CONFIG_H
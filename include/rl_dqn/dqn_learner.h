@@ -0,0 +1,128 @@
+#ifndef RL_DQN_DQN_LEARNER_H
+#define RL_DQN_DQN_LEARNER_H
+
+#include "rl_dqn/dqn_config.h"
+#include "rl_dqn/network.h"
+#include "rl_dqn/fixed_network.h"
+#include "rl_dqn/replay_buffer.h"
+#include "rl_dqn/adam.h"
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/train_workspace.h"
+#include "core/thread_pool.h"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+
+// Learning half of DQN: owns the online and target networks, the replay buffer and the
+// optimizer. It never picks actions, so it can run on its own thread while actors explore
+// with Policy copies of network().
+// Stored transitions may be n-step returns (config.n_step, see NStepAccumulator); targets
+// bootstrap with gamma^n_step accordingly.
+// With config.learner_threads > 1 every train() step is data-parallel: the batch is cut
+// into that many contiguous shards, each computing targets, forward and backward into its own
+// gradient buffer on a core::ThreadPool, and the shard gradients are summed in shard order
+// before the single Adam update. Shards are fixed by the batch, never by scheduling, so a
+// given thread count always reproduces the same parameters.
+// Net is the network implementation: Network for any topology, or a FixedNetwork whose
+// layer sizes must equal config.layer_sizes (std::invalid_argument otherwise).
+template <DenseNetwork Net>
+class BasicDQNLearner {
+public:
+    using NetworkType = Net;
+
+    explicit BasicDQNLearner(const DQNConfig& config = DQNConfig());
+
+    // Store one transition in the replay buffer
+    void store(const Experience& experience);
+
+    // One gradient step on a replay batch; returns the batch loss, or 0 if the buffer
+    // does not hold a full batch yet. Soft-updates the target when config.target_tau > 0.
+    float train();
+
+    // Hard sync: copy all main network parameters (weights and biases) into the target
+    void update_target_network();
+
+    // Polyak soft update of every target parameter towards the main network
+    void soft_update_target_network(float tau);
+
+    const Net& network() const { return main_network_; }
+    Net& network() { return main_network_; }
+    const Net& target_network() const { return target_network_; }
+
+    // Online parameters for a network without input transform, as policy snapshots and
+    // actors use: network().parameters() itself, or with config.normalize_observations a
+    // copy whose first layer is the folded one the network runs. Valid until the next
+    // call (checkpoint_contents() keeps its own copies).
+    std::span<const float> policy_parameters() const;
+
+    // Checkpoint views of the learner state; spans point into the learner. Without training
+    // state only the online network is included (enough for inference). Networks are
+    // stored as they act on raw observations (see policy_parameters()); the Adam moments
+    // stay in the training parameterization. Folded copies stay valid until the next
+    // checkpoint_contents() call.
+    CheckpointContents checkpoint_contents(bool include_training_state) const;
+
+    // Restore from a checkpoint with the same layer sizes (std::invalid_argument otherwise).
+    // Inference-only checkpoints also reset the target network to the loaded weights.
+    // With config.normalize_observations the stored networks are unfolded again.
+    void load_checkpoint(const Checkpoint& checkpoint);
+
+    const ReplayBuffer& replay_buffer() const { return *replay_buffer_; }
+    const DQNConfig& config() const { return config_; }
+    int training_steps() const { return training_steps_; }
+
+private:
+    DQNConfig config_;
+
+    // Networks
+    Net main_network_;
+    Net target_network_;
+
+    // Replay buffer (a PrioritizedReplayBuffer when config.prioritized_replay is set, a
+    // MappedReplayBuffer when config.replay_directory is)
+    std::unique_ptr<ReplayBuffer> replay_buffer_;
+    PrioritizedReplayBuffer* prioritized_buffer_ = nullptr;
+
+    // Optimizer
+    AdamOptimizer optimizer_;
+
+    int training_steps_ = 0;
+
+    // gamma^n_step: stored rewards already hold the first n_step discounted terms
+    float bootstrap_discount_;
+
+    // Present when config.learner_threads > 1; sized to the shard count
+    std::unique_ptr<core::ThreadPool> pool_;
+
+    // Target Q-value of the taken action for rows [begin, end) of the sampled batch, from one
+    // batched target pass over next_states (plus one online pass for Double DQN)
+    void compute_targets(std::size_t begin, std::size_t end, TrainWorkspace::Shard& shard);
+
+    // Targets, forward, loss and backward for one shard of workspace_.batch; writes its rows
+    // of the output gradients and TD errors, its gradient buffer and its loss
+    void train_shard(std::size_t shard);
+
+    // shards[0].gradients += every other shard's gradients, in shard order
+    void reduce_gradients();
+
+    // Folded copies handed out by policy_parameters() and by checkpoint_contents()
+    mutable std::vector<float> export_policy_;
+    mutable std::vector<float> export_parameters_;
+    mutable std::vector<float> export_target_;
+
+    // Training scratch, reserved for config.batch_size at construction
+    TrainWorkspace workspace_;
+};
+
+// Both instantiations are compiled once, in dqn_learner.cpp
+extern template class BasicDQNLearner<Network>;
+extern template class BasicDQNLearner<DefaultFixedNetwork>;
+
+using DQNLearner = BasicDQNLearner<Network>;
+using FixedDQNLearner = BasicDQNLearner<DefaultFixedNetwork>;
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_DQN_LEARNER_H
@@ -0,0 +1,75 @@
+#ifndef RL_DQN_EVALUATION_H
+#define RL_DQN_EVALUATION_H
+
+#include "rl_dqn/network.h"
+#include "env_flappy/env_flappy.h"
+#include "env_flappy/recording.h"
+#include "core/thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+
+struct EvalConfig {
+    std::size_t episodes = 1000;
+    std::uint64_t seed = 1;      // episode i plays FlappyEnv::reset(seed + i)
+    int max_steps = 10000;       // episodes still alive after this many steps are truncated
+    int threads = 0;             // 0: std::thread::hardware_concurrency()
+    std::size_t batch = 16;      // episodes stepped in lockstep per chunk
+    env_flappy::Config env;
+};
+
+struct EpisodeResult {
+    float score = 0.0f;          // undiscounted return
+    int pipes = 0;               // pipes passed
+    int length = 0;              // environment steps
+    bool truncated = false;      // hit max_steps
+};
+
+// Greedy evaluation: every episode runs argmax-Q actions from its own seed.
+//
+// Episodes are cut into fixed chunks of config.batch consecutive indices, balanced over a
+// work-stealing core::ThreadPool, and the live episodes of a chunk step in lockstep with one
+// batched forward per step. A chunk's batch layout depends only on its episodes, never on
+// which thread runs it or when, so results[i] is bit-identical for any thread count.
+// Instantiated for Network, DefaultFixedNetwork and QuantizedNetwork.
+// With `recordings`, (*recordings)[i] receives episode i's seed and actions for replay
+// (env_flappy/recording.h).
+template <InferenceNetwork Net>
+std::vector<EpisodeResult> evaluate_policy(
+    const Net& network, const EvalConfig& config,
+    std::vector<env_flappy::EpisodeRecording>* recordings = nullptr);
+
+// Same on an existing pool, e.g. one kept for periodic evaluation; config.threads is ignored
+template <InferenceNetwork Net>
+std::vector<EpisodeResult> evaluate_policy(
+    const Net& network, const EvalConfig& config, core::ThreadPool& pool,
+    std::vector<env_flappy::EpisodeRecording>* recordings = nullptr);
+
+struct EvalSummary {
+    std::size_t episodes = 0;
+    std::size_t truncated = 0;
+    double mean_score = 0.0;
+    double stddev_score = 0.0;
+    double mean_pipes = 0.0;
+    double mean_length = 0.0;
+
+    // Nearest-rank percentiles at kPercentiles
+    static constexpr double kPercentiles[] = {5.0, 25.0, 50.0, 75.0, 95.0};
+    double score_percentiles[5] = {};
+    int pipes_percentiles[5] = {};
+    int length_percentiles[5] = {};
+    int max_pipes = 0;
+
+    // FNV-1a over every result in episode order, to compare runs at a glance
+    std::uint64_t digest = 0;
+};
+
+// Aggregate in episode order, so equal results give equal summaries
+EvalSummary summarize(std::span<const EpisodeResult> results);
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_EVALUATION_H
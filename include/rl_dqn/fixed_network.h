@@ -0,0 +1,288 @@
+#ifndef RL_DQN_FIXED_NETWORK_H
+#define RL_DQN_FIXED_NETWORK_H
+
+#include "rl_dqn/network.h"
+#include "rl_dqn/kernels.h"
+#include "core/aligned.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rl_dqn {
+
+// Feedforward network whose topology is fixed at compile time, e.g. FixedNetwork<4, 128, 2>.
+// Parameters live inline in an aligned std::array with exactly the flat layout of Network
+// (per layer: row-major [out x in] weights, then biases), so parameter spans, checkpoints and
+// policy snapshots are interchangeable between the two. Satisfies DenseNetwork, which lets
+// BasicDQNLearner / BasicDQNAgent run on it instead of the runtime-sized Network.
+// Offsets and sizes are constants and no per-call size checks remain beyond the batch; the
+// default topology additionally runs kernels specialized for its exact layer shapes.
+template <int... Sizes>
+class FixedNetwork {
+    static_assert(sizeof...(Sizes) >= 2, "FixedNetwork needs at least input and output layers");
+    static_assert(((Sizes > 0) && ...), "Layer sizes must be positive");
+
+public:
+    using BatchCache = Network::BatchCache;
+
+    static constexpr std::array<int, sizeof...(Sizes)> kLayerSizes{Sizes...};
+    static constexpr std::size_t kNumLayers = sizeof...(Sizes) - 1;
+    static constexpr int kInputSize = kLayerSizes.front();
+    static constexpr int kOutputSize = kLayerSizes.back();
+
+    // Start of each layer's weights inside parameters()
+    static constexpr std::array<std::size_t, kNumLayers> kLayerOffsets = [] {
+        std::array<std::size_t, kNumLayers> offsets{};
+        std::size_t total = 0;
+        for (std::size_t l = 0; l < kNumLayers; ++l) {
+            offsets[l] = total;
+            total += static_cast<std::size_t>(kLayerSizes[l + 1]) * (kLayerSizes[l] + 1);
+        }
+        return offsets;
+    }();
+    static constexpr std::size_t kNumParameters =
+        kLayerOffsets.back() +
+        static_cast<std::size_t>(kLayerSizes[kNumLayers]) * (kLayerSizes[kNumLayers - 1] + 1);
+
+    // Same initial parameters as Network(get_layer_sizes(), seed)
+    explicit FixedNetwork(std::uint64_t seed = 12345) {
+        params_.fill(0.0f);
+        std::mt19937 rng(static_cast<std::mt19937::result_type>(seed));
+        for (std::size_t l = 0; l < kNumLayers; ++l) {
+            LayerView view = layer(l);
+            float limit = std::sqrt(6.0f / (view.fan_in + view.fan_out));
+            std::size_t count = static_cast<std::size_t>(view.fan_out) * view.fan_in;
+            for (std::size_t k = 0; k < count; ++k) {
+                std::uniform_real_distribution<float> dist(-limit, limit);
+                view.weights[k] = dist(rng);
+            }
+        }
+    }
+
+    // Network-compatible constructor; throws std::invalid_argument for any other topology
+    FixedNetwork(const std::vector<int>& layer_sizes, std::uint64_t seed) : FixedNetwork(seed) {
+        if (layer_sizes != get_layer_sizes()) {
+            throw std::invalid_argument("Layer sizes do not match the fixed network topology");
+        }
+    }
+
+    // Forward pass for a single input
+    std::vector<float> forward(const std::vector<float>& input) const {
+        BatchCache cache;
+        const float* out = forward_batch(input, 1, cache);
+        return std::vector<float>(out, out + kOutputSize);
+    }
+
+    // Batched forward pass over a row-major [batch_size x in] input matrix.
+    // Returns the [batch_size x out] output block stored in `cache`.
+    const float* forward_batch(std::span<const float> inputs, int batch_size,
+                               BatchCache& cache) const {
+        if (batch_size <= 0) {
+            throw std::invalid_argument("Batch size must be positive");
+        }
+        if (inputs.size() != static_cast<std::size_t>(batch_size) * kInputSize) {
+            throw std::invalid_argument("Input size mismatch");
+        }
+
+        cache.batch_size = batch_size;
+        cache.activations.resize(kLayerSizes.size());
+        for (std::size_t l = 0; l < kLayerSizes.size(); ++l) {
+            cache.activations[l].resize(static_cast<std::size_t>(batch_size) * kLayerSizes[l]);
+        }
+        std::copy(inputs.begin(), inputs.end(), cache.activations[0].begin());
+
+        [&]<std::size_t... L>(std::index_sequence<L...>) {
+            (forward_layer<L>(cache), ...);
+        }(std::make_index_sequence<kNumLayers>{});
+        return cache.output();
+    }
+
+    // Batched backward pass reusing the activations cached by the last forward_batch().
+    // Same contract as Network::backward_batch().
+    void backward_batch(BatchCache& cache, std::span<const float> output_gradients,
+                        std::span<float> gradients) const {
+        if (cache.batch_size <= 0 || cache.activations.size() != kLayerSizes.size()) {
+            throw std::logic_error("backward_batch() requires a preceding forward_batch()");
+        }
+        if (output_gradients.size() != static_cast<std::size_t>(cache.batch_size) * kOutputSize) {
+            throw std::invalid_argument("Output gradient size mismatch");
+        }
+        if (gradients.size() != kNumParameters) {
+            throw std::invalid_argument("Gradient buffer size mismatch");
+        }
+
+        cache.delta.assign(output_gradients.begin(), output_gradients.end());
+        [&]<std::size_t... L>(std::index_sequence<L...>) {
+            (backward_layer<kNumLayers - 1 - L>(cache, gradients.data()), ...);
+        }(std::make_index_sequence<kNumLayers>{});
+    }
+
+    // Same contract as Network::set_input_transform()
+    void set_input_transform(std::span<const float> scale, std::span<const float> shift) {
+        if (scale.size() != static_cast<std::size_t>(kInputSize) ||
+            shift.size() != scale.size()) {
+            throw std::invalid_argument("Input transform size mismatch");
+        }
+        std::copy(scale.begin(), scale.end(), input_scale_.begin());
+        std::copy(shift.begin(), shift.end(), input_shift_.begin());
+        has_input_transform_ = true;
+        refresh_input_transform();
+    }
+    void refresh_input_transform() {
+        if (!has_input_transform_) {
+            return;
+        }
+        const float* first = params_.data() + kLayerOffsets[0];
+        std::copy(first, first + input_layer_.size(), input_layer_.begin());
+        fold_input_transform({input_layer_.data(), input_layer_.data() + kInputWeights,
+                              kInputSize, kLayerSizes[1]},
+                             input_scale_, input_shift_);
+    }
+    ConstLayerView input_layer() const {
+        if (!has_input_transform_) {
+            return layer(0);
+        }
+        return {input_layer_.data(), input_layer_.data() + kInputWeights, kInputSize,
+                kLayerSizes[1]};
+    }
+    bool has_input_transform() const { return has_input_transform_; }
+    std::span<const float> input_scale() const {
+        return has_input_transform_ ? std::span<const float>(input_scale_)
+                                    : std::span<const float>();
+    }
+    std::span<const float> input_shift() const {
+        return has_input_transform_ ? std::span<const float>(input_shift_)
+                                    : std::span<const float>();
+    }
+
+    // All parameters as one contiguous span, laid out like Network::parameters()
+    std::span<float> parameters() { return {params_.data(), params_.size()}; }
+    std::span<const float> parameters() const { return {params_.data(), params_.size()}; }
+
+    static constexpr std::size_t num_layers() { return kNumLayers; }
+
+    LayerView layer(std::size_t index) {
+        float* weights = params_.data() + kLayerOffsets[index];
+        int fan_in = kLayerSizes[index];
+        int fan_out = kLayerSizes[index + 1];
+        return {weights, weights + static_cast<std::size_t>(fan_out) * fan_in, fan_in, fan_out};
+    }
+    ConstLayerView layer(std::size_t index) const {
+        const float* weights = params_.data() + kLayerOffsets[index];
+        int fan_in = kLayerSizes[index];
+        int fan_out = kLayerSizes[index + 1];
+        return {weights, weights + static_cast<std::size_t>(fan_out) * fan_in, fan_in, fan_out};
+    }
+
+    static constexpr std::size_t layer_offset(std::size_t index) { return kLayerOffsets[index]; }
+
+    static const std::vector<int>& get_layer_sizes() {
+        static const std::vector<int> sizes(kLayerSizes.begin(), kLayerSizes.end());
+        return sizes;
+    }
+
+    static constexpr int get_num_parameters() { return static_cast<int>(kNumParameters); }
+
+private:
+    alignas(core::kCacheLineSize) std::array<float, kNumParameters> params_;
+    // Input transform (Network::set_input_transform) and the folded layer 0 it runs on
+    static constexpr std::size_t kInputWeights =
+        static_cast<std::size_t>(kLayerSizes[1]) * kInputSize;
+    std::array<float, kInputSize> input_scale_{};
+    std::array<float, kInputSize> input_shift_{};
+    alignas(core::kCacheLineSize) std::array<float, kInputWeights + kLayerSizes[1]> input_layer_{};
+    bool has_input_transform_ = false;
+
+    // Layers of kernels::kFixedTopology run the active table's shape-specialized kernels;
+    // any other shape gets the general kernels with compile-time constant sizes
+    static constexpr bool kSpecialized = [] {
+        if (kLayerSizes.size() != std::size(kernels::kFixedTopology)) {
+            return false;
+        }
+        return std::equal(kLayerSizes.begin(), kLayerSizes.end(), kernels::kFixedTopology);
+    }();
+
+    template <std::size_t L>
+    void forward_layer(BatchCache& cache) const {
+        constexpr int kIn = kLayerSizes[L];
+        constexpr int kOut = kLayerSizes[L + 1];
+        constexpr bool kRelu = L + 1 < kNumLayers;
+        const float* w = params_.data() + kLayerOffsets[L];
+        if constexpr (L == 0) {
+            w = input_layer().weights;   // folded with an input transform
+        }
+        const float* b = w + kIn * kOut;
+        const float* x = cache.activations[L].data();
+        float* y = cache.activations[L + 1].data();
+
+        const kernels::KernelTable& k = kernels::active();
+        if constexpr (kSpecialized) {
+            k.fixed.layers[L].forward(w, b, x, y, cache.batch_size);
+        } else {
+            k.dense_forward(w, b, x, y, cache.batch_size, kIn, kOut, kRelu);
+        }
+    }
+
+    template <std::size_t L>
+    void backward_layer(BatchCache& cache, float* gradients) const {
+        constexpr int kIn = kLayerSizes[L];
+        constexpr int kOut = kLayerSizes[L + 1];
+        const float* w = params_.data() + kLayerOffsets[L];
+        const float* x = cache.activations[L].data();
+        float* dw = gradients + kLayerOffsets[L];
+        float* db = dw + kIn * kOut;
+
+        // Gradients for this layer's weights and biases
+        const kernels::KernelTable& k = kernels::active();
+        if (L == 0 && has_input_transform_) {
+            // Layer 0 ran folded on raw inputs: take its gradient, then the chain rule
+            cache.input_layer_gradients.assign(input_layer_.size(), 0.0f);
+            float* folded = cache.input_layer_gradients.data();
+            if constexpr (kSpecialized) {
+                k.fixed.layers[L].backward_params(x, cache.delta.data(), folded,
+                                                  folded + kIn * kOut, cache.batch_size);
+            } else {
+                k.dense_backward_params(x, cache.delta.data(), folded, folded + kIn * kOut,
+                                        cache.batch_size, kIn, kOut);
+            }
+            unfold_input_gradients(cache.input_layer_gradients, input_scale_, input_shift_,
+                                   kOut, dw, db);
+        } else if constexpr (kSpecialized) {
+            k.fixed.layers[L].backward_params(x, cache.delta.data(), dw, db, cache.batch_size);
+        } else {
+            k.dense_backward_params(x, cache.delta.data(), dw, db, cache.batch_size, kIn, kOut);
+        }
+
+        // Propagate error to previous layer (if not input layer); its output went through ReLU
+        if constexpr (L > 0) {
+            cache.prev_delta.resize(static_cast<std::size_t>(cache.batch_size) * kIn);
+            float* dx = cache.prev_delta.data();
+            if constexpr (kSpecialized) {
+                k.fixed.layers[L].backward_input(w, x, cache.delta.data(), dx, cache.batch_size);
+            } else {
+                k.dense_backward_input(w, x, cache.delta.data(), dx, cache.batch_size, kIn, kOut,
+                                       true);
+            }
+            cache.delta.swap(cache.prev_delta);
+        }
+    }
+};
+
+// The deployed DQN topology, DQNConfig().layer_sizes
+using DefaultFixedNetwork =
+    FixedNetwork<kernels::kFixedTopology[0], kernels::kFixedTopology[1],
+                 kernels::kFixedTopology[2], kernels::kFixedTopology[3]>;
+
+static_assert(DenseNetwork<DefaultFixedNetwork>);
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_FIXED_NETWORK_H
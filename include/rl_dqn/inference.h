@@ -0,0 +1,60 @@
+#ifndef RL_DQN_INFERENCE_H
+#define RL_DQN_INFERENCE_H
+
+#include "rl_dqn/network.h"
+#include "rl_dqn/fixed_network.h"
+#include "rl_dqn/quantized_network.h"
+#include "core/aligned.h"
+#include "core/rng.h"
+#include "env_flappy/env_flappy.h"
+#include <span>
+
+namespace rl_dqn {
+
+// Preallocated scratch for running a Network on observations, one per thread.
+// After the first call at a given batch size nothing is allocated: observations are packed
+// into a reused input matrix and activations live in a reused BatchCache.
+// The methods are instantiated for Network, DefaultFixedNetwork and QuantizedNetwork.
+class InferenceContext {
+public:
+    InferenceContext() = default;
+
+    // Q-values as a row-major [observations.size() x num_actions] matrix, valid until the
+    // next call on this context
+    template <InferenceNetwork Net>
+    const float* q_values(const Net& network,
+                          std::span<const env_flappy::Observation> observations);
+
+    // Argmax-Q action per observation (ties pick NO_FLAP)
+    template <InferenceNetwork Net>
+    void greedy_actions(const Net& network,
+                        std::span<const env_flappy::Observation> observations,
+                        std::span<env_flappy::Action> actions);
+
+    // q_values / greedy_actions on observations that already form a row-major
+    // [batch x kObservationSize] matrix (FlappyVecEnv, FlappyEnv::observe(float*)): the
+    // network reads it in place, without packing
+    template <InferenceNetwork Net>
+    const float* q_values(const Net& network, std::span<const float> observations);
+
+    template <InferenceNetwork Net>
+    void greedy_actions(const Net& network, std::span<const float> observations,
+                        std::span<env_flappy::Action> actions);
+
+    // Per observation: a uniformly random action with probability epsilon, else argmax Q.
+    // The network runs once for the whole batch.
+    template <InferenceNetwork Net>
+    void epsilon_greedy_actions(const Net& network,
+                                std::span<const env_flappy::Observation> observations,
+                                float epsilon,
+                                core::Pcg32& rng,
+                                std::span<env_flappy::Action> actions);
+
+private:
+    core::AlignedVector<float> inputs_;
+    Network::BatchCache cache_;
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_INFERENCE_H
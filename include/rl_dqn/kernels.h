@@ -0,0 +1,127 @@
+#ifndef RL_DQN_KERNELS_H
+#define RL_DQN_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rl_dqn {
+namespace kernels {
+
+// Per-step Adam coefficients with bias correction folded in:
+//   m = beta1 * m + (1 - beta1) * g
+//   v = beta2 * v + (1 - beta2) * g^2
+//   p -= step_size * m / (sqrt(v) + epsilon)
+struct AdamStep {
+    float beta1;
+    float beta2;
+    float step_size;  // lr * sqrt(1 - beta2^t) / (1 - beta1^t)
+    float epsilon;    // eps * sqrt(1 - beta2^t)
+};
+
+// Layer sizes of the default DQN topology (DQNConfig::layer_sizes, DefaultFixedNetwork).
+// Every table carries copies of its dense kernels specialized for exactly these layers.
+inline constexpr int kFixedTopology[] = {4, 128, 128, 2};
+inline constexpr int kNumFixedLayers = 3;
+
+// Dense kernels for one layer of kFixedTopology: same contracts as the general kernels below,
+// with in, out and the activation fixed at compile time so loops unroll and tails vanish.
+// Hidden layers use ReLU; backward_input always applies the ReLU mask and is null for
+// layer 0, whose input gradient is never needed.
+struct FixedLayerKernels {
+    void (*forward)(const float* w, const float* b, const float* x, float* y, int batch);
+    void (*backward_params)(const float* x, const float* dy, float* dw, float* db, int batch);
+    void (*backward_input)(const float* w, const float* x, const float* dy, float* dx,
+                           int batch);
+};
+
+struct FixedKernels {
+    FixedLayerKernels layers[kNumFixedLayers];
+};
+
+// Dense-layer compute kernels for one instruction set.
+// Weights are row-major [out x in], matrices of samples are row-major [batch x width].
+struct KernelTable {
+    const char* name;
+
+    // Y = X * W^T + b, optionally followed by ReLU (fused bias-add and activation)
+    void (*dense_forward)(const float* w, const float* b, const float* x, float* y,
+                          int batch, int in, int out, bool relu);
+
+    // Parameter gradients as a batched outer product, accumulated into the caller's buffers:
+    // dW += dY^T * X, db += column sums of dY
+    void (*dense_backward_params)(const float* x, const float* dy, float* dw, float* db,
+                                  int batch, int in, int out);
+
+    // Input gradient dX = dY * W, masked by (X > 0) when X is a ReLU output
+    void (*dense_backward_input)(const float* w, const float* x, const float* dy, float* dx,
+                                 int batch, int in, int out, bool relu_mask);
+
+    // One fused Adam pass over n parameters and their moment buffers
+    void (*adam_update)(float* params, const float* grads, float* m, float* v, std::size_t n,
+                        const AdamStep& step);
+
+    // Polyak averaging in one pass: target = target + tau * (source - target)
+    void (*polyak_update)(float* target, const float* source, std::size_t n, float tau);
+
+    // dense_forward with int8 weights and one fp32 scale per output row, accumulated in fp32:
+    //   Y[r][o] = scales[o] * dot(W[o], X[r]) + b[o]
+    void (*quantized_dense_forward)(const std::int8_t* w, const float* scales, const float* b,
+                                    const float* x, float* y, int batch, int in, int out,
+                                    bool relu);
+
+    // The dense kernels above, specialized for the layers of kFixedTopology
+    FixedKernels fixed;
+};
+
+namespace detail {
+
+template <auto Forward, auto BackwardParams, auto BackwardInput, int L>
+constexpr FixedLayerKernels fixed_layer() {
+    constexpr int kIn = kFixedTopology[L];
+    constexpr int kOut = kFixedTopology[L + 1];
+    constexpr bool kRelu = L + 1 < kNumFixedLayers;
+    FixedLayerKernels layer = {
+        [](const float* w, const float* b, const float* x, float* y, int batch) {
+            Forward(w, b, x, y, batch, kIn, kOut, kRelu);
+        },
+        [](const float* x, const float* dy, float* dw, float* db, int batch) {
+            BackwardParams(x, dy, dw, db, batch, kIn, kOut);
+        },
+        nullptr,
+    };
+    if constexpr (L > 0) {
+        layer.backward_input = [](const float* w, const float* x, const float* dy, float* dx,
+                                  int batch) {
+            BackwardInput(w, x, dy, dx, batch, kIn, kOut, true);
+        };
+    }
+    return layer;
+}
+
+// Builds KernelTable::fixed from one translation unit's general kernels. The sizes become
+// constants at every call site, so the compiler specializes each kernel per layer with that
+// unit's instruction set; internal-linkage kernels keep each instantiation private to it.
+template <auto Forward, auto BackwardParams, auto BackwardInput>
+constexpr FixedKernels make_fixed_kernels() {
+    return {{fixed_layer<Forward, BackwardParams, BackwardInput, 0>(),
+             fixed_layer<Forward, BackwardParams, BackwardInput, 1>(),
+             fixed_layer<Forward, BackwardParams, BackwardInput, 2>()}};
+}
+
+} // namespace detail
+
+// Fastest table supported by this CPU, chosen on first use.
+// Setting FLAPPY_KERNELS=<name> in the environment forces a specific table.
+const KernelTable& active();
+
+// All tables compiled into this build that the running CPU can execute (scalar first)
+std::vector<const KernelTable*> available();
+
+// Table by name, or nullptr if it is not compiled in or not supported by this CPU
+const KernelTable* find(const char* name);
+
+} // namespace kernels
+} // namespace rl_dqn
+
+#endif // RL_DQN_KERNELS_H
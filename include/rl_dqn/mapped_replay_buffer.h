@@ -0,0 +1,112 @@
+#ifndef RL_DQN_MAPPED_REPLAY_BUFFER_H
+#define RL_DQN_MAPPED_REPLAY_BUFFER_H
+
+#include "rl_dqn/replay_buffer.h"
+#include "core/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rl_dqn {
+
+// On-disk replay segment format, version 1 (native little-endian):
+//
+//   [0, 64)         ReplaySegmentHeader, zero padded
+//   records         ReplayRecord[count]
+//
+// A directory holds one file per segment, named segment_<sequence>.replay. Files are
+// written whole (to a .tmp beside them, then renamed), so a crash never leaves a torn one.
+struct ReplaySegmentHeader {
+    char magic[8];                  // "FLPYRPLY"
+    std::uint32_t version;
+    std::uint32_t record_bytes;     // sizeof(ReplayRecord) as written by the producer
+    std::uint64_t sequence;         // segments are numbered in write order
+    std::uint64_t capacity;         // records in a full segment
+    std::uint64_t count;            // records present; below capacity only for the tail
+};
+
+// One transition, fixed size so a slot is a single offset into its segment
+struct ReplayRecord {
+    float state[kObservationSize];
+    float next_state[kObservationSize];
+    float reward;
+    std::uint8_t action;            // env_flappy::Action
+    std::uint8_t done;
+    std::uint8_t reserved[2];
+};
+
+inline constexpr std::uint32_t kReplaySegmentVersion = 1;
+inline constexpr std::size_t kReplaySegmentHeaderSize = 64;
+
+static_assert(sizeof(ReplayRecord) == 40, "ReplayRecord is part of the file format");
+
+// Uniform replay buffer backed by memory-mapped segment files, for capacities beyond RAM
+// and buffers that outlive the process.
+//
+// The ring of `capacity` slots is cut into segments of segment_records slots. New
+// transitions go to a hot in-memory tail segment; once it fills it is written out and
+// mapped read-only, replacing the oldest segment on disk when the ring is full. Sampling
+// reads records straight out of the mappings, so the OS pages in only what is sampled and
+// evicts cold segments under memory pressure.
+//
+// Opening a directory that already holds segments maps them in place (no copy, and no
+// read until they are sampled) and resumes the ring after them; the destructor and flush()
+// persist the partial tail. Segments must have been written with the same segment_records.
+class MappedReplayBuffer : public ReplayBuffer {
+public:
+    // capacity is rounded up to whole segments. Throws std::invalid_argument for a zero
+    // capacity or segment size, std::runtime_error for unusable or mismatched files.
+    MappedReplayBuffer(const std::string& directory, std::size_t capacity,
+                       std::size_t segment_records = 1 << 16, std::uint64_t seed = 12345);
+    ~MappedReplayBuffer() override;
+
+    MappedReplayBuffer(const MappedReplayBuffer&) = delete;
+    MappedReplayBuffer& operator=(const MappedReplayBuffer&) = delete;
+
+    void push(const Experience& experience) override;
+
+    using ReplayBuffer::sample;
+    void sample(std::size_t batch_size, TransitionBatch& batch) const override;
+
+    Experience at(std::size_t i) const override;
+
+    // Empties the buffer and deletes its segment files
+    void clear() override;
+
+    // Write the partially filled tail segment, so a buffer reopened later includes it
+    void flush();
+
+    const std::string& directory() const { return directory_; }
+    std::size_t segment_records() const { return segment_records_; }
+
+    // Sealed segments currently mapped (the tail is not counted)
+    std::size_t mapped_segments() const;
+
+private:
+    struct Segment {
+        core::MappedFile file;      // empty until the position has been written once
+        std::uint64_t sequence = 0;
+
+        const ReplayRecord* records() const {
+            return reinterpret_cast<const ReplayRecord*>(file.data() + kReplaySegmentHeaderSize);
+        }
+    };
+
+    std::string directory_;
+    std::size_t segment_records_;
+    std::vector<Segment> segments_;     // [ring position]
+    std::vector<ReplayRecord> tail_;    // next segment being filled, reserved up front
+    std::size_t tail_position_ = 0;     // ring position the tail overwrites
+    std::uint64_t tail_sequence_ = 0;
+
+    const ReplayRecord& record(std::size_t slot) const;
+    std::string segment_path(std::uint64_t sequence) const;
+    void write_tail() const;
+    void seal_tail();
+    void load();
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_MAPPED_REPLAY_BUFFER_H
@@ -0,0 +1,44 @@
+#ifndef RL_DQN_N_STEP_H
+#define RL_DQN_N_STEP_H
+
+#include "rl_dqn/replay_buffer.h"
+#include <cstddef>
+#include <vector>
+
+namespace rl_dqn {
+
+// Folds one environment's transition stream into n-step transitions before they reach the
+// replay buffer. Each emitted Experience keeps the first state and action of its window, with
+//   reward     = r_t + gamma r_{t+1} + ... + gamma^(n-1) r_{t+n-1}
+//   next_state = s_{t+n}
+// so the learner bootstraps with gamma^n instead of gamma. An episode end flushes the whole
+// window as shorter, terminal returns. n = 1 passes every transition through unchanged.
+// Keep one accumulator per environment: windows must never mix episodes of different envs.
+class NStepAccumulator {
+public:
+    NStepAccumulator(int n, float gamma);
+
+    // Add the next transition of this stream and append every completed n-step transition
+    // (none, one, or the full window on done) to `out`
+    void push(const Experience& step, std::vector<Experience>& out);
+
+    // Drop the pending window, e.g. when an episode is cut off without a terminal step
+    void reset() { count_ = 0; }
+
+    int n() const { return static_cast<int>(window_.size()); }
+    std::size_t pending() const { return count_; }
+
+private:
+    float gamma_;
+    std::vector<Experience> window_;  // ring of the last n steps, oldest at head_
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+
+    // Emit the oldest pending step with the discounted rewards of the whole window
+    void emit_oldest(const env_flappy::Observation& next_state, bool done,
+                     std::vector<Experience>& out);
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_N_STEP_H
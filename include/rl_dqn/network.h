@@ -1,15 +1,77 @@
+
 #ifndef RL_DQN_NETWORK_H
 #define RL_DQN_NETWORK_H
 
+#include "core/aligned.h"
 #include <vector>
+#include <concepts>
 #include <cstdint>
+#include <cstddef>
 #include <random>
+#include <span>
+#include <type_traits>
 
 namespace rl_dqn {
 
+// View of one dense layer inside a network's flat parameter buffer.
+// Weights are row-major [fan_out x fan_in] and are followed directly by fan_out biases.
+template <typename T>
+struct BasicLayerView {
+    T* weights;
+    T* biases;
+    int fan_in;
+    int fan_out;
+
+    // Row of weights feeding output neuron `neuron`
+    T* row(int neuron) const { return weights + static_cast<std::size_t>(neuron) * fan_in; }
+
+    // Mutable views convert to read-only ones
+    operator BasicLayerView<const T>() const
+        requires(!std::is_const_v<T>)
+    {
+        return {weights, biases, fan_in, fan_out};
+    }
+};
+
+using LayerView = BasicLayerView<float>;
+using ConstLayerView = BasicLayerView<const float>;
+
+// Fold an elementwise input transform x' = scale * x + shift into a layer, so that the layer
+// on raw x computes what it computed on x' before. Throws std::invalid_argument unless both
+// spans hold fan_in values.
+void fold_input_transform(LayerView layer, std::span<const float> scale,
+                          std::span<const float> shift);
+
+// Chain rule through fold_input_transform(): given the gradient `folded` ([out x in]
+// weights, then out biases) of the folded layer W' = W diag(scale), b' = b + W shift,
+// accumulate dW += dW' diag(scale) + db' shift^T and db += db' into the unfolded layer's
+// gradient
+void unfold_input_gradients(std::span<const float> folded, std::span<const float> scale,
+                            std::span<const float> shift, int fan_out, float* dw, float* db);
+
 // Simple feedforward neural network for DQN
 class Network {
 public:
+    // Activations kept by forward_batch() so backward_batch() does not recompute them.
+    // Buffers only grow, so reusing one cache across calls avoids reallocation.
+    struct BatchCache {
+        int batch_size = 0;
+        // activations[0] is the input, activations[l + 1] the output of layer l; [batch x width]
+        std::vector<core::AlignedVector<float>> activations;
+        // Scratch for the error signal flowing backwards through a layer
+        core::AlignedVector<float> delta;
+        core::AlignedVector<float> prev_delta;
+        // Gradient of the folded layer 0 with an input transform, [out x in] then [out]
+        core::AlignedVector<float> input_layer_gradients;
+
+        // Network output of the last forward_batch() call, [batch x out]
+        const float* output() const { return activations.back().data(); }
+
+        // Grow every buffer to hold `batch_size` rows of a network with `layer_sizes`, so
+        // forward/backward passes up to that size never allocate
+        void reserve(const std::vector<int>& layer_sizes, int batch_size);
+    };
+
     // Constructor: specify layer sizes (e.g., {4, 128, 128, 2})
     explicit Network(const std::vector<int>& layer_sizes, std::uint64_t seed = 12345);
 
@@ -24,6 +86,37 @@ public:
                   std::vector<std::vector<std::vector<float>>>& weight_gradients,
                   std::vector<std::vector<float>>& bias_gradients) const;
 
+    // Batched forward pass over a row-major [batch_size x in] input matrix.
+    // Returns the [batch_size x out] output block stored in `cache`.
+    const float* forward_batch(std::span<const float> inputs, int batch_size,
+                               BatchCache& cache) const;
+
+    // Fixed elementwise transform x' = scale * x + shift fused into the first layer, so the
+    // network computes f(x') from raw inputs x. parameters() keeps W and b, the weights for
+    // x', which training updates; layer 0 runs on a folded copy (fold_input_transform()) and
+    // backward maps its gradient back to W and b (unfold_input_gradients()). Inputs are
+    // never transformed themselves. Spans must hold one value per input
+    // (std::invalid_argument otherwise).
+    void set_input_transform(std::span<const float> scale, std::span<const float> shift);
+    bool has_input_transform() const { return !input_scale_.empty(); }
+    std::span<const float> input_scale() const { return input_scale_; }
+    std::span<const float> input_shift() const { return input_shift_; }
+
+    // Re-fold layer 0 after its parameters() changed (an optimizer step, a copy or load);
+    // forward passes run on the folded copy from the last call. No-op without a transform.
+    void refresh_input_transform();
+
+    // Layer 0 as the input kernels run it: the folded copy with an input transform, else
+    // layer(0)
+    ConstLayerView input_layer() const;
+
+    // Batched backward pass reusing the activations cached by the last forward_batch().
+    // `output_gradients` is dLoss/dOutput as a [batch x out] matrix. The gradient summed over
+    // the batch is added to `gradients` (same layout as parameters()), so callers zero it
+    // once and may accumulate several batches into it before an optimizer step.
+    void backward_batch(BatchCache& cache, std::span<const float> output_gradients,
+                        std::span<float> gradients) const;
+
     // Update weights and biases using gradients (called by optimizer)
     void update_weights(const std::vector<std::vector<std::vector<float>>>& weight_gradients,
                         const std::vector<std::vector<float>>& bias_gradients,
@@ -37,6 +130,18 @@ public:
     void set_weights(const std::vector<std::vector<std::vector<float>>>& weights);
     void set_biases(const std::vector<std::vector<float>>& biases);
 
+    // All parameters as one contiguous span: for each layer, its weights then its biases
+    std::span<float> parameters() { return {params_.data(), params_.size()}; }
+    std::span<const float> parameters() const { return {params_.data(), params_.size()}; }
+
+    // Per-layer views into the flat parameter buffer
+    std::size_t num_layers() const { return layer_offsets_.size(); }
+    LayerView layer(std::size_t index);
+    ConstLayerView layer(std::size_t index) const;
+
+    // Offset of a layer's weights inside parameters() (its biases follow the weights)
+    std::size_t layer_offset(std::size_t index) const { return layer_offsets_[index]; }
+
     // Get layer sizes
     const std::vector<int>& get_layer_sizes() const { return layer_sizes_; }
 
@@ -45,25 +150,53 @@ public:
 
 private:
     std::vector<int> layer_sizes_;
-    std::vector<std::vector<std::vector<float>>> weights_;  // [layer][neuron][weight]
-    std::vector<std::vector<float>> biases_;                // [layer][neuron]
-    
+    std::vector<std::size_t> layer_offsets_;  // [layer] -> start of weights in params_
+    core::AlignedVector<float> params_;       // all weights and biases, layer after layer
+    std::vector<float> input_scale_;          // empty without an input transform
+    std::vector<float> input_shift_;
+    core::AlignedVector<float> input_layer_;  // folded layer 0: weights, then biases
+
     mutable std::mt19937 rng_;
-    
-    // Activation functions
-    static float relu(float x);
-    static float relu_derivative(float x);
-    
+
     // Weight initialization (Xavier/He)
     void initialize_weights();
     float xavier_init(int fan_in, int fan_out);
-    
-    // Helper: matrix-vector multiplication
-    std::vector<float> matvec_mult(const std::vector<std::vector<float>>& W,
-                                    const std::vector<float>& x) const;
 };
 
+// Forward-only interface: all that InferenceContext needs to pick actions. Also satisfied
+// by the int8 QuantizedNetwork (rl_dqn/quantized_network.h).
+template <typename N>
+concept InferenceNetwork = requires(const N& network, std::span<const float> in,
+                                    Network::BatchCache& cache) {
+    { network.forward(std::vector<float>{}) } -> std::same_as<std::vector<float>>;
+    { network.forward_batch(in, 1, cache) } -> std::same_as<const float*>;
+    { network.get_layer_sizes() } -> std::convertible_to<const std::vector<int>&>;
+};
+
+// Interface shared by Network and FixedNetwork (rl_dqn/fixed_network.h): everything the
+// learner, the agent and inference need, all in terms of the flat parameter layout above
+template <typename N>
+concept DenseNetwork = InferenceNetwork<N> &&
+                       requires(N& network, const N& const_network, std::span<const float> in,
+                                std::span<float> grads, Network::BatchCache& cache) {
+    N(std::vector<int>{}, std::uint64_t{});
+    const_network.backward_batch(cache, in, grads);
+    network.set_input_transform(in, in);
+    { const_network.has_input_transform() } -> std::convertible_to<bool>;
+    { const_network.input_scale() } -> std::convertible_to<std::span<const float>>;
+    { const_network.input_shift() } -> std::convertible_to<std::span<const float>>;
+    network.refresh_input_transform();
+    { const_network.input_layer() } -> std::same_as<ConstLayerView>;
+    { network.parameters() } -> std::same_as<std::span<float>>;
+    { const_network.parameters() } -> std::same_as<std::span<const float>>;
+    { network.layer(std::size_t{}) } -> std::same_as<LayerView>;
+    { const_network.layer(std::size_t{}) } -> std::same_as<ConstLayerView>;
+    { const_network.layer_offset(std::size_t{}) } -> std::convertible_to<std::size_t>;
+    { const_network.num_layers() } -> std::convertible_to<std::size_t>;
+};
+
+static_assert(DenseNetwork<Network>);
+
 } // namespace rl_dqn
 
 #endif // RL_DQN_NETWORK_H
-
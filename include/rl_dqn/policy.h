@@ -0,0 +1,73 @@
+#ifndef RL_DQN_POLICY_H
+#define RL_DQN_POLICY_H
+
+#include "rl_dqn/dqn_config.h"
+#include "rl_dqn/inference.h"
+#include "rl_dqn/network.h"
+#include "rl_dqn/quantized_network.h"
+#include "core/rng.h"
+#include "env_flappy/env_flappy.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+
+// Acting half of DQN: epsilon-greedy action selection against a private copy of the
+// Q-network. Each actor thread owns one and refreshes it from a PolicySnapshot, so acting
+// never touches the learner's networks. With config.quantized_policy, actions come from an
+// int8 QuantizedNetwork re-quantized on every load_parameters().
+class Policy {
+public:
+    Policy(const DQNConfig& config, std::uint64_t seed);
+
+    // Random action with probability epsilon, otherwise argmax Q
+    env_flappy::Action select_action(const env_flappy::Observation& state, float epsilon);
+
+    // Argmax Q, no exploration
+    env_flappy::Action greedy_action(const env_flappy::Observation& state);
+
+    // Batch variant of select_action: one network pass for all observations
+    void select_actions(std::span<const env_flappy::Observation> states, float epsilon,
+                        std::span<env_flappy::Action> actions);
+
+    // Overwrite the local network with parameters laid out like Network::parameters()
+    void load_parameters(std::span<const float> parameters);
+
+    const Network& network() const { return network_; }
+    bool quantized() const { return quantized_.has_value(); }
+
+private:
+    Network network_;
+    std::optional<QuantizedNetwork> quantized_;
+    core::Pcg32 rng_;
+    InferenceContext inference_;
+};
+
+// Latest learner parameters, published for actors.
+// The learner calls publish() every so often; actors poll version() (one atomic load) and
+// copy the parameters out only when it has changed.
+class PolicySnapshot {
+public:
+    explicit PolicySnapshot(std::size_t num_parameters);
+
+    void publish(std::span<const float> parameters);
+
+    // Number of publish() calls so far
+    std::uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    // Copy the latest parameters into policy; returns the version that was copied
+    std::uint64_t read(Policy& policy) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<float> parameters_;
+    std::atomic<std::uint64_t> version_{0};
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_POLICY_H
@@ -0,0 +1,68 @@
+#ifndef RL_DQN_QUANTIZED_NETWORK_H
+#define RL_DQN_QUANTIZED_NETWORK_H
+
+#include "rl_dqn/network.h"
+#include "core/aligned.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+
+// Inference-only int8 export of a Network, for actors that only need greedy actions.
+// Each layer keeps its weights as int8 with one symmetric fp32 scale per output neuron
+// (scale = max |w| / 127 over the row), biases stay fp32 and activations are accumulated in
+// fp32 by the quantized_dense_forward kernel. Weights take a quarter of the fp32 bytes.
+class QuantizedNetwork {
+public:
+    // Empty network for the given topology; call quantize() before running it
+    explicit QuantizedNetwork(const std::vector<int>& layer_sizes);
+
+    // Quantized copy of any network sharing the flat parameter layout
+    template <DenseNetwork Net>
+    explicit QuantizedNetwork(const Net& network) : QuantizedNetwork(network.get_layer_sizes()) {
+        quantize(network.parameters());
+    }
+
+    // Re-quantize from fp32 parameters in the Network::parameters() layout, reusing storage
+    void quantize(std::span<const float> parameters);
+
+    // Forward pass for a single input
+    std::vector<float> forward(const std::vector<float>& input) const;
+
+    // Batched forward pass over a row-major [batch_size x in] input matrix.
+    // Returns the [batch_size x out] output block stored in `cache`.
+    const float* forward_batch(std::span<const float> inputs, int batch_size,
+                               Network::BatchCache& cache) const;
+
+    const std::vector<int>& get_layer_sizes() const { return layer_sizes_; }
+    std::size_t num_layers() const { return weight_offsets_.size(); }
+
+    // Number of fp32 parameters quantize() expects
+    std::size_t num_parameters() const { return num_parameters_; }
+
+    // Bytes of quantized state: int8 weights plus fp32 scales and biases
+    std::size_t size_bytes() const {
+        return weights_.size() * sizeof(std::int8_t) +
+               (scales_.size() + biases_.size()) * sizeof(float);
+    }
+
+    // Per-layer access for tests and serialization
+    std::span<const std::int8_t> weights(std::size_t layer) const;
+    std::span<const float> scales(std::size_t layer) const;
+    std::span<const float> biases(std::size_t layer) const;
+
+private:
+    std::vector<int> layer_sizes_;
+    std::size_t num_parameters_ = 0;
+    std::vector<std::size_t> weight_offsets_;   // [layer] -> start of its rows in weights_
+    std::vector<std::size_t> channel_offsets_;  // [layer] -> start in scales_ and biases_
+    core::AlignedVector<std::int8_t> weights_;  // row-major [out x in] per layer
+    core::AlignedVector<float> scales_;
+    core::AlignedVector<float> biases_;
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_QUANTIZED_NETWORK_H
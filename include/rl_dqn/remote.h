@@ -0,0 +1,150 @@
+#ifndef RL_DQN_REMOTE_H
+#define RL_DQN_REMOTE_H
+
+#include "rl_dqn/policy.h"
+#include "rl_dqn/replay_buffer.h"
+#include "rl_dqn/wire.h"
+#include "core/socket.h"
+#include "core/spsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rl_dqn {
+
+// Learner end of the remote actor protocol (rl_dqn/wire.h).
+//
+// Accepts actor connections in the background. Each connection gets a reader thread that
+// decodes experience batches into its own SPSC queue and a writer thread that sends the
+// latest snapshot, so neither the learner nor a slow link ever blocks the other: poll()
+// only pops queues, broadcast() only swaps in a new encoded snapshot. Writers skip
+// snapshots they had no time to send; a full queue stops its reader, which in turn backs
+// up the actor through TCP flow control.
+class ActorServer {
+public:
+    // `actor_config` is sent to every actor; actor ids count up from first_actor_id.
+    // Port 0 picks a free port. Throws std::runtime_error if it cannot listen.
+    ActorServer(std::uint16_t port, const wire::ActorConfig& actor_config,
+                std::uint32_t first_actor_id = 0, std::size_t queue_capacity = 1 << 16);
+    ~ActorServer();
+
+    ActorServer(const ActorServer&) = delete;
+    ActorServer& operator=(const ActorServer&) = delete;
+
+    std::uint16_t port() const { return listener_.port(); }
+
+    // Move up to max_items received transitions into `out` without blocking; call from one
+    // thread only. Also reaps connections that closed and were drained.
+    std::size_t poll(Experience* out, std::size_t max_items);
+
+    // Encode the parameters once and hand them to every connection (including later ones)
+    void broadcast(std::span<const float> parameters, float epsilon);
+
+    // Episode statistics reported by all remote actors so far
+    wire::EpisodeStats stats() const;
+
+    std::size_t num_connections() const;
+
+private:
+    struct Connection {
+        Connection(core::TcpSocket s, std::uint32_t id, std::size_t queue_capacity)
+            : socket(std::move(s)), actor_id(id), queue(queue_capacity) {}
+
+        core::TcpSocket socket;
+        std::uint32_t actor_id;
+        core::SpscQueue<Experience> queue;
+        std::atomic<bool> greeted{false};     // valid kHello received; config may be sent
+        std::atomic<bool> closed{false};
+        std::thread reader;
+        std::thread writer;
+    };
+
+    core::TcpListener listener_;
+    wire::ActorConfig actor_config_;
+    std::uint32_t next_actor_id_;
+    std::size_t queue_capacity_;
+    std::atomic<bool> stopping_{false};
+    std::thread accept_thread_;
+
+    mutable std::mutex connections_mutex_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+
+    // Latest encoded snapshot, shared by all writers
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_changed_;
+    std::shared_ptr<const std::vector<std::byte>> snapshot_;
+    std::uint64_t snapshot_version_ = 0;
+    std::uint64_t broadcasts_ = 0;        // broadcast() caller only
+
+    mutable std::mutex stats_mutex_;
+    wire::EpisodeStats stats_;
+
+    void accept_loop();
+    void read_loop(Connection& connection);
+    void write_loop(Connection& connection);
+    void close(Connection& connection);
+    void notify_writers();
+};
+
+// Actor end of the remote actor protocol.
+//
+// Connecting performs the handshake and returns the learner's ActorConfig. From then on a
+// sender thread batches pushed transitions into kExperiences frames (a batch grows while the
+// link is busy, so the frame rate adapts to the network), and a receiver thread decodes
+// snapshots into a PolicySnapshot that actor loops poll exactly like the local one.
+class LearnerClient {
+public:
+    // Throws std::runtime_error if the learner is unreachable or speaks another protocol
+    LearnerClient(const std::string& host, std::uint16_t port, std::uint32_t num_envs,
+                  std::size_t queue_capacity = 1 << 14);
+    ~LearnerClient();
+
+    LearnerClient(const LearnerClient&) = delete;
+    LearnerClient& operator=(const LearnerClient&) = delete;
+
+    const wire::ActorConfig& config() const { return config_; }
+
+    // Queue one transition, waiting while the queue is full; false once disconnected.
+    // Single producer: call from one thread.
+    bool push(const Experience& experience);
+
+    // Count one finished episode towards the statistics of the next batch
+    void add_episode(double episode_return, std::uint32_t pipes);
+
+    // Parameters from the learner; version() stays 0 until the first snapshot arrives
+    const PolicySnapshot& snapshot() const { return *snapshot_; }
+
+    // Exploration rate sent with the latest snapshot
+    float epsilon() const { return epsilon_.load(std::memory_order_relaxed); }
+
+    // False once the learner closed the connection or it failed
+    bool connected() const { return !closed_.load(std::memory_order_acquire); }
+
+private:
+    core::TcpSocket socket_;
+    wire::ActorConfig config_;
+    std::unique_ptr<PolicySnapshot> snapshot_;
+    core::SpscQueue<Experience> queue_;
+    std::atomic<float> epsilon_{1.0f};
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex stats_mutex_;
+    wire::EpisodeStats pending_stats_;
+
+    std::thread sender_;
+    std::thread receiver_;
+
+    void send_loop();
+    void receive_loop();
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_REMOTE_H
@@ -2,13 +2,28 @@
 #define RL_DQN_REPLAY_BUFFER_H
 
 #include "env_flappy/env_flappy.h"
+#include "rl_dqn/sum_tree.h"
+#include "core/aligned.h"
 #include <vector>
 #include <cstdint>
 #include <random>
 #include <cstddef>
+#include <span>
 
 namespace rl_dqn {
 
+// Network input width: one float per Observation field (env_flappy::ObservationSchema)
+inline constexpr std::size_t kObservationSize = env_flappy::kObservationSize;
+
+// Write an observation as one row of a network input matrix
+inline void write_observation(const env_flappy::Observation& obs, float* row) {
+    env_flappy::ObservationSchema::write(obs, row);
+}
+
+inline env_flappy::Observation read_observation(const float* row) {
+    return env_flappy::ObservationSchema::read(row);
+}
+
 // Experience tuple: (state, action, reward, next_state, done)
 struct Experience {
     env_flappy::Observation state;
@@ -18,38 +33,138 @@ struct Experience {
     bool done;
 };
 
-// Replay buffer for DQN experience storage
+// A sampled batch, one column per field. states and next_states are row-major
+// [size x kObservationSize] matrices ready for Network::forward_batch.
+struct TransitionBatch {
+    std::size_t size = 0;
+    core::AlignedVector<float> states;
+    core::AlignedVector<float> next_states;
+    std::vector<env_flappy::Action> actions;
+    std::vector<float> rewards;
+    std::vector<std::uint8_t> dones;
+    std::vector<std::size_t> slots;  // buffer slot of each sample, for priority updates
+    std::vector<float> weights;      // importance-sampling loss weights (1 when uniform)
+
+    void resize(std::size_t batch_size);
+};
+
+// Replay buffer for DQN experience storage.
+// Transitions are stored as columns (structure-of-arrays) in a fixed-capacity ring.
 class ReplayBuffer {
 public:
     ReplayBuffer(std::size_t capacity, std::uint64_t seed = 12345);
+    virtual ~ReplayBuffer() = default;
     
     // Add experience to buffer
-    void push(const Experience& experience);
+    virtual void push(const Experience& experience);
     
     // Sample a random batch of experiences
     std::vector<Experience> sample(std::size_t batch_size) const;
+
+    // Sample batch_size distinct experiences into `batch`, reusing its storage.
+    // Cost depends only on batch_size, never on the buffer size.
+    void sample(std::size_t batch_size, std::vector<Experience>& batch) const;
+
+    // Same sampling, gathered straight into column batch storage
+    virtual void sample(std::size_t batch_size, TransitionBatch& batch) const;
+
+    // Feed back the TD errors of a sampled batch; a no-op for uniform replay
+    virtual void update_priorities(std::span<const std::size_t> slots,
+                                   std::span<const float> td_errors);
+
+    // Experience stored at slot i (0 <= i < size())
+    virtual Experience at(std::size_t i) const;
     
     // Check if we have enough samples for training
     bool can_sample(std::size_t batch_size) const;
     
     // Get current size
-    std::size_t size() const { return experiences_.size(); }
+    std::size_t size() const { return size_; }
     
     // Get capacity
     std::size_t capacity() const { return capacity_; }
     
     // Clear buffer
-    void clear();
+    virtual void clear();
+
+protected:
+    // For subclasses that store transitions themselves: ring bookkeeping and sampling only,
+    // no column storage
+    struct ExternalStorage {};
+    ReplayBuffer(std::size_t capacity, std::uint64_t seed, ExternalStorage);
+
+    // Slot the next push() will write
+    std::size_t next_slot() const { return write_index_; }
+
+    // Take the next slot in the ring; the caller writes the transition there
+    std::size_t claim_slot();
+
+    // Resume the ring at a saved position (storage loaded by a subclass)
+    void restore(std::size_t size, std::size_t next_slot);
+
+    // batch_size distinct slots below size(), in a buffer reused across calls
+    std::span<const std::size_t> sample_indices(std::size_t batch_size) const;
+
+    // Copy the given slots into batch (resized to slots.size()); weights are left alone
+    void gather(std::span<const std::size_t> slots, TransitionBatch& batch) const;
+
+    mutable std::mt19937 rng_;
 
 private:
-    std::vector<Experience> experiences_;
     std::size_t capacity_;
+    std::size_t size_;
     std::size_t write_index_;  // Current write position for circular buffer
-    mutable std::mt19937 rng_;
+    mutable std::vector<std::size_t> indices_;  // sampling scratch, reused across calls
+
+    // Columns, one entry (or kObservationSize floats) per slot
+    core::AlignedVector<float> states_;
+    core::AlignedVector<float> next_states_;
+    std::vector<env_flappy::Action> actions_;
+    std::vector<float> rewards_;
+    std::vector<std::uint8_t> dones_;
 };
 
-} // namespace rl_dqn
+// Proportional prioritized replay (Schaul et al., 2016).
+// Slot i is sampled with probability p_i / sum(p), p_i = (|td_error_i| + epsilon)^alpha, and
+// every sample carries the importance-sampling weight (p_i / p_min)^-beta so the largest
+// possible weight is 1. New experiences get the largest priority seen so far, so each is
+// replayed at least once soon after it arrives.
+class PrioritizedReplayBuffer : public ReplayBuffer {
+public:
+    PrioritizedReplayBuffer(std::size_t capacity,
+                            float alpha = 0.6f,
+                            float epsilon = 1e-6f,
+                            std::uint64_t seed = 12345);
 
-#endif // RL_DQN_REPLAY_BUFFER_H
+    void push(const Experience& experience) override;
+
+    // Stratified sampling: the priority mass is split into batch_size equal segments and one
+    // slot is drawn from each, so duplicates are possible but every batch spans the buffer
+    void sample(std::size_t batch_size, TransitionBatch& batch) const override;
+
+    // Bulk update: one tree pass per level no matter how many slots change
+    void update_priorities(std::span<const std::size_t> slots,
+                           std::span<const float> td_errors) override;
+
+    void clear() override;
 
+    // Importance-sampling exponent, usually annealed from ~0.4 to 1 over training
+    void set_beta(float beta) { beta_ = beta; }
+    float beta() const { return beta_; }
 
+    float priority(std::size_t slot) const { return tree_.get(slot); }
+
+private:
+    float alpha_;
+    float epsilon_;
+    float beta_ = 0.4f;
+    float max_priority_ = 1.0f;
+    SumTree tree_;
+
+    mutable std::vector<std::size_t> sampled_slots_;  // reused across calls
+    std::vector<float> new_priorities_;
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_REPLAY_BUFFER_H
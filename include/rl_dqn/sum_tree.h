@@ -0,0 +1,64 @@
+#ifndef RL_DQN_SUM_TREE_H
+#define RL_DQN_SUM_TREE_H
+
+#include "core/aligned.h"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+
+// Array-backed sum/min tree over `capacity` non-negative priorities.
+//
+// Every node has kFanout children stored contiguously, so a node's children fill exactly
+// one cache line and a root-to-leaf walk touches one line per level (log16 N levels: six
+// for a 16M-entry buffer). Parents are always recomputed from their children rather than
+// patched with deltas, so float sums never drift no matter how many updates are applied.
+class SumTree {
+public:
+    static constexpr std::size_t kFanout = core::kCacheLineSize / sizeof(float);
+
+    explicit SumTree(std::size_t capacity);
+
+    std::size_t capacity() const { return capacity_; }
+
+    // Sum of all priorities
+    float total() const { return sums_.back()[0]; }
+
+    // Smallest priority set since the last clear(); +infinity when empty
+    float min() const { return mins_.back()[0]; }
+
+    float get(std::size_t index) const { return sums_[0][index]; }
+
+    // Set one priority, O(log N)
+    void set(std::size_t index, float priority);
+
+    // Set many priorities, then refresh each touched parent once per level.
+    // Later entries win when an index repeats.
+    void set(std::span<const std::size_t> indices, std::span<const float> priorities);
+
+    // Leaf whose cumulative range [prefix, prefix + priority) contains mass, for
+    // 0 <= mass < total(). Masses past the end (float round-off) map to the last
+    // non-empty leaf.
+    std::size_t find(float mass) const;
+
+    // Reset every priority to zero
+    void clear();
+
+private:
+    std::size_t capacity_;
+
+    // Level 0 holds the leaves; the last level is the single root. Each level below the
+    // root is padded to a multiple of kFanout with neutral entries (0 / +infinity).
+    std::vector<core::AlignedVector<float>> sums_;
+    std::vector<core::AlignedVector<float>> mins_;
+
+    // Parents touched by a bulk update, reused across calls
+    std::vector<std::size_t> dirty_;
+
+    void refresh(std::size_t level, std::size_t node);
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_SUM_TREE_H
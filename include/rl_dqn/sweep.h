@@ -0,0 +1,84 @@
+#ifndef RL_DQN_SWEEP_H
+#define RL_DQN_SWEEP_H
+
+#include "rl_dqn/dqn_config.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rl_dqn {
+
+// One swept DQNConfig field: a list of grid values, or a range drawn from per trial
+struct SweepParameter {
+    std::string name;                // see set_config_value()
+    std::vector<double> values;      // grid values (empty for ranges)
+    bool log_scale = false;          // range: uniform in log(value) instead of value
+    double low = 0.0;
+    double high = 0.0;
+
+    bool is_range() const { return values.empty(); }
+};
+
+// Sweep spec, one parameter per line ('#' starts a comment):
+//
+//   learning_rate = log_uniform(1e-5, 1e-3)
+//   gamma = 0.97, 0.99
+//   hidden = 64, 128
+//   double_dqn = false, true
+//
+// With only value lists the sweep is the full grid. Any uniform(low, high) or
+// log_uniform(low, high) range makes it a random search instead, where every trial draws each
+// range and picks one value from each list.
+struct SweepSpec {
+    std::vector<SweepParameter> parameters;
+
+    bool is_random() const;
+};
+
+// Throws std::invalid_argument naming the line for malformed lines, unknown or repeated
+// parameters and empty or inverted ranges
+SweepSpec parse_sweep_spec(std::istream& in);
+
+// Set DQNConfig field `name` and return the value it now holds. Integer fields round, boolean
+// fields take 0 or 1, and `hidden` sets the width of every hidden layer. Throws
+// std::invalid_argument for unknown names and values the field cannot hold.
+double set_config_value(DQNConfig& config, const std::string& name, double value);
+
+struct SweepTrial {
+    std::size_t index = 0;
+    DQNConfig config;
+    std::vector<double> values;      // per spec parameter, as applied to config
+};
+
+// Trials of a sweep on top of `base`. A grid yields every combination (the last parameter
+// varies fastest) and ignores `samples`; a random search yields `samples` trials drawn from a
+// PCG32 stream seeded with `seed`. Trial i trains with seed base.seed + i.
+std::vector<SweepTrial> expand_sweep(const SweepSpec& spec, const DQNConfig& base,
+                                     std::size_t samples, std::uint64_t seed);
+
+// Median stopping rule for concurrently running trials: a trial is stopped at an evaluation
+// round when its score falls below the median that other trials reported for the same round,
+// once at least `min_reports` of them have. Rounds before `grace_rounds` never stop a trial.
+// Trials that reach a round first have nothing to compare against and continue, so which
+// trials stop depends on how they interleave; every trial on its own stays deterministic.
+// Thread-safe.
+class MedianStoppingRule {
+public:
+    explicit MedianStoppingRule(std::size_t min_reports = 4, std::size_t grace_rounds = 1);
+
+    // Record a trial's score for `round`; false when the trial should stop
+    bool report(std::size_t round, double score);
+
+private:
+    std::size_t min_reports_;
+    std::size_t grace_rounds_;
+    std::mutex mutex_;
+    std::vector<std::vector<double>> scores_;   // per round, in arrival order
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_SWEEP_H
@@ -0,0 +1,58 @@
+#ifndef RL_DQN_TRAIN_WORKSPACE_H
+#define RL_DQN_TRAIN_WORKSPACE_H
+
+#include "rl_dqn/network.h"
+#include "rl_dqn/replay_buffer.h"
+#include "core/aligned.h"
+#include <cstddef>
+#include <vector>
+
+namespace rl_dqn {
+
+// Every buffer one training step touches, sized once for the configured batch.
+// The learner reserves it at construction; afterwards train() only writes into existing
+// storage, so a step performs no heap allocation.
+struct TrainWorkspace {
+    // Scratch of one data-parallel shard: a contiguous row range of the batch, run forward and
+    // backward on its own caches into its own gradient buffer
+    struct Shard {
+        Network::BatchCache online_cache;          // online pass over states (kept for backward)
+        Network::BatchCache target_cache;          // target pass over next_states
+        Network::BatchCache online_next_cache;     // Double DQN: online pass over next_states
+        core::AlignedVector<float> gradients;      // same layout as Network::parameters()
+        float loss = 0.0f;                         // summed weighted squared TD error
+    };
+
+    TransitionBatch batch;                     // sampled transitions, [batch x 4] states
+    core::AlignedVector<float> output_gradients;  // [batch x 2] dLoss/dQ
+    std::vector<float> targets;
+    std::vector<float> td_errors;
+    std::vector<Shard> shards;                 // shards[0].gradients receives the reduction
+
+    // Rows [begin, end) of the batch owned by `shard`
+    std::size_t shard_begin(std::size_t shard, std::size_t batch_size) const {
+        return shard * batch_size / shards.size();
+    }
+
+    void reserve(const std::vector<int>& layer_sizes, int batch_size,
+                 std::size_t num_parameters, std::size_t num_shards) {
+        std::size_t rows = static_cast<std::size_t>(batch_size);
+        batch.resize(rows);
+        output_gradients.reserve(rows * layer_sizes.back());
+        targets.reserve(rows);
+        td_errors.reserve(rows);
+
+        shards.resize(num_shards);
+        int shard_rows = static_cast<int>((rows + num_shards - 1) / num_shards);
+        for (Shard& shard : shards) {
+            shard.online_cache.reserve(layer_sizes, shard_rows);
+            shard.target_cache.reserve(layer_sizes, shard_rows);
+            shard.online_next_cache.reserve(layer_sizes, shard_rows);
+            shard.gradients.reserve(num_parameters);
+        }
+    }
+};
+
+} // namespace rl_dqn
+
+#endif // RL_DQN_TRAIN_WORKSPACE_H
@@ -0,0 +1,115 @@
+#ifndef RL_DQN_WIRE_H
+#define RL_DQN_WIRE_H
+
+#include "rl_dqn/replay_buffer.h"
+#include "core/socket.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rl_dqn {
+namespace wire {
+
+// Binary protocol between remote actors (app_actor) and the learner (app_train --listen),
+// version 1, native little-endian like checkpoints. Every message is one frame:
+//
+//   FrameHeader     magic "FRLW", type, payload_bytes
+//   payload
+//
+// Actor -> learner:
+//   kHello          uint32 protocol version, uint32 environments stepped by the actor
+//   kExperiences    uint32 count, uint32 episodes, uint32 pipes, float64 return_sum
+//                   (episode statistics finished since the previous batch), then columns:
+//                   float32 states[count x 4], float32 next_states[count x 4],
+//                   float32 rewards[count], uint8 flags[count] (bit 0 FLAP, bit 1 done)
+//                   = 37 bytes per transition
+// Learner -> actor:
+//   kConfig         uint32 actor id, uint64 seed, uint32 n_step, float32 gamma,
+//                   uint8 quantized_policy, uint8 snapshot encoding, uint32 layer count,
+//                   int32 layer_sizes[] (each at most kMaxLayerSize; the fp32
+//                   snapshot of the network must fit in kMaxPayloadBytes)
+//   kSnapshot       uint64 version, float32 epsilon, uint8 encoding, then parameters:
+//                   kFloat32: float32[num_parameters], Network::parameters() layout
+//                   kInt8: per layer float32 scales[out], int8 weights[out x in],
+//                   float32 biases[out] (QuantizedNetwork rows, about 4x smaller)
+//
+// Decoders validate sizes and throw std::runtime_error on malformed input.
+inline constexpr std::uint32_t kProtocolVersion = 1;
+inline constexpr std::uint32_t kMaxPayloadBytes = 64u << 20;
+inline constexpr std::int32_t kMaxLayerSize = 1 << 16;
+
+enum class MessageType : std::uint16_t { kHello = 1, kConfig, kExperiences, kSnapshot };
+
+enum class SnapshotEncoding : std::uint8_t { kFloat32 = 0, kInt8 = 1 };
+
+struct FrameHeader {
+    char magic[4];                  // "FRLW"
+    std::uint16_t type;             // MessageType
+    std::uint16_t reserved;
+    std::uint32_t payload_bytes;
+};
+
+struct Hello {
+    std::uint32_t version = kProtocolVersion;
+    std::uint32_t num_envs = 0;
+};
+
+// What an actor needs from the learner to produce compatible transitions
+struct ActorConfig {
+    std::uint32_t actor_id = 0;     // for disjoint seed streams across actors
+    std::uint64_t seed = 0;         // learner's base seed; actors derive theirs from it
+    int n_step = 1;
+    float gamma = 0.99f;
+    bool quantized_policy = false;
+    SnapshotEncoding encoding = SnapshotEncoding::kFloat32;
+    std::vector<int> layer_sizes;
+};
+
+// Episode statistics carried alongside a batch of transitions
+struct EpisodeStats {
+    std::uint32_t episodes = 0;
+    std::uint32_t pipes = 0;
+    double return_sum = 0.0;
+};
+
+struct SnapshotInfo {
+    std::uint64_t version = 0;
+    float epsilon = 1.0f;
+    SnapshotEncoding encoding = SnapshotEncoding::kFloat32;
+};
+
+// Parameters of a network with these layer sizes, in the Network::parameters() layout
+std::size_t num_parameters(const std::vector<int>& layer_sizes);
+
+// Encoders replace the contents of `out`, reusing its capacity
+void encode_hello(const Hello& hello, std::vector<std::byte>& out);
+Hello decode_hello(std::span<const std::byte> payload);
+
+void encode_config(const ActorConfig& config, std::vector<std::byte>& out);
+ActorConfig decode_config(std::span<const std::byte> payload);
+
+void encode_experiences(std::span<const Experience> experiences, const EpisodeStats& stats,
+                        std::vector<std::byte>& out);
+// Appends the decoded transitions to `out`
+EpisodeStats decode_experiences(std::span<const std::byte> payload,
+                                std::vector<Experience>& out);
+
+// kInt8 quantizes every layer's weights per output row, as QuantizedNetwork does
+void encode_snapshot(std::span<const float> parameters, const std::vector<int>& layer_sizes,
+                     const SnapshotInfo& info, std::vector<std::byte>& out);
+// `parameters` must already have the layer_sizes parameter count; int8 snapshots are
+// dequantized into it
+SnapshotInfo decode_snapshot(std::span<const std::byte> payload,
+                             const std::vector<int>& layer_sizes, std::span<float> parameters);
+
+// Write one frame (header + payload)
+void send_message(core::TcpSocket& socket, MessageType type, std::span<const std::byte> payload);
+
+// Read one frame into `payload`; false when the peer closed the connection between frames
+bool recv_message(core::TcpSocket& socket, MessageType& type, std::vector<std::byte>& payload);
+
+} // namespace wire
+} // namespace rl_dqn
+
+#endif // RL_DQN_WIRE_H
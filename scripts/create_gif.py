@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Turn frames written by `app_play --replay PATH --frames DIR` into an animated GIF.
+
+Frames are read in name order (frame_000000.bmp, frame_000001.bmp, ...). One frame per
+environment step plays in real time at 60 fps; with `app_play --every N` pass --fps 60/N
+for real time, or keep 60 for an N-times fast-forward.
+
+    app_play --replay eval.rec --episode 3 --every 2 --frames frames/
+    python scripts/create_gif.py frames/ -o episode3.gif --fps 30
+"""
+
+import argparse
+import pathlib
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("frames", help="directory written by app_play --frames")
+    parser.add_argument("-o", "--output", default="replay.gif", help="GIF to write")
+    parser.add_argument("--fps", type=float, default=60.0, help="playback rate (default 60)")
+    parser.add_argument("--scale", type=float, default=0.5,
+                        help="resize factor, GIFs get large quickly (default 0.5)")
+    args = parser.parse_args()
+
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("create_gif.py needs Pillow (pip install pillow)")
+
+    paths = sorted(pathlib.Path(args.frames).glob("frame_*.bmp"))
+    if not paths:
+        sys.exit(f"{args.frames}: no frame_*.bmp files")
+
+    frames = []
+    for path in paths:
+        with Image.open(path) as image:
+            if args.scale != 1.0:
+                size = (max(1, round(image.width * args.scale)),
+                        max(1, round(image.height * args.scale)))
+                image = image.resize(size, Image.NEAREST)
+            # The game draws a handful of flat colors, which a 32-color palette keeps exact
+            frames.append(image.convert("RGB").quantize(colors=32))
+
+    duration_ms = max(20, round(1000.0 / args.fps))  # most viewers clamp faster GIFs
+    frames[0].save(args.output, save_all=True, append_images=frames[1:],
+                   duration=duration_ms, loop=0, optimize=True)
+    print(f"wrote {args.output}: {len(frames)} frames at {1000.0 / duration_ms:.0f} fps")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Plot a training log written by `app_train --telemetry PATH`.
+
+The log is CSV (header row) or JSON Lines when the path ends in .json. Draws learning
+curves (episode return, loss, epsilon), throughput (env and train steps per second) and a
+stacked breakdown of hot-path time per logging interval.
+
+    python scripts/plot_training.py train.csv            # interactive window
+    python scripts/plot_training.py train.csv -o run.png # save instead
+"""
+
+import argparse
+import csv
+import json
+import sys
+
+PROBES = ["env_step", "action_select", "replay_sample", "forward", "backward",
+          "optimizer", "target_sync"]
+
+
+def load_rows(path):
+    with open(path, newline="") as f:
+        if path.endswith(".json"):
+            # Non-finite values (a diverged loss) are logged as null
+            return [{k: float("nan") if v is None else v for k, v in json.loads(line).items()}
+                    for line in f if line.strip()]
+        return [{k: float(v) for k, v in row.items()} for row in csv.DictReader(f)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="telemetry log from app_train --telemetry")
+    parser.add_argument("-o", "--output", help="write the figure to this file")
+    args = parser.parse_args()
+
+    try:
+        import matplotlib
+        if args.output:
+            matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        sys.exit("plot_training.py needs matplotlib (pip install matplotlib)")
+
+    rows = load_rows(args.log)
+    if not rows:
+        sys.exit(f"{args.log}: no rows")
+    steps = [r["env_steps"] for r in rows]
+
+    fig, axes = plt.subplots(2, 2, figsize=(12, 8), sharex=True)
+    ax = axes[0][0]
+    ax.plot(steps, [r["episode_return"] for r in rows])
+    ax.set_title("Mean episode return")
+
+    ax = axes[0][1]
+    ax.plot(steps, [r["loss"] for r in rows], label="loss")
+    ax.set_yscale("log")
+    ax.set_title("Loss / epsilon")
+    eps = ax.twinx()
+    eps.plot(steps, [r["epsilon"] for r in rows], color="tab:orange", label="epsilon")
+    eps.set_ylim(0, 1)
+
+    ax = axes[1][0]
+    ax.plot(steps, [r["steps_per_sec"] for r in rows], label="env steps/s")
+    ax.plot(steps, [r["train_steps_per_sec"] for r in rows], label="train steps/s")
+    ax.set_title("Throughput")
+    ax.legend()
+
+    # Probe columns read zero when app_train was built with FLAPPY_TELEMETRY=OFF
+    ax = axes[1][1]
+    probes = [p for p in PROBES if f"{p}_ms" in rows[0]]
+    ax.stackplot(steps, *[[r[f"{p}_ms"] for r in rows] for p in probes], labels=probes)
+    ax.set_title("Hot-path time per interval (ms, all threads)")
+    ax.legend(loc="upper left", fontsize="small")
+
+    for ax in axes[1]:
+        ax.set_xlabel("environment steps")
+    fig.tight_layout()
+    if args.output:
+        fig.savefig(args.output, dpi=120)
+    else:
+        plt.show()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,157 @@
+#include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/n_step.h"
+#include "rl_dqn/policy.h"
+#include "rl_dqn/remote.h"
+#include "env_flappy/env_flappy.h"
+#include "env_flappy/vec_env.h"
+#include "core/core.h"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ActorOptions {
+    std::string host;
+    std::uint16_t port = 0;
+    int envs = 8;                        // environments stepped in lockstep
+    long long max_steps = 0;             // stop after this many env steps (0: until the
+                                         // learner disconnects)
+};
+
+void print_usage() {
+    std::cout << "Usage: app_actor --connect HOST:PORT [options]\n"
+              << "  --envs N          environments stepped in lockstep (default 8)\n"
+              << "  --steps N         stop after N environment steps (default: run until the\n"
+              << "                    learner finishes)\n";
+}
+
+bool parse_options(int argc, char** argv, ActorOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--connect" && has_value) {
+            std::string address = argv[++i];
+            std::size_t colon = address.rfind(':');
+            if (colon == std::string::npos || colon == 0) {
+                return false;
+            }
+            options.host = address.substr(0, colon);
+            int port = std::stoi(address.substr(colon + 1));
+            if (port <= 0 || port > 65535) {
+                return false;
+            }
+            options.port = static_cast<std::uint16_t>(port);
+        } else if (arg == "--envs" && has_value) {
+            options.envs = std::stoi(argv[++i]);
+        } else if (arg == "--steps" && has_value) {
+            options.max_steps = std::stoll(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return !options.host.empty() && options.envs > 0 && options.max_steps >= 0;
+}
+
+} // namespace
+
+// Remote actor: the same loop as app_train's actor threads, with the SPSC queue and the
+// policy snapshot replaced by a connection to the learner
+int main(int argc, char** argv) {
+    std::cout << "FlappyRL - Remote Actor" << std::endl;
+    core::init();
+    rl_dqn::init();
+
+    ActorOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        const std::size_t num_envs = static_cast<std::size_t>(options.envs);
+        rl_dqn::LearnerClient client(options.host, options.port,
+                                     static_cast<std::uint32_t>(num_envs));
+        const rl_dqn::wire::ActorConfig& remote = client.config();
+        std::cout << "Connected to " << options.host << ":" << options.port << " as actor "
+                  << remote.actor_id << std::endl;
+
+        rl_dqn::DQNConfig config;
+        config.layer_sizes = remote.layer_sizes;
+        config.n_step = remote.n_step;
+        config.gamma = remote.gamma;
+        config.quantized_policy = remote.quantized_policy;
+
+        // Seeds follow app_train's local actors, so ids above the local ones never collide
+        const std::uint64_t id = remote.actor_id;
+        rl_dqn::Policy policy(config, remote.seed + 1000 + id);
+        env_flappy::FlappyVecEnv envs(num_envs, remote.seed + (id << 32));
+
+        // Act only on learner parameters
+        while (client.snapshot().version() == 0 && client.connected()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::uint64_t version = client.snapshot().read(policy);
+
+        std::vector<env_flappy::Observation> observations(num_envs);
+        std::vector<env_flappy::Observation> previous(num_envs);
+        std::vector<env_flappy::Action> actions(num_envs);
+        std::vector<float> rewards(num_envs);
+        std::vector<std::uint8_t> dones(num_envs);
+        envs.observe(observations);
+
+        std::vector<rl_dqn::NStepAccumulator> accumulators(
+            num_envs, rl_dqn::NStepAccumulator(config.n_step, config.gamma));
+        std::vector<rl_dqn::Experience> folded;
+        std::vector<double> episode_returns(num_envs, 0.0);
+        std::vector<std::uint32_t> episode_pipes(num_envs, 0);
+
+        const auto start = std::chrono::steady_clock::now();
+        long long steps = 0;
+        std::uint64_t episodes = 0;
+        bool connected = true;
+        while (connected && (options.max_steps == 0 || steps < options.max_steps)) {
+            if (client.snapshot().version() != version) {
+                version = client.snapshot().read(policy);
+            }
+            policy.select_actions(observations, client.epsilon(), actions);
+
+            previous = observations;
+            envs.step(actions, observations, rewards, dones);
+            steps += static_cast<long long>(num_envs);
+
+            for (std::size_t i = 0; i < num_envs && connected; ++i) {
+                rl_dqn::Experience exp{previous[i], actions[i], rewards[i], observations[i],
+                                       dones[i] != 0};
+                folded.clear();
+                accumulators[i].push(exp, folded);
+                for (const rl_dqn::Experience& transition : folded) {
+                    connected = connected && client.push(transition);
+                }
+                episode_pipes[i] += rewards[i] > 0.0f ? 1 : 0;
+                episode_returns[i] += rewards[i];
+                if (dones[i]) {
+                    client.add_episode(episode_returns[i], episode_pipes[i]);
+                    episode_returns[i] = 0.0;
+                    episode_pipes[i] = 0;
+                    ++episodes;
+                }
+            }
+        }
+
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << (connected ? "Done: " : "Learner disconnected: ") << steps << " steps, "
+                  << episodes << " episodes in " << std::fixed << std::setprecision(1)
+                  << seconds << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/evaluation.h"
+#include "rl_dqn/network.h"
+#include "rl_dqn/quantized_network.h"
+#include "env_flappy/recording.h"
+#include "core/core.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct EvalOptions {
+    std::string checkpoint_path;
+    rl_dqn::EvalConfig eval;
+    bool quantized = false;              // evaluate the int8 export actors would run
+    std::string json_path;               // write the summary as JSON when set
+    std::string record_path;             // write every episode for app_play --replay
+    double min_score = -std::numeric_limits<double>::infinity();  // gate on the mean score
+};
+
+void print_usage() {
+    std::cout << "Usage: app_eval --checkpoint PATH [options]\n"
+              << "  --episodes N      greedy episodes to play (default 1000)\n"
+              << "  --threads N       worker threads (default: all cores)\n"
+              << "  --seed N          episode i uses env seed N + i (default 1)\n"
+              << "  --batch N         episodes stepped together per chunk (default 16)\n"
+              << "  --max-steps N     truncate episodes after N steps (default 10000)\n"
+              << "  --quantized       evaluate the int8 QuantizedNetwork export\n"
+              << "  --json PATH       write the summary as JSON\n"
+              << "  --record PATH     record every episode for app_play --replay\n"
+              << "  --min-score X     exit with status 2 if the mean score is below X\n";
+}
+
+bool parse_options(int argc, char** argv, EvalOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--quantized") {
+            options.quantized = true;
+        } else if (arg == "--checkpoint" && has_value) {
+            options.checkpoint_path = argv[++i];
+        } else if (arg == "--episodes" && has_value) {
+            options.eval.episodes = std::stoull(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            options.eval.threads = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.eval.seed = std::stoull(argv[++i]);
+        } else if (arg == "--batch" && has_value) {
+            options.eval.batch = std::stoull(argv[++i]);
+        } else if (arg == "--max-steps" && has_value) {
+            options.eval.max_steps = std::stoi(argv[++i]);
+        } else if (arg == "--json" && has_value) {
+            options.json_path = argv[++i];
+        } else if (arg == "--record" && has_value) {
+            options.record_path = argv[++i];
+        } else if (arg == "--min-score" && has_value) {
+            options.min_score = std::stod(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return !options.checkpoint_path.empty() && options.eval.episodes > 0 &&
+           options.eval.threads >= 0 && options.eval.batch > 0 && options.eval.max_steps > 0;
+}
+
+// "p5 ... p95" columns of one metric
+template <class T>
+std::string percentile_row(const T (&values)[5]) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    for (std::size_t i = 0; i < 5; ++i) {
+        out << "  p" << static_cast<int>(rl_dqn::EvalSummary::kPercentiles[i]) << " "
+            << values[i];
+    }
+    return out.str();
+}
+
+template <class T>
+std::string json_array(const T (&values)[5]) {
+    std::ostringstream out;
+    out << std::setprecision(9) << "[";
+    for (std::size_t i = 0; i < 5; ++i) {
+        out << values[i] << (i + 1 < 5 ? ", " : "]");
+    }
+    return out.str();
+}
+
+void write_json(const std::string& path, const EvalOptions& options,
+                const rl_dqn::EvalSummary& s) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    out << std::setprecision(9) << "{\n"
+        << "  \"checkpoint\": \"" << options.checkpoint_path << "\",\n"
+        << "  \"quantized\": " << (options.quantized ? "true" : "false") << ",\n"
+        << "  \"seed\": " << options.eval.seed << ",\n"
+        << "  \"max_steps\": " << options.eval.max_steps << ",\n"
+        << "  \"episodes\": " << s.episodes << ",\n"
+        << "  \"truncated\": " << s.truncated << ",\n"
+        << "  \"mean_score\": " << s.mean_score << ",\n"
+        << "  \"stddev_score\": " << s.stddev_score << ",\n"
+        << "  \"mean_pipes\": " << s.mean_pipes << ",\n"
+        << "  \"max_pipes\": " << s.max_pipes << ",\n"
+        << "  \"mean_length\": " << s.mean_length << ",\n"
+        << "  \"percentiles\": " << json_array(rl_dqn::EvalSummary::kPercentiles) << ",\n"
+        << "  \"score_percentiles\": " << json_array(s.score_percentiles) << ",\n"
+        << "  \"pipes_percentiles\": " << json_array(s.pipes_percentiles) << ",\n"
+        << "  \"length_percentiles\": " << json_array(s.length_percentiles) << ",\n"
+        << "  \"digest\": \"" << std::hex << std::setw(16) << std::setfill('0') << s.digest
+        << "\"\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::cout << "FlappyRL - Evaluation Application" << std::endl;
+    core::init();
+    rl_dqn::init();
+
+    EvalOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        rl_dqn::Checkpoint checkpoint(options.checkpoint_path);
+        rl_dqn::Network network(checkpoint.layer_sizes(), 0);
+        std::span<const float> parameters = checkpoint.parameters();
+        std::copy(parameters.begin(), parameters.end(), network.parameters().begin());
+
+        std::cout << "Checkpoint " << options.checkpoint_path << " ("
+                  << checkpoint.header().training_steps << " training steps), "
+                  << options.eval.episodes << " episodes from seed " << options.eval.seed
+                  << (options.quantized ? ", int8" : "") << std::endl;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<rl_dqn::EpisodeResult> results;
+        std::vector<env_flappy::EpisodeRecording> recordings;
+        auto* record = options.record_path.empty() ? nullptr : &recordings;
+        if (options.quantized) {
+            results = rl_dqn::evaluate_policy(rl_dqn::QuantizedNetwork(network), options.eval,
+                                              record);
+        } else {
+            results = rl_dqn::evaluate_policy(network, options.eval, record);
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rl_dqn::EvalSummary s = rl_dqn::summarize(results);
+
+        long long steps = 0;
+        for (const rl_dqn::EpisodeResult& r : results) {
+            steps += r.length;
+        }
+        std::cout << std::fixed << std::setprecision(3)
+                  << "score   mean " << s.mean_score << "  std " << s.stddev_score
+                  << percentile_row(s.score_percentiles) << "\n"
+                  << "pipes   mean " << s.mean_pipes << "  max " << s.max_pipes
+                  << percentile_row(s.pipes_percentiles) << "\n"
+                  << "length  mean " << s.mean_length << percentile_row(s.length_percentiles)
+                  << "\n"
+                  << "truncated " << s.truncated << " / " << s.episodes << " at "
+                  << options.eval.max_steps << " steps\n"
+                  << "digest  " << std::hex << std::setw(16) << std::setfill('0') << s.digest
+                  << std::dec << std::setfill(' ') << "\n"
+                  << std::setprecision(2) << seconds << " s, " << std::setprecision(0)
+                  << steps / std::max(seconds, 1e-9) << " steps/s" << std::endl;
+
+        if (!options.json_path.empty()) {
+            write_json(options.json_path, options, s);
+        }
+        if (record) {
+            env_flappy::write_recording(options.record_path, options.eval.env, recordings);
+            std::cout << "Recorded " << recordings.size() << " episodes to "
+                      << options.record_path << std::endl;
+        }
+        if (s.mean_score < options.min_score) {
+            std::cout << "FAIL: mean score " << std::setprecision(3) << s.mean_score
+                      << " is below --min-score " << options.min_score << std::endl;
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
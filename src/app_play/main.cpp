@@ -1,19 +1,357 @@
 #include "env_flappy/env_flappy.h"
+#include "env_flappy/recording.h"
 #include "render_sdl/render_sdl.h"
+#include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/inference.h"
+#include "rl_dqn/network.h"
 #include "core/core.h"
+#include "core/latest_value.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <span>
+#include <string>
 #include <thread>
+#include <vector>
 
 #ifdef HAVE_SDL2
 #include <SDL2/SDL.h>
 #endif
 
-int main() {
+namespace {
+
+struct PlayOptions {
+    std::string replay_path;             // play back a recording instead of the keyboard
+    std::size_t first_episode = 0;
+    std::size_t num_episodes = 1;        // 0: every episode from first_episode on
+    int skip = 0;                        // fast-forward this many steps of each episode
+    int every = 1;                       // then draw every Nth step
+    std::string frames_dir;              // write drawn frames as BMPs instead of a window
+    bool no_render = false;              // simulate and summarize only
+
+    std::string checkpoint_path;         // let this policy fly instead of the keyboard
+    std::uint64_t seed = 12345;          // first episode's seed, then one per episode
+    double speed = 1.0;                  // simulation ticks per Config::dt of wall time
+    bool vsync = true;
+};
+
+void print_usage() {
+    std::cout << "Usage: app_play [--replay PATH [options] | --checkpoint PATH [options]]\n"
+              << "  --replay PATH     play back a recording (app_eval --record)\n"
+              << "  --episode N       first episode to play (default 0)\n"
+              << "  --episodes N      episodes to play (default 1, 0: all)\n"
+              << "  --skip N          fast-forward the first N steps of each episode\n"
+              << "  --every N         draw every Nth step, fast-forward the rest (default 1)\n"
+              << "  --frames DIR      render off-screen into DIR/frame_NNNNNN.bmp\n"
+              << "                    (scripts/create_gif.py turns them into a GIF)\n"
+              << "  --no-render       only replay and print each episode's result\n"
+              << "  --checkpoint PATH let a trained policy play (app_train --out)\n"
+              << "  --seed N          first episode's seed (default 12345)\n"
+              << "  --speed X         simulation speed relative to real time (default 1)\n"
+              << "  --no-vsync        render as fast as possible instead of per refresh\n";
+}
+
+bool parse_options(int argc, char** argv, PlayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--no-render") {
+            options.no_render = true;
+        } else if (arg == "--replay" && has_value) {
+            options.replay_path = argv[++i];
+        } else if (arg == "--episode" && has_value) {
+            options.first_episode = std::stoull(argv[++i]);
+        } else if (arg == "--episodes" && has_value) {
+            options.num_episodes = std::stoull(argv[++i]);
+        } else if (arg == "--skip" && has_value) {
+            options.skip = std::stoi(argv[++i]);
+        } else if (arg == "--every" && has_value) {
+            options.every = std::stoi(argv[++i]);
+        } else if (arg == "--frames" && has_value) {
+            options.frames_dir = argv[++i];
+        } else if (arg == "--no-vsync") {
+            options.vsync = false;
+        } else if (arg == "--checkpoint" && has_value) {
+            options.checkpoint_path = argv[++i];
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--speed" && has_value) {
+            options.speed = std::stod(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    bool replay_only = options.no_render || !options.frames_dir.empty() ||
+                       options.first_episode > 0 || options.num_episodes != 1 ||
+                       options.skip != 0 || options.every != 1;
+    bool agent_only = options.seed != 12345 || options.speed != 1.0 || !options.vsync;
+    if (!options.checkpoint_path.empty()) {
+        return options.replay_path.empty() && !replay_only && options.speed > 0.0;
+    }
+    return (!options.replay_path.empty() || !replay_only) && !agent_only &&
+           options.skip >= 0 && options.every > 0;
+}
+
+// Replay recorded episodes: FlappyEnv is deterministic, so the seed and actions rebuild every
+// frame. Steps that are not drawn cost one env step, so long episodes fast-forward at
+// simulation speed; a window shows the drawn frames at 60 fps.
+int replay(const PlayOptions& options) {
+    env_flappy::Recording recording = env_flappy::read_recording(options.replay_path);
+    if (options.first_episode >= recording.episodes.size()) {
+        std::cerr << "Recording has only " << recording.episodes.size() << " episodes"
+                  << std::endl;
+        return 1;
+    }
+    std::size_t last = options.num_episodes == 0
+                           ? recording.episodes.size()
+                           : std::min(recording.episodes.size(),
+                                      options.first_episode + options.num_episodes);
+
+    render_sdl::Renderer renderer;
+    if (!options.no_render) {
+        render_sdl::RenderConfig render_config;
+        render_config.offscreen = !options.frames_dir.empty();
+        if (render_config.offscreen) {
+            std::filesystem::create_directories(options.frames_dir);
+        }
+        if (!renderer.initialize(render_config)) {
+            std::cerr << "Failed to initialize SDL renderer. Make sure SDL2 is installed."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    const auto frame_time = std::chrono::milliseconds(1000 / 60);
+    long long frames = 0;
+    bool quit = false;
+    for (std::size_t e = options.first_episode; e < last && !quit; ++e) {
+        const env_flappy::EpisodeRecording& episode = recording.episodes[e];
+        env_flappy::FlappyEnv env(episode.seed, recording.config);
+        float score = 0.0f;
+        int pipes = 0;
+        std::uint32_t step = 0;
+        for (; step < episode.length && !env.done() && !quit; ++step) {
+            env_flappy::StepResult result = env.step(episode.action(step));
+            score += result.reward;
+            pipes += !result.done && result.reward > recording.config.r_step ? 1 : 0;
+
+            int drawn = static_cast<int>(step) + 1 - options.skip;
+            if (options.no_render || drawn <= 0 || drawn % options.every != 0) {
+                continue;
+            }
+            auto frame_start = std::chrono::steady_clock::now();
+            renderer.draw(env);
+            if (!options.frames_dir.empty()) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "frame_%06lld.bmp", frames);
+                std::string path = (std::filesystem::path(options.frames_dir) / name).string();
+                if (!renderer.save_frame(path)) {
+                    std::cerr << "Cannot write " << path << std::endl;
+                    return 1;
+                }
+            } else {
+                renderer.present();
+                renderer.poll_events();
+                quit = renderer.should_close();
+                auto elapsed = std::chrono::steady_clock::now() - frame_start;
+                if (elapsed < frame_time) {
+                    std::this_thread::sleep_for(frame_time - elapsed);
+                }
+            }
+            ++frames;
+        }
+
+        std::cout << "Episode " << e << " (seed " << episode.seed << "): " << step
+                  << " steps, " << pipes << " pipes, score " << score;
+        if (step < episode.length && !quit) {
+            // The episode ended before its recorded actions did: not the recorder's physics
+            std::cout << " - diverged, recording has " << episode.length << " steps";
+        }
+        std::cout << std::endl;
+    }
+    if (!options.frames_dir.empty()) {
+        std::cout << "Wrote " << frames << " frames to " << options.frames_dir << std::endl;
+    }
+    renderer.shutdown();
+    return 0;
+}
+
+// What the simulation thread hands to the render loop after every tick
+struct Frame {
+    env_flappy::FlappyEnv env{0};
+    std::uint64_t tick = 0;
+};
+
+struct SimulationStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t late_ticks = 0;        // started more than one tick behind schedule
+    double max_behind_ms = 0.0;
+};
+
+// Fly the policy at a fixed Config::dt per tick, paced against steady_clock deadlines rather
+// than sleeps of whatever the last frame left over. Greedy actions are computed inline, so
+// each episode matches `app_eval` for the same seed; the render loop only ever copies out
+// the latest Frame and never waits on Network::forward.
+void simulate(const rl_dqn::Network& network, const PlayOptions& options,
+              core::LatestValue<Frame>& latest, const std::atomic<bool>& stop,
+              SimulationStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    Frame frame;
+    std::uint64_t seed = options.seed;
+    env_flappy::Observation observation = frame.env.reset(seed);
+    latest.publish(frame);
+
+    rl_dqn::InferenceContext inference;
+    env_flappy::Action action = env_flappy::Action::NO_FLAP;
+    float score = 0.0f;
+    int pipes = 0;
+    int episode = 0;
+
+    const auto tick = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(frame.env.config().dt / options.speed));
+    auto deadline = Clock::now();
+    while (!stop.load(std::memory_order_relaxed)) {
+        deadline += tick;
+        auto now = Clock::now();
+        if (now > deadline) {
+            double behind_ms = std::chrono::duration<double, std::milli>(now - deadline).count();
+            stats.max_behind_ms = std::max(stats.max_behind_ms, behind_ms);
+            if (now > deadline + tick) {
+                // Resynchronize instead of bursting through the missed ticks
+                ++stats.late_ticks;
+                deadline = now;
+            }
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+
+        if (frame.env.done()) {
+            // The final frame of the last episode was shown for one tick
+            std::cout << "Episode " << episode << " (seed " << seed << "): "
+                      << frame.env.steps() << " steps, " << pipes << " pipes, score " << score
+                      << std::endl;
+            ++episode;
+            observation = frame.env.reset(++seed);
+            score = 0.0f;
+            pipes = 0;
+        } else {
+            inference.greedy_actions(network, std::span(&observation, 1),
+                                     std::span(&action, 1));
+            env_flappy::StepResult result = frame.env.step(action);
+            observation = result.observation;
+            score += result.reward;
+            pipes += !result.done && result.reward > frame.env.config().r_step ? 1 : 0;
+        }
+        ++frame.tick;
+        ++stats.ticks;
+        latest.publish(frame);
+    }
+}
+
+// Watch a checkpoint play. Rendering runs on this thread as fast as present() allows (one
+// frame per display refresh with vsync) and always draws the newest simulation state; frame
+// times are measured and summarized at exit instead of assumed.
+int play_agent(const PlayOptions& options) {
+    rl_dqn::Checkpoint checkpoint(options.checkpoint_path);
+    rl_dqn::Network network(checkpoint.layer_sizes(), 0);
+    std::span<const float> parameters = checkpoint.parameters();
+    std::copy(parameters.begin(), parameters.end(), network.parameters().begin());
+    std::cout << "Checkpoint " << options.checkpoint_path << " ("
+              << checkpoint.header().training_steps << " training steps), seed "
+              << options.seed << ", speed " << options.speed << "x"
+              << (options.vsync ? "" : ", no vsync") << std::endl;
+
+    render_sdl::Renderer renderer;
+    render_sdl::RenderConfig render_config;
+    render_config.vsync = options.vsync;
+    if (!renderer.initialize(render_config)) {
+        std::cerr << "Failed to initialize SDL renderer. Make sure SDL2 is installed."
+                  << std::endl;
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    core::LatestValue<Frame> latest;
+    std::atomic<bool> stop{false};
+    SimulationStats sim_stats;
+    std::thread simulation([&]() { simulate(network, options, latest, stop, sim_stats); });
+
+    std::vector<float> frame_ms;
+    frame_ms.reserve(1 << 16);
+    std::uint64_t shown_tick = 0;
+    std::uint64_t unseen_ticks = 0;      // simulated but replaced before they were drawn
+    const auto start = Clock::now();
+    auto last_present = start;
+    while (true) {
+        renderer.poll_events();
+        if (renderer.should_close()) {
+            break;
+        }
+        if (latest.update()) {
+            const std::uint64_t tick = latest.value().tick;
+            unseen_ticks += tick > shown_tick + 1 ? tick - shown_tick - 1 : 0;
+            shown_tick = tick;
+        }
+        renderer.render(latest.value().env);
+
+        auto now = Clock::now();
+        frame_ms.push_back(std::chrono::duration<float, std::milli>(now - last_present).count());
+        last_present = now;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    simulation.join();
+    renderer.shutdown();
+
+    double seconds = std::chrono::duration<double>(last_present - start).count();
+    if (!frame_ms.empty() && seconds > 0.0) {
+        std::vector<float> sorted = frame_ms;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            std::size_t rank = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1));
+            return sorted[rank];
+        };
+        const float p50 = percentile(50.0);
+        std::size_t hitches = std::count_if(sorted.begin(), sorted.end(),
+                                            [p50](float ms) { return ms > 2.0f * p50; });
+        std::cout << "Frames: " << frame_ms.size() << " in " << seconds << " s ("
+                  << frame_ms.size() / seconds << " fps), frame time p50 " << p50
+                  << " ms, p99 " << percentile(99.0) << " ms, max " << sorted.back()
+                  << " ms, " << hitches << " hitches (> 2x p50)" << std::endl;
+    }
+    std::cout << "Simulation: " << sim_stats.ticks << " ticks, " << sim_stats.late_ticks
+              << " late (at most " << sim_stats.max_behind_ms << " ms behind), "
+              << unseen_ticks << " never drawn" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
     std::cout << "FlappyRL - Play Application" << std::endl;
     
     core::init();
+    rl_dqn::init();
     
+    PlayOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+    if (!options.replay_path.empty() || !options.checkpoint_path.empty()) {
+        try {
+            return options.replay_path.empty() ? play_agent(options) : replay(options);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // Initialize SDL renderer
     render_sdl::Renderer renderer;
     if (!renderer.initialize()) {
@@ -0,0 +1,311 @@
+#include "env_flappy/env_flappy.h"
+#include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/dqn_agent.h"
+#include "rl_dqn/evaluation.h"
+#include "rl_dqn/sweep.h"
+#include "core/core.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct SweepOptions {
+    std::string spec_path;
+    std::size_t samples = 16;            // trials of a random search
+    long long steps = 200000;            // environment steps per trial
+    long long eval_every = 20000;        // environment steps between evaluations
+    std::size_t eval_episodes = 50;
+    int jobs = 0;                        // concurrent trials (0: all cores)
+    std::uint64_t seed = 12345;          // trial i trains with seed + i
+    bool early_stop = true;
+    std::size_t min_reports = 4;         // scores per round before trials can be stopped
+    bool pin = true;                     // pin each worker thread to its own core
+    std::string init_path;               // warm-start every trial from this checkpoint
+    std::string csv_path;
+};
+
+// Read-only inputs every trial shares: loaded or mapped once for the whole sweep
+struct SweepContext {
+    const SweepOptions& options;
+    rl_dqn::EvalConfig eval;
+    const rl_dqn::Checkpoint* init = nullptr;
+    rl_dqn::MedianStoppingRule* stopping = nullptr;
+};
+
+struct TrialResult {
+    long long steps = 0;                 // environment steps taken
+    bool stopped = false;                // cut short by the stopping rule
+    double score = 0.0;                  // latest evaluation's mean score
+    double best_score = 0.0;
+    double mean_pipes = 0.0;             // of the latest evaluation
+    double seconds = 0.0;
+};
+
+void print_usage() {
+    std::cout << "Usage: app_sweep --spec PATH [options]\n"
+              << "  --spec PATH       sweep spec, one 'name = values' line per parameter:\n"
+              << "                    'a, b, c' grid, 'uniform(lo, hi)' / 'log_uniform(lo, hi)'\n"
+              << "                    random search\n"
+              << "  --samples N       trials of a random search (default 16)\n"
+              << "  --steps N         environment steps per trial (default 200000)\n"
+              << "  --eval-every N    evaluate every N steps (default 20000)\n"
+              << "  --eval-episodes N greedy episodes per evaluation (default 50)\n"
+              << "  --jobs N          trials run concurrently (default: all cores)\n"
+              << "  --seed N          trial i trains with seed N + i (default 12345)\n"
+              << "  --min-reports N   scores per evaluation round before the median rule\n"
+              << "                    stops trials (default 4)\n"
+              << "  --no-early-stop   run every trial to the end\n"
+              << "  --no-pin          leave worker threads to the scheduler\n"
+              << "  --init PATH       warm-start every trial from one checkpoint\n"
+              << "  --csv PATH        also write the results table as CSV\n";
+}
+
+bool parse_options(int argc, char** argv, SweepOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--no-early-stop") {
+            options.early_stop = false;
+        } else if (arg == "--no-pin") {
+            options.pin = false;
+        } else if (arg == "--spec" && has_value) {
+            options.spec_path = argv[++i];
+        } else if (arg == "--samples" && has_value) {
+            options.samples = std::stoull(argv[++i]);
+        } else if (arg == "--steps" && has_value) {
+            options.steps = std::stoll(argv[++i]);
+        } else if (arg == "--eval-every" && has_value) {
+            options.eval_every = std::stoll(argv[++i]);
+        } else if (arg == "--eval-episodes" && has_value) {
+            options.eval_episodes = std::stoull(argv[++i]);
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--min-reports" && has_value) {
+            options.min_reports = std::stoull(argv[++i]);
+        } else if (arg == "--init" && has_value) {
+            options.init_path = argv[++i];
+        } else if (arg == "--csv" && has_value) {
+            options.csv_path = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return !options.spec_path.empty() && options.steps > 0 && options.eval_every > 0 &&
+           options.eval_episodes > 0 && options.jobs >= 0;
+}
+
+// Train one DQNAgent on its own FlappyEnv, evaluating every eval_every steps against the
+// shared episode seeds so trials are compared on the same episodes
+TrialResult run_trial(const rl_dqn::SweepTrial& trial, const SweepContext& context) {
+    const auto start = std::chrono::steady_clock::now();
+    const rl_dqn::DQNConfig& config = trial.config;
+    rl_dqn::DQNAgent agent(config);
+    if (context.init) {
+        agent.learner().load_checkpoint(*context.init);
+    }
+
+    // Training episodes draw from a seed range of their own, far from the evaluation seeds
+    std::uint64_t episode_seed = config.seed << 32;
+    env_flappy::FlappyEnv env(episode_seed);
+    env_flappy::Observation observation = env.observe();
+
+    TrialResult result;
+    std::size_t round = 0;
+    for (long long step = 1; step <= context.options.steps; ++step) {
+        env_flappy::Action action = agent.select_action(observation);
+        env_flappy::StepResult outcome = env.step(action);
+        agent.store_experience(observation, action, outcome.reward, outcome.observation,
+                               outcome.done);
+        observation = outcome.done ? env.reset(++episode_seed) : outcome.observation;
+
+        if (step % config.train_frequency == 0 &&
+            agent.learner().replay_buffer().can_sample(config.batch_size)) {
+            agent.train();
+            if (config.target_tau <= 0.0f &&
+                agent.get_training_steps() % config.target_update_frequency == 0) {
+                agent.update_target_network();
+            }
+        }
+
+        result.steps = step;
+        if (step % context.options.eval_every != 0 && step != context.options.steps) {
+            continue;
+        }
+        rl_dqn::EvalSummary summary = rl_dqn::summarize(
+            rl_dqn::evaluate_policy(agent.learner().network(), context.eval));
+        result.score = summary.mean_score;
+        result.best_score = round == 0 ? summary.mean_score
+                                       : std::max(result.best_score, summary.mean_score);
+        result.mean_pipes = summary.mean_pipes;
+        if (context.stopping && step < context.options.steps &&
+            !context.stopping->report(round, summary.mean_score)) {
+            result.stopped = true;
+            break;
+        }
+        ++round;
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Best latest score first
+std::vector<std::size_t> ranking(const std::vector<TrialResult>& results) {
+    std::vector<std::size_t> order(results.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&results](std::size_t a, std::size_t b) {
+        return results[a].score > results[b].score;
+    });
+    return order;
+}
+
+void print_table(std::ostream& out, const rl_dqn::SweepSpec& spec,
+                 const std::vector<rl_dqn::SweepTrial>& trials,
+                 const std::vector<TrialResult>& results) {
+    out << std::setw(6) << "trial";
+    for (const rl_dqn::SweepParameter& parameter : spec.parameters) {
+        out << "  " << std::setw(std::max<int>(10, static_cast<int>(parameter.name.size())))
+            << parameter.name;
+    }
+    out << "  " << std::setw(9) << "steps" << "  " << std::setw(8) << "status" << "  "
+        << std::setw(8) << "score" << "  " << std::setw(8) << "best" << "  " << std::setw(8)
+        << "pipes" << "  " << std::setw(7) << "seconds" << "\n";
+    for (std::size_t i : ranking(results)) {
+        const TrialResult& r = results[i];
+        out << std::setw(6) << i;
+        for (std::size_t p = 0; p < spec.parameters.size(); ++p) {
+            int width = std::max<int>(10, static_cast<int>(spec.parameters[p].name.size()));
+            out << "  " << std::setw(width) << std::setprecision(4) << std::defaultfloat
+                << trials[i].values[p];
+        }
+        out << "  " << std::setw(9) << r.steps << "  " << std::setw(8)
+            << (r.stopped ? "stopped" : "done") << std::fixed << std::setprecision(3) << "  "
+            << std::setw(8) << r.score << "  " << std::setw(8) << r.best_score << "  "
+            << std::setw(8) << r.mean_pipes << "  " << std::setw(7) << std::setprecision(1)
+            << r.seconds << std::defaultfloat << "\n";
+    }
+}
+
+void write_csv(const std::string& path, const rl_dqn::SweepSpec& spec,
+               const std::vector<rl_dqn::SweepTrial>& trials,
+               const std::vector<TrialResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    out << "trial,seed";
+    for (const rl_dqn::SweepParameter& parameter : spec.parameters) {
+        out << "," << parameter.name;
+    }
+    out << ",steps,stopped,score,best_score,mean_pipes,seconds\n" << std::setprecision(9);
+    for (std::size_t i : ranking(results)) {
+        const TrialResult& r = results[i];
+        out << i << "," << trials[i].config.seed;
+        for (double value : trials[i].values) {
+            out << "," << value;
+        }
+        out << "," << r.steps << "," << (r.stopped ? 1 : 0) << "," << r.score << ","
+            << r.best_score << "," << r.mean_pipes << "," << r.seconds << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::cout << "FlappyRL - Hyperparameter Sweep" << std::endl;
+
+    core::init();
+    rl_dqn::init();
+
+    SweepOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        std::ifstream spec_file(options.spec_path);
+        if (!spec_file) {
+            throw std::runtime_error("Cannot open " + options.spec_path);
+        }
+        rl_dqn::SweepSpec spec = rl_dqn::parse_sweep_spec(spec_file);
+
+        // Trials run side by side, one core each: no learner threads, replay in memory
+        rl_dqn::DQNConfig base;
+        base.seed = options.seed;
+        base.learner_threads = 1;
+        std::vector<rl_dqn::SweepTrial> trials =
+            rl_dqn::expand_sweep(spec, base, options.samples, options.seed);
+
+        std::unique_ptr<rl_dqn::Checkpoint> init;
+        if (!options.init_path.empty()) {
+            init = std::make_unique<rl_dqn::Checkpoint>(options.init_path);
+            for (const rl_dqn::SweepTrial& trial : trials) {
+                if (trial.config.layer_sizes != init->layer_sizes()) {
+                    throw std::invalid_argument("Trial " + std::to_string(trial.index) +
+                                                " does not match the --init layer sizes");
+                }
+            }
+        }
+
+        rl_dqn::MedianStoppingRule stopping(options.min_reports);
+        SweepContext context{options, {}, init.get(),
+                             options.early_stop ? &stopping : nullptr};
+        context.eval.episodes = options.eval_episodes;
+        context.eval.max_steps = 2000;
+        context.eval.threads = 1;        // each trial evaluates on its own core
+
+        std::size_t jobs = options.jobs > 0 ? static_cast<std::size_t>(options.jobs)
+                                            : std::max(1u, std::thread::hardware_concurrency());
+        core::ThreadPool pool(std::min(jobs, trials.size()));
+        std::cout << (spec.is_random() ? "Random search: " : "Grid: ") << trials.size()
+                  << " trials x " << options.steps << " steps on " << pool.size()
+                  << " threads" << (options.early_stop ? ", median stopping" : "")
+                  << (init ? ", warm start from " + options.init_path : "") << std::endl;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<TrialResult> results(trials.size());
+        std::mutex print_mutex;
+        pool.parallel_for(trials.size(), [&](std::size_t i, std::size_t worker) {
+            if (options.pin) {
+                core::pin_current_thread(worker);
+            }
+            results[i] = run_trial(trials[i], context);
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << "Trial " << i << (results[i].stopped ? " stopped" : " finished")
+                      << " after " << results[i].steps << " steps, score " << std::fixed
+                      << std::setprecision(3) << results[i].score << std::defaultfloat
+                      << std::endl;
+        });
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "\n";
+        print_table(std::cout, spec, trials, results);
+        std::cout << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+        if (!options.csv_path.empty()) {
+            write_csv(options.csv_path, spec, trials, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
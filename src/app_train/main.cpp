@@ -1,21 +1,495 @@
 #include "env_flappy/env_flappy.h"
+#include "env_flappy/vec_env.h"
 #include "rl_dqn/rl_dqn.h"
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/dqn_learner.h"
+#include "rl_dqn/evaluation.h"
+#include "rl_dqn/n_step.h"
+#include "rl_dqn/policy.h"
+#include "rl_dqn/remote.h"
 #include "core/core.h"
+#include "core/spsc_queue.h"
+#include "core/telemetry.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main() {
+namespace {
+
+struct TrainOptions {
+    int actors = 2;                      // actor threads
+    int envs_per_actor = 8;              // environments stepped in lockstep per actor
+    long long total_steps = 500000;      // environment steps across all actors
+    int publish_interval = 200;          // learner steps between policy snapshots
+    long long log_interval = 50000;      // environment steps between progress lines
+    std::size_t queue_capacity = 4096;   // transitions in flight per actor
+    std::uint64_t seed = 12345;
+    bool prioritized = false;
+    bool quantized = false;              // actors act on an int8 copy of the network
+    float tau = 0.0f;                    // > 0: Polyak target updates instead of hard syncs
+    int n_step = 1;                      // n-step returns, folded on the actor side
+    bool double_dqn = false;
+    bool normalize = false;              // learn on normalized observations (fused into layer 0)
+    std::size_t batch_size = 32;         // transitions per training step
+    int learner_threads = 1;             // data-parallel shards per training step
+    std::size_t replay_size = 0;         // replay capacity (0: DQNConfig default)
+    std::string replay_directory;        // on-disk replay segments when set
+    std::string checkpoint_path;         // written at the end when set
+    std::string telemetry_path;          // per-interval CSV (or .json lines) log when set
+    int eval_every = 0;                  // learner steps between greedy evaluations (0: off)
+    std::size_t eval_episodes = 200;
+    int eval_threads = 0;                // evaluation pool size (0: all cores)
+    int listen_port = -1;                // accept remote actors (app_actor) when >= 0
+    bool wire_int8 = false;              // send remote actors int8 snapshots
+};
+
+// Per-actor counters, written by the actor and read by the learner for logging
+struct alignas(core::kCacheLineSize) ActorStats {
+    std::atomic<std::uint64_t> episodes{0};
+    std::atomic<std::uint64_t> pipes_passed{0};
+    std::atomic<double> return_sum{0.0};  // summed returns of finished episodes
+};
+
+struct SharedState {
+    std::atomic<bool> stop{false};
+    std::atomic<long long> env_steps{0};  // steps taken by all actors, drives epsilon
+};
+
+void print_usage() {
+    std::cout << "Usage: app_train [options]\n"
+              << "  --actors N        actor threads (default 2)\n"
+              << "  --envs N          environments per actor (default 8)\n"
+              << "  --steps N         total environment steps (default 500000)\n"
+              << "  --seed N          base random seed (default 12345)\n"
+              << "  --prioritized     use prioritized experience replay\n"
+              << "  --quantized       actors select actions with an int8 network\n"
+              << "  --tau X           soft target updates with rate X every step\n"
+              << "  --n-step N        store N-step returns (default 1)\n"
+              << "  --double          Double DQN targets\n"
+              << "  --normalize       learn on normalized observations, fused into the first\n"
+              << "                    layer (snapshots and checkpoints hold folded weights)\n"
+              << "  --batch N         transitions per training step (default 32)\n"
+              << "  --learner-threads N  split each training batch over N threads (default 1)\n"
+              << "  --replay N        replay buffer capacity (default 10000)\n"
+              << "  --replay-dir DIR  keep the replay buffer in memory-mapped files in DIR;\n"
+              << "                    a later run with the same DIR resumes with them\n"
+              << "  --out PATH        write a checkpoint when training finishes\n"
+              << "  --telemetry PATH  log rates, loss and hot-path timings every interval\n"
+              << "  --eval-every N    greedy evaluation every N training steps (default off)\n"
+              << "  --eval-episodes N episodes per evaluation (default 200)\n"
+              << "  --eval-threads N  evaluation worker threads (default: all cores)\n"
+              << "  --listen PORT     also accept remote app_actor processes on PORT\n"
+              << "  --wire-int8       send remote actors int8-quantized snapshots\n";
+}
+
+bool parse_options(int argc, char** argv, TrainOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--prioritized") {
+            options.prioritized = true;
+        } else if (arg == "--quantized") {
+            options.quantized = true;
+        } else if (arg == "--wire-int8") {
+            options.wire_int8 = true;
+        } else if (arg == "--listen" && has_value) {
+            options.listen_port = std::stoi(argv[++i]);
+        } else if (arg == "--double") {
+            options.double_dqn = true;
+        } else if (arg == "--normalize") {
+            options.normalize = true;
+        } else if (arg == "--actors" && has_value) {
+            options.actors = std::stoi(argv[++i]);
+        } else if (arg == "--envs" && has_value) {
+            options.envs_per_actor = std::stoi(argv[++i]);
+        } else if (arg == "--steps" && has_value) {
+            options.total_steps = std::stoll(argv[++i]);
+        } else if (arg == "--n-step" && has_value) {
+            options.n_step = std::stoi(argv[++i]);
+        } else if (arg == "--batch" && has_value) {
+            options.batch_size = std::stoull(argv[++i]);
+        } else if (arg == "--learner-threads" && has_value) {
+            options.learner_threads = std::stoi(argv[++i]);
+        } else if (arg == "--replay" && has_value) {
+            options.replay_size = std::stoull(argv[++i]);
+        } else if (arg == "--replay-dir" && has_value) {
+            options.replay_directory = argv[++i];
+        } else if (arg == "--tau" && has_value) {
+            options.tau = std::stof(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--out" && has_value) {
+            options.checkpoint_path = argv[++i];
+        } else if (arg == "--telemetry" && has_value) {
+            options.telemetry_path = argv[++i];
+        } else if (arg == "--eval-every" && has_value) {
+            options.eval_every = std::stoi(argv[++i]);
+        } else if (arg == "--eval-episodes" && has_value) {
+            options.eval_episodes = std::stoull(argv[++i]);
+        } else if (arg == "--eval-threads" && has_value) {
+            options.eval_threads = std::stoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    // With --listen the learner may run without local actors
+    bool has_actors = options.actors > 0 || (options.actors == 0 && options.listen_port >= 0);
+    return has_actors && options.listen_port <= 65535 && options.envs_per_actor > 0 &&
+           options.total_steps > 0 && options.n_step > 0 && options.eval_every >= 0 &&
+           options.eval_episodes > 0 && options.eval_threads >= 0 && options.learner_threads > 0 &&
+           options.batch_size > 0 && options.tau >= 0.0f && options.tau <= 1.0f &&
+           (options.replay_directory.empty() || !options.prioritized);
+}
+
+// Actor thread: steps its own batch of environments with a local policy copy and streams
+// every transition to the learner through its SPSC queue
+void run_actor(int id,
+               const TrainOptions& options,
+               const rl_dqn::DQNConfig& config,
+               const rl_dqn::PolicySnapshot& snapshot,
+               core::SpscQueue<rl_dqn::Experience>& queue,
+               ActorStats& stats,
+               SharedState& shared) {
+    const std::size_t num_envs = static_cast<std::size_t>(options.envs_per_actor);
+
+    rl_dqn::Policy policy(config, options.seed + 1000 + static_cast<std::uint64_t>(id));
+    std::uint64_t version = snapshot.read(policy);
+
+    // Disjoint episode seed streams per actor (see FlappyVecEnv::episode_seed)
+    env_flappy::FlappyVecEnv envs(num_envs, options.seed + (static_cast<std::uint64_t>(id) << 32));
+    std::vector<env_flappy::Observation> observations(num_envs);
+    std::vector<env_flappy::Observation> previous(num_envs);
+    std::vector<env_flappy::Action> actions(num_envs);
+    std::vector<float> rewards(num_envs);
+    std::vector<std::uint8_t> dones(num_envs);
+    envs.observe(observations);
+
+    // One n-step window per environment, so returns never span two envs
+    std::vector<rl_dqn::NStepAccumulator> accumulators(
+        num_envs, rl_dqn::NStepAccumulator(config.n_step, config.gamma));
+    std::vector<rl_dqn::Experience> folded;
+    std::vector<double> episode_returns(num_envs, 0.0);
+
+    while (!shared.stop.load(std::memory_order_relaxed)) {
+        if (snapshot.version() != version) {
+            version = snapshot.read(policy);
+        }
+
+        long long step = shared.env_steps.fetch_add(static_cast<long long>(num_envs),
+                                                     std::memory_order_relaxed);
+        float epsilon = rl_dqn::linear_epsilon(config, step);
+        policy.select_actions(observations, epsilon, actions);
+
+        previous = observations;
+        envs.step(actions, observations, rewards, dones);
+
+        for (std::size_t i = 0; i < num_envs; ++i) {
+            // For finished envs observations[i] already belongs to the next episode; the
+            // learner ignores next_state on terminal transitions
+            rl_dqn::Experience exp{previous[i], actions[i], rewards[i], observations[i],
+                                   dones[i] != 0};
+            folded.clear();
+            accumulators[i].push(exp, folded);
+            for (const rl_dqn::Experience& transition : folded) {
+                while (!queue.try_push(transition)) {
+                    if (shared.stop.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+            if (rewards[i] > 0.0f) {
+                stats.pipes_passed.fetch_add(1, std::memory_order_relaxed);
+            }
+            episode_returns[i] += rewards[i];
+            if (dones[i]) {
+                // Single writer: publish the sum before the episode count that covers it
+                stats.return_sum.store(stats.return_sum.load(std::memory_order_relaxed) +
+                                           episode_returns[i],
+                                       std::memory_order_relaxed);
+                stats.episodes.fetch_add(1, std::memory_order_release);
+                episode_returns[i] = 0.0;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
     std::cout << "FlappyRL - Training Application" << std::endl;
     core::init();
     rl_dqn::init();
-    
-    // Example: create and test environment
-    env_flappy::FlappyEnv env(12345);
-    env_flappy::Observation obs = env.reset(12345);
-    std::cout << "Environment initialized. Initial y: " << obs.y << std::endl;
-    
-    // TODO: Implement DQN training loop here
-    std::cout << "Training loop not yet implemented." << std::endl;
-    
+
+    TrainOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    rl_dqn::DQNConfig config;
+    config.seed = options.seed;
+    config.prioritized_replay = options.prioritized;
+    config.quantized_policy = options.quantized;
+    config.target_tau = options.tau;
+    config.n_step = options.n_step;
+    config.double_dqn = options.double_dqn;
+    config.normalize_observations = options.normalize;
+    config.batch_size = options.batch_size;
+    config.learner_threads = options.learner_threads;
+    if (options.replay_size > 0) {
+        config.replay_buffer_size = options.replay_size;
+    }
+    config.replay_directory = options.replay_directory;
+
+    // Learner runs on the main thread, on the compile-time specialized default topology
+    rl_dqn::FixedDQNLearner learner(config);
+    rl_dqn::PolicySnapshot snapshot(learner.policy_parameters().size());
+    snapshot.publish(learner.policy_parameters());
+
+    std::cout << "Actors: " << options.actors << " x " << options.envs_per_actor
+              << " envs, total steps: " << options.total_steps
+              << (options.prioritized ? ", prioritized replay" : "")
+              << (options.quantized ? ", int8 actors" : "")
+              << (options.double_dqn ? ", double DQN" : "")
+              << (options.normalize ? ", normalized observations" : "")
+              << (options.n_step > 1 ? ", " + std::to_string(options.n_step) + "-step" : "")
+              << (options.learner_threads > 1
+                      ? ", " + std::to_string(options.learner_threads) + " learner threads"
+                      : "")
+              << std::endl;
+    if (!config.replay_directory.empty()) {
+        std::cout << "Replay: " << config.replay_directory << ", resumed with "
+                  << learner.replay_buffer().size() << " transitions" << std::endl;
+    }
+
+    // Remote actors get ids after the local ones, so every actor has its own seed stream
+    std::unique_ptr<rl_dqn::ActorServer> server;
+    if (options.listen_port >= 0) {
+        rl_dqn::wire::ActorConfig remote;
+        remote.seed = options.seed;
+        remote.n_step = config.n_step;
+        remote.gamma = config.gamma;
+        remote.quantized_policy = config.quantized_policy;
+        remote.encoding = options.wire_int8 ? rl_dqn::wire::SnapshotEncoding::kInt8
+                                            : rl_dqn::wire::SnapshotEncoding::kFloat32;
+        remote.layer_sizes = config.layer_sizes;
+        try {
+            server = std::make_unique<rl_dqn::ActorServer>(
+                static_cast<std::uint16_t>(options.listen_port), remote,
+                static_cast<std::uint32_t>(options.actors), options.queue_capacity);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        server->broadcast(learner.policy_parameters(), config.epsilon_start);
+        std::cout << "Listening for remote actors on port " << server->port()
+                  << (options.wire_int8 ? " (int8 snapshots)" : "") << std::endl;
+    }
+
+    SharedState shared;
+    std::vector<std::unique_ptr<core::SpscQueue<rl_dqn::Experience>>> queues;
+    std::vector<ActorStats> stats(static_cast<std::size_t>(options.actors));
+    std::vector<std::thread> actors;
+    for (int a = 0; a < options.actors; ++a) {
+        queues.push_back(
+            std::make_unique<core::SpscQueue<rl_dqn::Experience>>(options.queue_capacity));
+    }
+    for (int a = 0; a < options.actors; ++a) {
+        actors.emplace_back(run_actor, a, std::cref(options), std::cref(config),
+                            std::cref(snapshot), std::ref(*queues[a]), std::ref(stats[a]),
+                            std::ref(shared));
+    }
+
+    std::unique_ptr<core::telemetry::TrainingLog> telemetry_log;
+    if (!options.telemetry_path.empty()) {
+        telemetry_log = std::make_unique<core::telemetry::TrainingLog>(options.telemetry_path);
+    }
+    core::telemetry::Snapshot logged_probes = core::telemetry::snapshot();
+    double logged_seconds = 0.0;
+    long long logged_stored = 0;
+    int logged_train_steps = 0;
+    double logged_return = 0.0;
+
+    // Periodic greedy evaluation on a work-stealing pool, seeded like app_eval's defaults so
+    // the numbers are comparable
+    std::unique_ptr<core::ThreadPool> eval_pool;
+    rl_dqn::EvalConfig eval_config;
+    eval_config.episodes = options.eval_episodes;
+    if (options.eval_every > 0) {
+        eval_pool = std::make_unique<core::ThreadPool>(static_cast<std::size_t>(
+            options.eval_threads));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<rl_dqn::Experience> inbox(1024);
+    long long stored = 0;
+    long long next_log = options.log_interval;
+    std::uint64_t logged_episodes = 0;
+    std::uint64_t logged_pipes = 0;
+    float loss = 0.0f;
+
+    while (stored < options.total_steps) {
+        // Keep the single-threaded replay ratio: one gradient step per train_frequency
+        // transitions, however many actors are producing them. While the learner is behind
+        // it stops draining, the queues fill up and the actors wait.
+        bool behind = learner.training_steps() < stored / config.train_frequency;
+        if (behind && learner.replay_buffer().can_sample(config.batch_size)) {
+            loss = learner.train();
+            int steps = learner.training_steps();
+            if (config.target_tau <= 0.0f && steps % config.target_update_frequency == 0) {
+                learner.update_target_network();
+            }
+            if (steps % options.publish_interval == 0) {
+                std::span<const float> policy = learner.policy_parameters();
+                snapshot.publish(policy);
+                if (server) {
+                    server->broadcast(policy,
+                                      rl_dqn::linear_epsilon(config, shared.env_steps.load()));
+                }
+            }
+            if (eval_pool && steps % options.eval_every == 0) {
+                rl_dqn::EvalSummary eval = rl_dqn::summarize(
+                    rl_dqn::evaluate_policy(learner.network(), eval_config, *eval_pool));
+                std::cout << std::fixed << std::setprecision(3) << "eval  train " << steps
+                          << "  score " << eval.mean_score << "  p50 "
+                          << eval.score_percentiles[2] << "  pipes " << eval.mean_pipes
+                          << "  truncated " << eval.truncated << "/" << eval.episodes
+                          << std::endl;
+            }
+        } else {
+            std::size_t drained = 0;
+            for (auto& queue : queues) {
+                std::size_t count = queue->try_pop(inbox.data(), inbox.size());
+                for (std::size_t k = 0; k < count; ++k) {
+                    learner.store(inbox[k]);
+                }
+                drained += count;
+            }
+            if (server) {
+                // Remote transitions advance the shared step count that drives epsilon
+                std::size_t count = server->poll(inbox.data(), inbox.size());
+                for (std::size_t k = 0; k < count; ++k) {
+                    learner.store(inbox[k]);
+                }
+                shared.env_steps.fetch_add(static_cast<long long>(count),
+                                           std::memory_order_relaxed);
+                drained += count;
+            }
+            stored += static_cast<long long>(drained);
+            if (drained == 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (stored >= next_log) {
+            next_log += options.log_interval;
+
+            std::uint64_t episodes = 0;
+            std::uint64_t pipes = 0;
+            double returns = 0.0;
+            for (const ActorStats& s : stats) {
+                episodes += s.episodes.load(std::memory_order_acquire);
+                pipes += s.pipes_passed.load(std::memory_order_relaxed);
+                returns += s.return_sum.load(std::memory_order_relaxed);
+            }
+            if (server) {
+                rl_dqn::wire::EpisodeStats remote = server->stats();
+                episodes += remote.episodes;
+                pipes += remote.pipes;
+                returns += remote.return_sum;
+            }
+            std::uint64_t window_episodes = episodes - logged_episodes;
+            double pipes_per_episode =
+                window_episodes > 0 ? static_cast<double>(pipes - logged_pipes) / window_episodes
+                                    : 0.0;
+            double mean_return =
+                window_episodes > 0 ? (returns - logged_return) / window_episodes : 0.0;
+            logged_episodes = episodes;
+            logged_pipes = pipes;
+            logged_return = returns;
+
+            double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start).count();
+            const int train_steps = learner.training_steps();
+            if (telemetry_log) {
+                double window = std::max(seconds - logged_seconds, 1e-9);
+                core::telemetry::Snapshot probes = core::telemetry::snapshot();
+                const core::telemetry::Metric metrics[] = {
+                    {"time_s", seconds},
+                    {"env_steps", static_cast<double>(stored)},
+                    {"steps_per_sec", (stored - logged_stored) / window},
+                    {"train_steps", static_cast<double>(train_steps)},
+                    {"train_steps_per_sec", (train_steps - logged_train_steps) / window},
+                    {"loss", loss},
+                    {"epsilon", rl_dqn::linear_epsilon(config, stored)},
+                    {"episodes", static_cast<double>(episodes)},
+                    {"episode_return", mean_return},
+                    {"pipes_per_episode", pipes_per_episode},
+                };
+                telemetry_log->write(metrics, probes - logged_probes);
+                logged_probes = probes;
+            }
+            logged_seconds = seconds;
+            logged_stored = stored;
+            logged_train_steps = train_steps;
+
+            std::cout << std::fixed << std::setprecision(3)
+                      << "steps " << stored
+                      << "  train " << learner.training_steps()
+                      << "  episodes " << episodes
+                      << "  pipes/ep " << pipes_per_episode
+                      << "  loss " << loss
+                      << "  eps " << rl_dqn::linear_epsilon(config, stored)
+                      << "  steps/s " << std::setprecision(0) << stored / seconds
+                      << (server ? "  remote " + std::to_string(server->num_connections()) : "")
+                      << std::endl;
+        }
+    }
+
+    shared.stop.store(true);
+    for (std::thread& actor : actors) {
+        actor.join();
+    }
+    server.reset();  // disconnects remote actors, which then exit
+
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Done: " << stored << " steps, " << learner.training_steps()
+              << " training steps in " << std::setprecision(1) << seconds << " s" << std::endl;
+
+    // Where the time went, summed over the learner and all actor threads
+    if (core::telemetry::kEnabled) {
+        core::telemetry::Snapshot probes = core::telemetry::snapshot();
+        for (std::size_t p = 0; p < core::telemetry::kNumProbes; ++p) {
+            const core::telemetry::ProbeTotals& t = probes.probes[p];
+            if (t.calls == 0) {
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(14)
+                      << core::telemetry::probe_name(static_cast<core::telemetry::Probe>(p))
+                      << std::right << std::setprecision(1) << std::setw(10)
+                      << t.nanoseconds * 1e-6 << " ms  " << std::setw(10) << t.calls
+                      << " calls  " << std::setprecision(0) << std::setw(8)
+                      << static_cast<double>(t.nanoseconds) / t.calls << " ns/call" << std::endl;
+        }
+    }
+
+    if (!options.checkpoint_path.empty()) {
+        rl_dqn::CheckpointContents contents = learner.checkpoint_contents(true);
+        contents.env_steps = shared.env_steps.load();
+        rl_dqn::write_checkpoint(options.checkpoint_path, contents);
+        std::cout << "Checkpoint written to " << options.checkpoint_path << std::endl;
+    }
     return 0;
 }
-
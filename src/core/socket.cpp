@@ -0,0 +1,254 @@
+#include "core/socket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace core {
+
+namespace {
+
+#ifdef _WIN32
+
+using NativeSocket = SOCKET;
+
+// Winsock must be started once per process before any other call
+void ensure_started() {
+    static const bool started = [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            throw std::runtime_error("WSAStartup failed");
+        }
+        return true;
+    }();
+    (void)started;
+}
+
+std::string last_error() { return "error " + std::to_string(WSAGetLastError()); }
+
+void close_native(NativeSocket s) { closesocket(s); }
+
+#else
+
+using NativeSocket = int;
+
+void ensure_started() {}
+
+std::string last_error() { return std::strerror(errno); }
+
+bool interrupted() { return errno == EINTR; }
+
+void close_native(NativeSocket s) { ::close(s); }
+
+#endif
+
+NativeSocket native(std::intptr_t handle) { return static_cast<NativeSocket>(handle); }
+
+std::intptr_t wrap(NativeSocket s) { return static_cast<std::intptr_t>(s); }
+
+} // namespace
+
+TcpSocket TcpSocket::connect(const std::string& host, std::uint16_t port) {
+    ensure_started();
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0 ||
+        addresses == nullptr) {
+        throw std::runtime_error("Cannot resolve " + host);
+    }
+
+    // First address that accepts the connection wins
+    std::string error = "no address";
+    for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+        NativeSocket s = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (wrap(s) == kInvalid) {
+            error = last_error();
+            continue;
+        }
+        if (::connect(s, a->ai_addr, static_cast<int>(a->ai_addrlen)) == 0) {
+            freeaddrinfo(addresses);
+            return TcpSocket(wrap(s));
+        }
+        error = last_error();
+        close_native(s);
+    }
+    freeaddrinfo(addresses);
+    throw std::runtime_error("Cannot connect to " + host + ":" + service + ": " + error);
+}
+
+TcpSocket::TcpSocket(TcpSocket&& other) noexcept
+    : handle_(std::exchange(other.handle_, kInvalid)) {}
+
+TcpSocket& TcpSocket::operator=(TcpSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        handle_ = std::exchange(other.handle_, kInvalid);
+    }
+    return *this;
+}
+
+TcpSocket::~TcpSocket() { close(); }
+
+void TcpSocket::close() noexcept {
+    if (handle_ != kInvalid) {
+        close_native(native(handle_));
+        handle_ = kInvalid;
+    }
+}
+
+void TcpSocket::send_all(std::span<const std::byte> data) {
+    const char* bytes = reinterpret_cast<const char*>(data.data());
+    std::size_t left = data.size();
+    while (left > 0) {
+#ifdef _WIN32
+        int chunk = static_cast<int>(std::min<std::size_t>(left, 1 << 30));
+        int sent = ::send(native(handle_), bytes, chunk, 0);
+#else
+        // MSG_NOSIGNAL: a peer that went away is an error here, not SIGPIPE
+        ssize_t sent = ::send(native(handle_), bytes, left, MSG_NOSIGNAL);
+        if (sent < 0 && interrupted()) {
+            continue;
+        }
+#endif
+        if (sent <= 0) {
+            throw std::runtime_error("Socket send failed: " + last_error());
+        }
+        bytes += sent;
+        left -= static_cast<std::size_t>(sent);
+    }
+}
+
+bool TcpSocket::recv_all(std::span<std::byte> data) {
+    char* bytes = reinterpret_cast<char*>(data.data());
+    std::size_t received = 0;
+    while (received < data.size()) {
+        std::size_t left = data.size() - received;
+#ifdef _WIN32
+        int chunk = static_cast<int>(std::min<std::size_t>(left, 1 << 30));
+        int got = ::recv(native(handle_), bytes + received, chunk, 0);
+#else
+        ssize_t got = ::recv(native(handle_), bytes + received, left, 0);
+        if (got < 0 && interrupted()) {
+            continue;
+        }
+#endif
+        if (got == 0) {
+            if (received == 0) {
+                return false;
+            }
+            throw std::runtime_error("Connection closed mid-message");
+        }
+        if (got < 0) {
+            throw std::runtime_error("Socket receive failed: " + last_error());
+        }
+        received += static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+void TcpSocket::set_no_delay(bool enabled) {
+    int flag = enabled ? 1 : 0;
+    setsockopt(native(handle_), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag),
+               sizeof(flag));
+}
+
+void TcpSocket::shutdown() noexcept {
+    if (handle_ != kInvalid) {
+#ifdef _WIN32
+        ::shutdown(native(handle_), SD_BOTH);
+#else
+        ::shutdown(native(handle_), SHUT_RDWR);
+#endif
+    }
+}
+
+TcpListener::TcpListener(std::uint16_t port) {
+    ensure_started();
+    NativeSocket s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (wrap(s) == TcpSocket::kInvalid) {
+        throw std::runtime_error("Cannot create socket: " + last_error());
+    }
+#ifndef _WIN32
+    // Restarted learners can rebind while old connections sit in TIME_WAIT
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(s, SOMAXCONN) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::string error = last_error();
+        close_native(s);
+        throw std::runtime_error("Cannot listen on port " + std::to_string(port) + ": " + error);
+    }
+    handle_.store(wrap(s));
+    port_ = ntohs(address.sin_port);
+}
+
+TcpListener::~TcpListener() {
+    shutdown();
+    std::intptr_t handle = handle_.exchange(TcpSocket::kInvalid);
+    if (handle != TcpSocket::kInvalid) {
+        close_native(native(handle));
+    }
+}
+
+TcpSocket TcpListener::accept() {
+    while (true) {
+        std::intptr_t handle = handle_.load();
+        if (handle == TcpSocket::kInvalid) {
+            return TcpSocket();
+        }
+        NativeSocket s = ::accept(native(handle), nullptr, nullptr);
+        if (wrap(s) != TcpSocket::kInvalid) {
+            return TcpSocket(wrap(s));
+        }
+#ifndef _WIN32
+        if (interrupted()) {
+            continue;
+        }
+#endif
+        return TcpSocket();
+    }
+}
+
+void TcpListener::shutdown() noexcept {
+#ifdef _WIN32
+    // Winsock only wakes accept() by closing the socket
+    std::intptr_t handle = handle_.exchange(TcpSocket::kInvalid);
+    if (handle != TcpSocket::kInvalid) {
+        close_native(native(handle));
+    }
+#else
+    std::intptr_t handle = handle_.load();
+    if (handle != TcpSocket::kInvalid) {
+        ::shutdown(native(handle), SHUT_RDWR);
+    }
+#endif
+}
+
+} // namespace core
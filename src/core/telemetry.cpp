@@ -0,0 +1,157 @@
+#include "core/telemetry.h"
+#include "core/aligned.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace core::telemetry {
+
+namespace {
+
+// One writer thread per slot: plain relaxed load/store pairs instead of read-modify-writes
+struct alignas(kCacheLineSize) ThreadSlot {
+    std::array<std::atomic<std::uint64_t>, kNumProbes> calls{};
+    std::array<std::atomic<std::uint64_t>, kNumProbes> items{};
+    std::array<std::atomic<std::uint64_t>, kNumProbes> nanoseconds{};
+};
+
+// Slots are never freed, so snapshot() may read the totals of threads that already exited
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadSlot>> slots;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry;  // leaked: threads may record during exit
+    return *instance;
+}
+
+ThreadSlot& thread_slot() {
+    thread_local ThreadSlot* slot = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.slots.push_back(std::make_unique<ThreadSlot>());
+        return r.slots.back().get();
+    }();
+    return *slot;
+}
+
+void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Nine significant digits: losses can be far below to_string()'s six decimals. JSON has no
+// nan/inf, so a diverged loss is written as null there.
+std::string format_value(double value, bool json) {
+    if (json && !std::isfinite(value)) {
+        return "null";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+void append_quoted(std::string& out, const char* text) {
+    out += '"';
+    out += text;
+    out += '"';
+}
+
+} // namespace
+
+const char* probe_name(Probe probe) {
+    switch (probe) {
+        case Probe::kEnvStep: return "env_step";
+        case Probe::kActionSelect: return "action_select";
+        case Probe::kReplaySample: return "replay_sample";
+        case Probe::kForward: return "forward";
+        case Probe::kBackward: return "backward";
+        case Probe::kOptimizer: return "optimizer";
+        case Probe::kTargetSync: return "target_sync";
+        case Probe::kCount: break;
+    }
+    return "unknown";
+}
+
+Snapshot Snapshot::operator-(const Snapshot& earlier) const {
+    Snapshot delta;
+    for (std::size_t p = 0; p < kNumProbes; ++p) {
+        delta.probes[p].calls = probes[p].calls - earlier.probes[p].calls;
+        delta.probes[p].items = probes[p].items - earlier.probes[p].items;
+        delta.probes[p].nanoseconds = probes[p].nanoseconds - earlier.probes[p].nanoseconds;
+    }
+    return delta;
+}
+
+void record(Probe probe, std::uint64_t nanoseconds, std::uint64_t items) {
+    ThreadSlot& slot = thread_slot();
+    const std::size_t p = static_cast<std::size_t>(probe);
+    add(slot.calls[p], 1);
+    add(slot.items[p], items);
+    add(slot.nanoseconds[p], nanoseconds);
+}
+
+Snapshot snapshot() {
+    Snapshot totals;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& slot : r.slots) {
+        for (std::size_t p = 0; p < kNumProbes; ++p) {
+            totals.probes[p].calls += slot->calls[p].load(std::memory_order_relaxed);
+            totals.probes[p].items += slot->items[p].load(std::memory_order_relaxed);
+            totals.probes[p].nanoseconds += slot->nanoseconds[p].load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+TrainingLog::TrainingLog(const std::string& path)
+    : out_(path), json_(path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) {
+    if (!out_) {
+        throw std::runtime_error("Cannot open training log: " + path);
+    }
+}
+
+void TrainingLog::write(std::span<const Metric> metrics, const Snapshot& probes) {
+    // Column names: the metrics, then two per probe
+    std::vector<std::string> names;
+    std::vector<double> values;
+    for (const Metric& m : metrics) {
+        names.emplace_back(m.name);
+        values.push_back(m.value);
+    }
+    for (std::size_t p = 0; p < kNumProbes; ++p) {
+        std::string name = probe_name(static_cast<Probe>(p));
+        names.push_back(name + "_ms");
+        values.push_back(static_cast<double>(probes.probes[p].nanoseconds) * 1e-6);
+        names.push_back(name + "_calls");
+        values.push_back(static_cast<double>(probes.probes[p].calls));
+    }
+
+    std::string line;
+    if (json_) {
+        line += '{';
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            append_quoted(line, names[i].c_str());
+            line += ':' + format_value(values[i], true) + (i + 1 < names.size() ? "," : "");
+        }
+        line += '}';
+    } else {
+        if (!header_written_) {
+            for (std::size_t i = 0; i < names.size(); ++i) {
+                out_ << names[i] << (i + 1 < names.size() ? "," : "\n");
+            }
+            header_written_ = true;
+        }
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            line += format_value(values[i], false) + (i + 1 < values.size() ? "," : "");
+        }
+    }
+    // Flushed per row so a crashed or interrupted run still leaves a plottable log
+    out_ << line << std::endl;
+}
+
+} // namespace core::telemetry
@@ -0,0 +1,205 @@
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr std::uint64_t pack(std::uint64_t begin, std::uint64_t end) { return begin << 32 | end; }
+constexpr std::uint64_t range_begin(std::uint64_t range) { return range >> 32; }
+constexpr std::uint64_t range_end(std::uint64_t range) { return range & 0xffffffffu; }
+
+// Pools whose loop bodies this thread is running, innermost first, to reject nested
+// parallel_for calls on any of them (loops on other pools may nest)
+struct LoopFrame {
+    const ThreadPool* pool;
+    const LoopFrame* outer;
+};
+thread_local const LoopFrame* active_loops = nullptr;
+
+bool in_loop_of(const ThreadPool* pool) {
+    for (const LoopFrame* frame = active_loops; frame != nullptr; frame = frame->outer) {
+        if (frame->pool == pool) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads)
+    : slices_(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+    for (std::size_t w = 1; w < slices_.size(); ++w) {
+        threads_.emplace_back(&ThreadPool::worker_main, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(std::size_t count, Invoke invoke, void* context) {
+    if (in_loop_of(this)) {
+        throw std::logic_error("ThreadPool::parallel_for cannot be nested");
+    }
+    if (count >= (std::uint64_t{1} << 32)) {
+        throw std::invalid_argument("ThreadPool::parallel_for count must fit in 32 bits");
+    }
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    const std::size_t workers = slices_.size();
+    for (std::size_t w = 0; w < workers; ++w) {
+        slices_[w].range.store(pack(count * w / workers, count * (w + 1) / workers),
+                               std::memory_order_relaxed);
+    }
+    remaining_.store(count, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    error_ = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        invoke_ = invoke;
+        context_ = context;
+        active_ = threads_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    work(0);
+
+    // Helpers may still be between their last index and leaving the loop
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void ThreadPool::worker_main(std::size_t worker) {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if (--active_ == 0) {
+            done_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::work(std::size_t worker) {
+    const LoopFrame frame{this, active_loops};
+    active_loops = &frame;
+    while (remaining_.load(std::memory_order_acquire) > 0) {
+        std::size_t index;
+        if (!pop_own(worker, index) && !steal(worker, index)) {
+            // Everything left is already running elsewhere
+            std::this_thread::yield();
+            continue;
+        }
+        if (!failed_.load(std::memory_order_relaxed)) {
+            try {
+                invoke_(context_, index, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    active_loops = frame.outer;
+}
+
+bool ThreadPool::pop_own(std::size_t worker, std::size_t& index) {
+    std::atomic<std::uint64_t>& range = slices_[worker].range;
+    std::uint64_t current = range.load(std::memory_order_acquire);
+    while (range_begin(current) < range_end(current)) {
+        std::uint64_t begin = range_begin(current);
+        if (range.compare_exchange_weak(current, pack(begin + 1, range_end(current)),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+            index = static_cast<std::size_t>(begin);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::steal(std::size_t worker, std::size_t& index) {
+    const std::size_t workers = slices_.size();
+    for (std::size_t k = 1; k < workers; ++k) {
+        std::atomic<std::uint64_t>& victim = slices_[(worker + k) % workers].range;
+        std::uint64_t current = victim.load(std::memory_order_acquire);
+        while (range_begin(current) < range_end(current)) {
+            std::uint64_t begin = range_begin(current);
+            std::uint64_t end = range_end(current);
+            // Leave the victim the front half (rounded up) and take the back half
+            std::uint64_t mid = begin + (end - begin + 1) / 2;
+            if (mid == end) {
+                mid = begin;  // a single index: take it outright
+            }
+            std::uint64_t left = mid == begin ? pack(begin + 1, end) : pack(begin, mid);
+            if (victim.compare_exchange_weak(current, left, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                index = static_cast<std::size_t>(mid);
+                if (mid != begin && mid + 1 < end) {
+                    // Our own slice is empty, so nobody else writes it until this store
+                    slices_[worker].range.store(pack(mid + 1, end), std::memory_order_release);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool pin_current_thread(std::size_t cpu) {
+    const std::size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu %= cpus;
+#ifdef _WIN32
+    if (cpu >= 64) {
+        return false;   // beyond the first processor group
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace core
@@ -0,0 +1,107 @@
+#include "env_flappy/recording.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace env_flappy {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'L', 'P', 'Y', 'R', 'C', 'R', 'D'};
+
+static_assert(std::is_trivially_copyable_v<Config>, "Config is stored as raw bytes");
+
+struct EpisodeHeader {
+    std::uint64_t seed;
+    std::uint32_t length;
+    std::uint32_t reserved;
+};
+
+std::size_t num_words(std::uint32_t length) {
+    return (static_cast<std::size_t>(length) + 63) / 64;
+}
+
+template <class T>
+void write_raw(std::ofstream& out, const T* values, std::size_t count) {
+    out.write(reinterpret_cast<const char*>(values),
+              static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+template <class T>
+void read_raw(std::ifstream& in, T* values, std::size_t count, const std::string& path) {
+    in.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+    if (!in) {
+        throw std::runtime_error("Truncated recording: " + path);
+    }
+}
+
+} // namespace
+
+void write_recording(const std::string& path, const Config& config,
+                     std::span<const EpisodeRecording> episodes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    RecordingHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kRecordingVersion;
+    header.config_bytes = sizeof(Config);
+    header.num_episodes = episodes.size();
+    write_raw(out, &header, 1);
+    write_raw(out, &config, 1);
+    for (const EpisodeRecording& episode : episodes) {
+        if (episode.action_bits.size() != num_words(episode.length)) {
+            throw std::invalid_argument("Episode recording length does not match its actions");
+        }
+        EpisodeHeader entry{episode.seed, episode.length, 0};
+        write_raw(out, &entry, 1);
+        write_raw(out, episode.action_bits.data(), episode.action_bits.size());
+    }
+    if (!out) {
+        throw std::runtime_error("Write failed: " + path);
+    }
+}
+
+Recording read_recording(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    const auto file_bytes = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(0);
+    RecordingHeader header;
+    read_raw(in, &header, 1, path);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a recording (bad magic): " + path);
+    }
+    if (header.version != kRecordingVersion || header.config_bytes != sizeof(Config)) {
+        throw std::runtime_error("Unsupported recording version: " + path);
+    }
+
+    Recording recording;
+    read_raw(in, &recording.config, 1, path);
+    try {
+        FlappyEnv::validate_config(recording.config);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+    for (std::uint64_t i = 0; i < header.num_episodes; ++i) {
+        EpisodeHeader entry;
+        read_raw(in, &entry, 1, path);
+        const std::uint64_t remaining = file_bytes - static_cast<std::uint64_t>(in.tellg());
+        if (num_words(entry.length) > remaining / sizeof(std::uint64_t)) {
+            throw std::runtime_error("Truncated recording: " + path);
+        }
+        EpisodeRecording& episode = recording.episodes.emplace_back();
+        episode.seed = entry.seed;
+        episode.length = entry.length;
+        episode.action_bits.resize(num_words(entry.length));
+        read_raw(in, episode.action_bits.data(), episode.action_bits.size(), path);
+    }
+    return recording;
+}
+
+} // namespace env_flappy
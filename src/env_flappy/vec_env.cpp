@@ -0,0 +1,227 @@
+#include "env_flappy/vec_env.h"
+#include "core/telemetry.h"
+#include <stdexcept>
+
+namespace env_flappy {
+
+FlappyVecEnv::FlappyVecEnv(std::size_t num_envs, std::uint64_t seed, const Config& config)
+    : config_(config), num_envs_(num_envs) {
+    if (num_envs == 0) {
+        throw std::invalid_argument("FlappyVecEnv needs at least one environment");
+    }
+    FlappyEnv::validate_config(config);
+
+    y_.resize(num_envs);
+    vy_.resize(num_envs);
+    scroll_.resize(num_envs);
+    steps_.resize(num_envs);
+    passed_flag_.resize(num_envs);
+    pipe_x_.resize(num_envs * kMaxPipes);
+    pipe_gap_y_.resize(num_envs * kMaxPipes);
+    pipe_head_.resize(num_envs);
+    pipe_count_.resize(num_envs);
+    current_pipe_.resize(num_envs);
+    rngs_.resize(num_envs);
+    episode_seeds_.resize(num_envs);
+
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        reset_env(i, seed + i);
+    }
+}
+
+// Helper: Append a pipe at on-screen x with a freshly sampled gap center to env i's ring;
+// returns its on-screen x
+float FlappyVecEnv::add_pipe(std::size_t i, float x) {
+    std::size_t slot = pipe_slot(i, pipe_count_[i]);
+    pipe_x_[slot] = x + scroll_[i];
+    pipe_gap_y_[slot] = PipeRules::gap_center(config_, rngs_[i].uniform());
+    ++pipe_count_[i];
+    return screen_x(i, pipe_count_[i] - 1);
+}
+
+void FlappyVecEnv::reset_env(std::size_t i, std::uint64_t seed) {
+    // Same sequence as FlappyEnv::reset(seed)
+    rngs_[i].seed(seed);
+    episode_seeds_[i] = seed;
+
+    y_[i] = 0.5f * config_.world_height;
+    vy_[i] = 0.0f;
+    scroll_[i] = 0.0f;
+    steps_[i] = 0;
+    passed_flag_[i] = 0;
+    pipe_head_[i] = 0;
+    pipe_count_[i] = 0;
+    current_pipe_[i] = 0;
+
+    PipeRules::refill(config_, add_pipe(i, FlappyEnv::kFirstPipeX),
+                      [this, i](float x) { return add_pipe(i, x); });
+}
+
+void FlappyVecEnv::reset(std::uint64_t seed, std::span<Observation> observations) {
+    if (observations.size() != num_envs_) {
+        throw std::invalid_argument("Observation buffer size mismatch");
+    }
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        reset_env(i, seed + i);
+        observations[i] = compute_observation(i);
+    }
+}
+
+void FlappyVecEnv::reset(std::uint64_t seed, std::span<float> observations) {
+    if (observations.size() != num_envs_ * kObservationSize) {
+        throw std::invalid_argument("Observation matrix size mismatch");
+    }
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        reset_env(i, seed + i);
+    }
+    observe(observations);
+}
+
+// Helper: Retire off-screen pipes, move the current pipe forward and spawn pipes ahead
+void FlappyVecEnv::advance_pipes(std::size_t i) {
+    // Remove pipes that are fully off-screen on the left
+    std::size_t removed = 0;
+    while (pipe_count_[i] > 0 && PipeRules::off_screen(config_, screen_x(i, 0))) {
+        pipe_head_[i] = static_cast<std::uint8_t>((pipe_head_[i] + 1) % kMaxPipes);
+        --pipe_count_[i];
+        ++removed;
+    }
+    if (removed > 0) {
+        // Rebase exactly like FlappyEnv so both stay bit-identical
+        for (std::size_t k = 0; k < pipe_count_[i]; ++k) {
+            pipe_x_[pipe_slot(i, k)] -= scroll_[i];
+        }
+        scroll_[i] = 0.0f;
+    }
+    std::size_t current = current_pipe_[i] >= removed ? current_pipe_[i] - removed : 0;
+
+    // Update current pipe index (first pipe ahead of or at bird)
+    while (current < pipe_count_[i] &&
+           PipeRules::behind_bird(config_, screen_x(i, current))) {
+        passed_flag_[i] = 0;  // next pipe becomes current; re-arm pass
+        if (current + 1 < pipe_count_[i]) {
+            ++current;
+        } else {
+            break;
+        }
+    }
+    current_pipe_[i] = static_cast<std::uint8_t>(current);
+
+    // Add new pipes as needed to keep ahead
+    float furthest_x = pipe_count_[i] == 0 ? 0.0f : screen_x(i, pipe_count_[i] - 1);
+    PipeRules::refill(config_, furthest_x, [this, i](float x) { return add_pipe(i, x); });
+}
+
+bool FlappyVecEnv::check_collision(std::size_t i) const {
+    if (PipeRules::hits_bounds(config_, y_[i])) {
+        return true;
+    }
+    return current_pipe_[i] < pipe_count_[i] &&
+           PipeRules::hits_pipe(config_, y_[i], screen_x(i, current_pipe_[i]),
+                                pipe_gap_y_[pipe_slot(i, current_pipe_[i])]);
+}
+
+Observation FlappyVecEnv::compute_observation(std::size_t i) const {
+    bool has_pipe = current_pipe_[i] < pipe_count_[i];
+    return PipeRules::observation(y_[i], vy_[i], has_pipe,
+                                  has_pipe ? screen_x(i, current_pipe_[i]) : 0.0f,
+                                  has_pipe ? pipe_gap_y_[pipe_slot(i, current_pipe_[i])] : 0.0f);
+}
+
+void FlappyVecEnv::observe(std::span<Observation> observations) const {
+    if (observations.size() != num_envs_) {
+        throw std::invalid_argument("Observation buffer size mismatch");
+    }
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        observations[i] = compute_observation(i);
+    }
+}
+
+void FlappyVecEnv::observe(std::span<float> observations) const {
+    if (observations.size() != num_envs_ * kObservationSize) {
+        throw std::invalid_argument("Observation matrix size mismatch");
+    }
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        ObservationSchema::write(compute_observation(i), &observations[i * kObservationSize]);
+    }
+}
+
+void FlappyVecEnv::step(std::span<const Action> actions,
+                        std::span<Observation> observations,
+                        std::span<float> rewards,
+                        std::span<std::uint8_t> dones) {
+    if (observations.size() != num_envs_) {
+        throw std::invalid_argument("Step buffer size mismatch");
+    }
+    step_envs(actions, rewards, dones, [observations](std::size_t i, const Observation& obs) {
+        observations[i] = obs;
+    });
+}
+
+void FlappyVecEnv::step(std::span<const Action> actions,
+                        std::span<float> observations,
+                        std::span<float> rewards,
+                        std::span<std::uint8_t> dones) {
+    if (observations.size() != num_envs_ * kObservationSize) {
+        throw std::invalid_argument("Observation matrix size mismatch");
+    }
+    step_envs(actions, rewards, dones, [observations](std::size_t i, const Observation& obs) {
+        ObservationSchema::write(obs, &observations[i * kObservationSize]);
+    });
+}
+
+template <class Write>
+void FlappyVecEnv::step_envs(std::span<const Action> actions, std::span<float> rewards,
+                             std::span<std::uint8_t> dones, Write&& write) {
+    if (actions.size() != num_envs_ || rewards.size() != num_envs_ ||
+        dones.size() != num_envs_) {
+        throw std::invalid_argument("Step buffer size mismatch");
+    }
+    CORE_TELEMETRY_SCOPE_N(kEnvStep, num_envs_);
+
+    // 1) Physics and scrolling for every env in one branch-free pass over the SoA arrays
+    const float flap_impulse = config_.flap_impulse;
+    const float gravity_step = config_.gravity * config_.dt;
+    const float term_vy = config_.term_vy;
+    const float max_vy = config_.max_vy;
+    const float dt = config_.dt;
+    const float scroll_distance = config_.pipe_speed * config_.dt;
+    float* y = y_.data();
+    float* vy = vy_.data();
+    float* scroll = scroll_.data();
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        float v = vy[i] + (actions[i] == Action::FLAP ? flap_impulse : 0.0f);
+        v += gravity_step;
+        v = v < term_vy ? term_vy : v;
+        v = v > max_vy ? max_vy : v;
+        vy[i] = v;
+        y[i] += v * dt;
+        scroll[i] += scroll_distance;
+    }
+
+    // 2) Pipe lifecycle, collisions and rewards per env, then auto-reset finished envs
+    for (std::size_t i = 0; i < num_envs_; ++i) {
+        ++steps_[i];
+        advance_pipes(i);
+
+        float reward = config_.r_step;
+        bool done = check_collision(i);
+        if (done) {
+            reward = config_.r_death;
+        } else if (!passed_flag_[i] && current_pipe_[i] < pipe_count_[i] &&
+                   PipeRules::passed(screen_x(i, current_pipe_[i]))) {
+            reward += config_.r_pass;
+            passed_flag_[i] = 1;
+        }
+
+        rewards[i] = reward;
+        dones[i] = done ? 1 : 0;
+        if (done) {
+            ++episodes_completed_;
+            reset_env(i, episode_seeds_[i] + num_envs_);
+        }
+        write(i, compute_observation(i));
+    }
+}
+
+} // namespace env_flappy
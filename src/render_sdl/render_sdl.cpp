@@ -17,32 +17,55 @@ Renderer::~Renderer() {
 
 bool Renderer::initialize(const RenderConfig& config) {
 #ifdef HAVE_SDL2
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    // The software renderer draws into plain memory and needs no video subsystem
+    if (SDL_Init(config.offscreen ? 0 : SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL2 initialization failed: " << SDL_GetError() << std::endl;
         return false;
     }
 
-    window_ = SDL_CreateWindow(
-        "FlappyRL",
-        SDL_WINDOWPOS_UNDEFINED,
-        SDL_WINDOWPOS_UNDEFINED,
-        config.window_width,
-        config.window_height,
-        SDL_WINDOW_SHOWN
-    );
-
-    if (!window_) {
-        std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return false;
-    }
+    if (config.offscreen) {
+        target_ = SDL_CreateRGBSurfaceWithFormat(0, config.window_width, config.window_height,
+                                                 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!target_) {
+            std::cerr << "Frame buffer creation failed: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return false;
+        }
+        renderer_ = SDL_CreateSoftwareRenderer(target_);
+        if (!renderer_) {
+            std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+            SDL_FreeSurface(target_);
+            target_ = nullptr;
+            SDL_Quit();
+            return false;
+        }
+    } else {
+        window_ = SDL_CreateWindow(
+            "FlappyRL",
+            SDL_WINDOWPOS_UNDEFINED,
+            SDL_WINDOWPOS_UNDEFINED,
+            config.window_width,
+            config.window_height,
+            SDL_WINDOW_SHOWN
+        );
 
-    renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer_) {
-        std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(window_);
-        SDL_Quit();
-        return false;
+        if (!window_) {
+            std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return false;
+        }
+
+        Uint32 flags = SDL_RENDERER_ACCELERATED;
+        if (config.vsync) {
+            flags |= SDL_RENDERER_PRESENTVSYNC;
+        }
+        renderer_ = SDL_CreateRenderer(window_, -1, flags);
+        if (!renderer_) {
+            std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+            SDL_DestroyWindow(window_);
+            SDL_Quit();
+            return false;
+        }
     }
 
     config_ = config;
@@ -52,15 +75,18 @@ bool Renderer::initialize(const RenderConfig& config) {
     config_.scale_y = static_cast<float>(config.window_height);  // Full height for world
     
     // Allocate memory for previous keyboard state
-    keyboard_state_ = SDL_GetKeyboardState(&num_keys_);
-    if (num_keys_ > 0) {
-        previous_keyboard_state_ = new Uint8[num_keys_];
-        std::memset(previous_keyboard_state_, 0, num_keys_);
+    if (!config.offscreen) {
+        keyboard_state_ = SDL_GetKeyboardState(&num_keys_);
+        if (num_keys_ > 0) {
+            previous_keyboard_state_ = new Uint8[num_keys_];
+            std::memset(previous_keyboard_state_, 0, num_keys_);
+        }
     }
     
     initialized_ = true;
     return true;
 #else
+    (void)config;
     std::cerr << "SDL2 not available. Install SDL2 to enable visualization." << std::endl;
     return false;
 #endif
@@ -72,10 +98,19 @@ void Renderer::shutdown() {
         delete[] previous_keyboard_state_;
         previous_keyboard_state_ = nullptr;
     }
+    keyboard_state_ = nullptr;
     if (renderer_) {
         SDL_DestroyRenderer(renderer_);
         renderer_ = nullptr;
     }
+    if (capture_) {
+        SDL_FreeSurface(capture_);
+        capture_ = nullptr;
+    }
+    if (target_) {
+        SDL_FreeSurface(target_);
+        target_ = nullptr;
+    }
     if (window_) {
         SDL_DestroyWindow(window_);
         window_ = nullptr;
@@ -171,97 +206,129 @@ void Renderer::render_background() {
 #endif
 }
 
-void Renderer::render_bird(float y, float vy) {
 #ifdef HAVE_SDL2
-    const float kBirdX = 0.20f;
-    int bird_x = world_to_screen_x(kBirdX);
+void Renderer::fill_rects(const std::vector<SDL_Rect>& rects, Uint8 r, Uint8 g, Uint8 b) {
+    if (rects.empty()) {
+        return;
+    }
+    SDL_SetRenderDrawColor(renderer_, r, g, b, 255);
+    SDL_RenderFillRects(renderer_, rects.data(), static_cast<int>(rects.size()));
+}
+#endif
+
+void Renderer::add_bird(float y) {
+#ifdef HAVE_SDL2
+    int bird_x = world_to_screen_x(env_flappy::FlappyEnv::kBirdX);
     int bird_y = world_to_screen_y(y);
-    
-    // Bird is a yellow circle
-    SDL_SetRenderDrawColor(renderer_, 255, 255, 0, 255);
-    
+
     // Draw circle (simple approximation with filled rect)
     int bird_size = 15;
-    SDL_Rect bird_rect = {
-        bird_x - bird_size / 2,
-        bird_y - bird_size / 2,
-        bird_size,
-        bird_size
-    };
-    SDL_RenderFillRect(renderer_, &bird_rect);
-    
-    // Draw a simple "beak" pointing in direction of velocity
-    if (std::abs(vy) > 0.1f) {
-        SDL_SetRenderDrawColor(renderer_, 255, 165, 0, 255);
-        int beak_offset = (vy > 0) ? bird_size / 2 : -bird_size / 2;
-        SDL_RenderDrawLine(renderer_, bird_x, bird_y, bird_x + 5, bird_y + beak_offset);
-    }
+    bird_rects_.push_back({bird_x - bird_size / 2, bird_y - bird_size / 2, bird_size, bird_size});
+#else
+    (void)y;
 #endif
 }
 
-void Renderer::render_pipe(float x, float gap_y, float pipe_width, float pipe_gap, float /* world_height */) {
+void Renderer::add_pipe(float x, float gap_y, float pipe_width, float pipe_gap) {
 #ifdef HAVE_SDL2
     int pipe_screen_x = world_to_screen_x(x);
     int pipe_screen_width = static_cast<int>(pipe_width * config_.scale_x);
-    
+    if (pipe_screen_x + pipe_screen_width / 2 < 0 ||
+        pipe_screen_x - pipe_screen_width / 2 > config_.window_width) {
+        return;  // off screen
+    }
+
     float gap_top = gap_y + pipe_gap * 0.5f;
     float gap_bottom = gap_y - pipe_gap * 0.5f;
-    
-    // Top pipe
-    SDL_SetRenderDrawColor(renderer_, 34, 139, 34, 255);  // Forest green
-    SDL_Rect top_pipe = {
-        pipe_screen_x - pipe_screen_width / 2,
-        0,
-        pipe_screen_width,
-        world_to_screen_y(gap_top)
-    };
-    SDL_RenderFillRect(renderer_, &top_pipe);
-    
-    // Bottom pipe
-    SDL_Rect bottom_pipe = {
-        pipe_screen_x - pipe_screen_width / 2,
-        world_to_screen_y(gap_bottom),
-        pipe_screen_width,
-        config_.window_height - world_to_screen_y(gap_bottom)
-    };
-    SDL_RenderFillRect(renderer_, &bottom_pipe);
-    
-    // Pipe outline
-    SDL_SetRenderDrawColor(renderer_, 0, 100, 0, 255);
-    SDL_RenderDrawRect(renderer_, &top_pipe);
-    SDL_RenderDrawRect(renderer_, &bottom_pipe);
+    int left = pipe_screen_x - pipe_screen_width / 2;
+
+    // Top and bottom pipe
+    pipe_rects_.push_back({left, 0, pipe_screen_width, world_to_screen_y(gap_top)});
+    pipe_rects_.push_back({left, world_to_screen_y(gap_bottom), pipe_screen_width,
+                           config_.window_height - world_to_screen_y(gap_bottom)});
+#else
+    (void)x;
+    (void)gap_y;
+    (void)pipe_width;
+    (void)pipe_gap;
 #endif
 }
 
-void Renderer::render(const env_flappy::FlappyEnv& env) {
+void Renderer::draw(const env_flappy::FlappyEnv& env) {
     if (!initialized_) return;
 
 #ifdef HAVE_SDL2
     render_background();
-    
-    // Get current observation
-    auto obs = env.observe();
-    
-    // Render bird
-    render_bird(obs.y, obs.vy);
-    
-    // Render current pipe based on observation
+
+    // Collect the frame's geometry first, then submit it one color at a time
+    pipe_rects_.clear();
+    bird_rects_.clear();
     const auto& config = env.config();
-    if (obs.dx_to_pipe < 2.0f && obs.dx_to_pipe > -0.5f) {  // Only render if pipe is nearby
-        // Bird is at fixed x = 0.20, so pipe x = bird_x + dx_to_pipe
-        const float kBirdX = 0.20f;
-        float pipe_x = kBirdX + obs.dx_to_pipe;
-        float gap_y = obs.y + obs.dy_to_gap;
-        render_pipe(pipe_x, gap_y, config.pipe_width, config.pipe_gap, config.world_height);
+    for (std::size_t k = 0; k < env.num_pipes(); ++k) {
+        add_pipe(env.pipe_center_x(k), env.pipe_gap_y(k), config.pipe_width, config.pipe_gap);
     }
-    
-    present();
+    auto obs = env.observe();
+    add_bird(obs.y);
+
+    fill_rects(pipe_rects_, 34, 139, 34);  // Forest green
+    if (!pipe_rects_.empty()) {
+        // Pipe outline
+        SDL_SetRenderDrawColor(renderer_, 0, 100, 0, 255);
+        SDL_RenderDrawRects(renderer_, pipe_rects_.data(), static_cast<int>(pipe_rects_.size()));
+    }
+
+    // Bird is a yellow square with a "beak" pointing in the direction of velocity
+    fill_rects(bird_rects_, 255, 255, 0);
+    if (std::abs(obs.vy) > 0.1f) {
+        const SDL_Rect& bird = bird_rects_.front();
+        int bird_x = bird.x + bird.w / 2;
+        int bird_y = bird.y + bird.h / 2;
+        int beak_offset = (obs.vy > 0) ? bird.h / 2 : -bird.h / 2;
+        SDL_SetRenderDrawColor(renderer_, 255, 165, 0, 255);
+        SDL_RenderDrawLine(renderer_, bird_x, bird_y, bird_x + 5, bird_y + beak_offset);
+    }
+#else
+    (void)env;
 #endif
 }
 
+void Renderer::render(const env_flappy::FlappyEnv& env) {
+    if (!initialized_) return;
+    draw(env);
+    present();
+}
+
 void Renderer::present() {
 #ifdef HAVE_SDL2
-    SDL_RenderPresent(renderer_);
+    if (window_) {
+        SDL_RenderPresent(renderer_);
+    }
+#endif
+}
+
+bool Renderer::save_frame(const std::string& path) {
+#ifdef HAVE_SDL2
+    if (!initialized_) {
+        return false;
+    }
+    SDL_Surface* frame = target_;
+    if (!frame) {
+        // Windowed: read the back buffer into a surface kept for later frames
+        if (!capture_) {
+            capture_ = SDL_CreateRGBSurfaceWithFormat(0, config_.window_width,
+                                                      config_.window_height, 32,
+                                                      SDL_PIXELFORMAT_ARGB8888);
+        }
+        if (!capture_ || SDL_RenderReadPixels(renderer_, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                                              capture_->pixels, capture_->pitch) != 0) {
+            return false;
+        }
+        frame = capture_;
+    }
+    return SDL_SaveBMP(frame, path.c_str()) == 0;
+#else
+    (void)path;
+    return false;
 #endif
 }
 
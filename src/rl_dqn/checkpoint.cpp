@@ -0,0 +1,202 @@
+#include "rl_dqn/checkpoint.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'L', 'P', 'Y', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t kEndianTag = 0x01020304u;
+constexpr std::size_t kSectionAlignment = 64;
+
+static_assert(sizeof(CheckpointHeader) <= kCheckpointHeaderSize, "Header outgrew its slot");
+
+std::size_t align_up(std::size_t n) {
+    return (n + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+// Section offsets are derived from the counts alone, so writer and reader always agree
+struct Layout {
+    std::size_t parameters_offset;
+    std::size_t section_stride;
+    std::size_t num_sections;
+    std::size_t file_size;
+};
+
+Layout compute_layout(std::size_t num_layer_sizes, std::size_t num_parameters,
+                      bool training_state) {
+    Layout layout;
+    layout.parameters_offset = align_up(kCheckpointHeaderSize + num_layer_sizes * sizeof(int));
+    layout.section_stride = align_up(num_parameters * sizeof(float));
+    layout.num_sections = training_state ? 4 : 1;
+    layout.file_size = layout.parameters_offset + layout.num_sections * layout.section_stride;
+    return layout;
+}
+
+// FNV-1a style mixing over 8-byte words (with a shift to spread high bits); fast enough
+// to run on every load, and catches truncation, bit flips and misplaced sections
+std::uint64_t checksum(const std::byte* data, std::size_t size) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    constexpr std::uint64_t kPrime = 0x100000001b3ull;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * kPrime;
+        h ^= h >> 29;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ static_cast<std::uint64_t>(data[i])) * kPrime;
+    }
+    return h;
+}
+
+// Parameter count of a network with these (positive) layer sizes, or SIZE_MAX when it does
+// not fit in std::size_t, which no real parameter count matches
+std::size_t expected_parameters(const std::vector<int>& layer_sizes) {
+    constexpr std::size_t kOverflow = std::numeric_limits<std::size_t>::max();
+    std::size_t total = 0;
+    for (std::size_t l = 0; l + 1 < layer_sizes.size(); ++l) {
+        std::size_t in = static_cast<std::size_t>(layer_sizes[l]);
+        std::size_t out = static_cast<std::size_t>(layer_sizes[l + 1]);
+        if (in + 1 > kOverflow / out) {
+            return kOverflow;
+        }
+        std::size_t layer = out * (in + 1);   // weights and biases
+        if (layer > kOverflow - total) {
+            return kOverflow;
+        }
+        total += layer;
+    }
+    return total;
+}
+
+} // namespace
+
+void write_checkpoint(const std::string& path, const CheckpointContents& contents) {
+    const std::size_t n = contents.parameters.size();
+    if (n != expected_parameters(contents.layer_sizes)) {
+        throw std::invalid_argument("Parameter count does not match layer sizes");
+    }
+    const bool training_state = !contents.target_parameters.empty();
+    const bool has_moments = !contents.adam_m.empty() || !contents.adam_v.empty();
+    if (training_state && (contents.target_parameters.size() != n ||
+                           (has_moments && (contents.adam_m.size() != n ||
+                                            contents.adam_v.size() != n)))) {
+        throw std::invalid_argument("Training state size mismatch");
+    }
+
+    const Layout layout = compute_layout(contents.layer_sizes.size(), n, training_state);
+    std::vector<std::byte> file(layout.file_size);  // zero padding between sections
+
+    std::memcpy(file.data() + kCheckpointHeaderSize, contents.layer_sizes.data(),
+                contents.layer_sizes.size() * sizeof(int));
+    std::span<const float> sections[4] = {contents.parameters, contents.target_parameters,
+                                          contents.adam_m, contents.adam_v};
+    for (std::size_t k = 0; k < layout.num_sections; ++k) {
+        if (sections[k].empty()) {
+            continue;  // Adam moments before the first update: all zero
+        }
+        std::memcpy(file.data() + layout.parameters_offset + k * layout.section_stride,
+                    sections[k].data(), n * sizeof(float));
+    }
+
+    CheckpointHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kCheckpointVersion;
+    header.endian_tag = kEndianTag;
+    header.dtype = kCheckpointFloat32;
+    header.flags = training_state ? kCheckpointHasTrainingState : 0;
+    header.num_layer_sizes = static_cast<std::uint32_t>(contents.layer_sizes.size());
+    header.num_parameters = n;
+    header.training_steps = contents.training_steps;
+    header.env_steps = contents.env_steps;
+    header.adam_step = contents.adam_step;
+    header.adam_beta1_power = contents.adam_beta1_power;
+    header.adam_beta2_power = contents.adam_beta2_power;
+    header.checksum = checksum(file.data() + kCheckpointHeaderSize,
+                               file.size() - kCheckpointHeaderSize);
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    // Write beside the target and rename, so readers never map a half-written file
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot write " + tmp_path);
+        }
+        out.write(reinterpret_cast<const char*>(file.data()),
+                  static_cast<std::streamsize>(file.size()));
+        if (!out) {
+            throw std::runtime_error("Write failed: " + tmp_path);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp_path, path, error);
+    if (error) {
+        throw std::runtime_error("Cannot replace " + path + ": " + error.message());
+    }
+}
+
+Checkpoint::Checkpoint(const std::string& path, bool verify) : file_(path) {
+    if (file_.size() < kCheckpointHeaderSize) {
+        throw std::runtime_error("Not a checkpoint (too small): " + path);
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a checkpoint (bad magic): " + path);
+    }
+    if (header_.version != kCheckpointVersion) {
+        throw std::runtime_error("Unsupported checkpoint version " +
+                                 std::to_string(header_.version) + ": " + path);
+    }
+    if (header_.endian_tag != kEndianTag || header_.dtype != kCheckpointFloat32) {
+        throw std::runtime_error("Checkpoint byte order or dtype not supported: " + path);
+    }
+    if (header_.num_layer_sizes < 2 || header_.num_layer_sizes > 1024) {
+        throw std::runtime_error("Corrupt checkpoint (layer count): " + path);
+    }
+
+    // Bound the count by the file size before any size arithmetic can wrap
+    if (header_.num_parameters > (file_.size() - kCheckpointHeaderSize) / sizeof(float)) {
+        throw std::runtime_error("Corrupt checkpoint (parameter count): " + path);
+    }
+    const Layout layout = compute_layout(header_.num_layer_sizes,
+                                         static_cast<std::size_t>(header_.num_parameters),
+                                         has_training_state());
+    if (file_.size() != layout.file_size) {
+        throw std::runtime_error("Corrupt checkpoint (size mismatch): " + path);
+    }
+    if (verify && checksum(file_.data() + kCheckpointHeaderSize,
+                           file_.size() - kCheckpointHeaderSize) != header_.checksum) {
+        throw std::runtime_error("Corrupt checkpoint (checksum mismatch): " + path);
+    }
+
+    layer_sizes_.resize(header_.num_layer_sizes);
+    std::memcpy(layer_sizes_.data(), file_.data() + kCheckpointHeaderSize,
+                layer_sizes_.size() * sizeof(int));
+    for (int size : layer_sizes_) {
+        if (size <= 0) {
+            throw std::runtime_error("Corrupt checkpoint (layer size): " + path);
+        }
+    }
+    if (expected_parameters(layer_sizes_) != header_.num_parameters) {
+        throw std::runtime_error("Corrupt checkpoint (parameter count): " + path);
+    }
+    parameters_offset_ = layout.parameters_offset;
+}
+
+std::span<const float> Checkpoint::section(std::size_t k) const {
+    if (k > 0 && !has_training_state()) {
+        return {};
+    }
+    const std::size_t n = static_cast<std::size_t>(header_.num_parameters);
+    const std::size_t offset = parameters_offset_ + k * align_up(n * sizeof(float));
+    return {reinterpret_cast<const float*>(file_.data() + offset), n};
+}
+
+} // namespace rl_dqn
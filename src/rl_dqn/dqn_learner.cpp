@@ -0,0 +1,344 @@
+#include "rl_dqn/dqn_learner.h"
+#include "rl_dqn/kernels.h"
+#include "rl_dqn/mapped_replay_buffer.h"
+#include "core/telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+namespace {
+
+// Layer 0 of a flat parameter buffer laid out like `network`
+template <DenseNetwork Net>
+LayerView first_layer(const Net& network, std::span<float> parameters) {
+    ConstLayerView view = network.layer(0);
+    float* weights = parameters.data() + network.layer_offset(0);
+    return {weights, weights + static_cast<std::size_t>(view.fan_out) * view.fan_in,
+            view.fan_in, view.fan_out};
+}
+
+// `network`'s parameters as they act on raw inputs: a plain view without an input
+// transform, else a copy in `buffer` whose first layer is the network's folded one
+template <DenseNetwork Net>
+std::span<const float> raw_input_parameters(const Net& network, std::vector<float>& buffer) {
+    std::span<const float> parameters = network.parameters();
+    if (!network.has_input_transform()) {
+        return parameters;
+    }
+    buffer.assign(parameters.begin(), parameters.end());
+    ConstLayerView folded = network.input_layer();
+    LayerView first = first_layer(network, buffer);
+    std::size_t weights = static_cast<std::size_t>(folded.fan_out) * folded.fan_in;
+    std::copy(folded.weights, folded.weights + weights, first.weights);
+    std::copy(folded.biases, folded.biases + folded.fan_out, first.biases);
+    return buffer;
+}
+
+// Inverse of raw_input_parameters(): fold x = (x' - shift) / scale into the first layer
+template <DenseNetwork Net>
+void load_raw_input_parameters(Net& network, std::span<const float> raw) {
+    std::copy(raw.begin(), raw.end(), network.parameters().begin());
+    if (!network.has_input_transform()) {
+        return;
+    }
+    std::span<const float> scale = network.input_scale();
+    std::span<const float> shift = network.input_shift();
+    std::vector<float> inverse_scale(scale.size());
+    std::vector<float> inverse_shift(scale.size());
+    for (std::size_t i = 0; i < scale.size(); ++i) {
+        inverse_scale[i] = 1.0f / scale[i];
+        inverse_shift[i] = -shift[i] / scale[i];
+    }
+    fold_input_transform(first_layer(network, network.parameters()), inverse_scale,
+                         inverse_shift);
+    network.refresh_input_transform();
+}
+
+} // namespace
+
+template <DenseNetwork Net>
+BasicDQNLearner<Net>::BasicDQNLearner(const DQNConfig& config)
+    : config_(config),
+      main_network_(config.layer_sizes, config.seed),
+      target_network_(config.layer_sizes, config.seed + 1),
+      optimizer_(config.learning_rate, config.adam_beta1, config.adam_beta2, config.adam_epsilon),
+      bootstrap_discount_(std::pow(config.gamma, static_cast<float>(config.n_step))) {
+    if (config_.n_step < 1) {
+        throw std::invalid_argument("n_step must be at least 1");
+    }
+    if (config_.learner_threads < 1) {
+        throw std::invalid_argument("learner_threads must be at least 1");
+    }
+
+    if (!config_.replay_directory.empty()) {
+        if (config_.prioritized_replay) {
+            throw std::invalid_argument("An on-disk replay buffer samples uniformly only");
+        }
+        replay_buffer_ = std::make_unique<MappedReplayBuffer>(
+            config_.replay_directory, config_.replay_buffer_size,
+            config_.replay_segment_records, config_.seed + 2);
+    } else if (config_.prioritized_replay) {
+        auto buffer = std::make_unique<PrioritizedReplayBuffer>(
+            config_.replay_buffer_size, config_.priority_alpha, config_.priority_epsilon,
+            config_.seed + 2);
+        prioritized_buffer_ = buffer.get();
+        replay_buffer_ = std::move(buffer);
+    } else {
+        replay_buffer_ = std::make_unique<ReplayBuffer>(config_.replay_buffer_size,
+                                                        config_.seed + 2);
+    }
+
+    if (config_.normalize_observations) {
+        if (config_.layer_sizes.empty() ||
+            config_.layer_sizes[0] != static_cast<int>(kObservationSize)) {
+            throw std::invalid_argument("normalize_observations needs observation-sized input");
+        }
+        using Schema = env_flappy::ObservationSchema;
+        float scale[kObservationSize];
+        float shift[kObservationSize];
+        for (std::size_t i = 0; i < kObservationSize; ++i) {
+            scale[i] = Schema::scale(i);
+            shift[i] = Schema::shift(i);
+        }
+        main_network_.set_input_transform(scale, shift);
+        target_network_.set_input_transform(scale, shift);
+    }
+
+    // Initialize target network with same weights as main network
+    update_target_network();
+
+    // One shard per thread, but never an empty one
+    std::size_t shards = std::max<std::size_t>(
+        1, std::min(static_cast<std::size_t>(config_.learner_threads), config_.batch_size));
+    workspace_.reserve(config_.layer_sizes, static_cast<int>(config_.batch_size),
+                       main_network_.parameters().size(), shards);
+    if (shards > 1) {
+        pool_ = std::make_unique<core::ThreadPool>(shards);
+    }
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::store(const Experience& experience) {
+    replay_buffer_->push(experience);
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::compute_targets(std::size_t begin, std::size_t end,
+                                           TrainWorkspace::Shard& shard) {
+    const TransitionBatch& batch = workspace_.batch;
+    const int rows = static_cast<int>(end - begin);
+    std::span<const float> next_states(batch.next_states.data() + begin * kObservationSize,
+                                       (end - begin) * kObservationSize);
+    CORE_TELEMETRY_SCOPE_N(kForward, end - begin);
+
+    // Q-values of every next state in one batched pass through the target network
+    const float* next_q = target_network_.forward_batch(next_states, rows, shard.target_cache);
+
+    // Double DQN decouples selection from evaluation: the online network picks the action,
+    // the target network scores it. Plain DQN selects and scores with the target network.
+    const float* select_q = next_q;
+    if (config_.double_dqn) {
+        select_q = main_network_.forward_batch(next_states, rows, shard.online_next_cache);
+    }
+
+    for (std::size_t i = begin; i < end; ++i) {
+        // Terminal state: target is just the (n-step) reward
+        std::size_t r = i - begin;
+        int best = select_q[r * 2 + 1] > select_q[r * 2] ? 1 : 0;
+        float bootstrap = batch.dones[i] ? 0.0f : bootstrap_discount_ * next_q[r * 2 + best];
+        workspace_.targets[i] = batch.rewards[i] + bootstrap;
+    }
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::train_shard(std::size_t index) {
+    TrainWorkspace& ws = workspace_;
+    TrainWorkspace::Shard& shard = ws.shards[index];
+    const TransitionBatch& batch = ws.batch;
+    const std::size_t begin = ws.shard_begin(index, batch.size);
+    const std::size_t end = ws.shard_begin(index + 1, batch.size);
+    const int rows = static_cast<int>(end - begin);
+
+    // Compute targets
+    compute_targets(begin, end, shard);
+
+    // Get current Q-values for the shard's rows at once
+    const float* predicted_q;
+    {
+        CORE_TELEMETRY_SCOPE_N(kForward, end - begin);
+        std::span<const float> states(batch.states.data() + begin * kObservationSize,
+                                      (end - begin) * kObservationSize);
+        predicted_q = main_network_.forward_batch(states, rows, shard.online_cache);
+    }
+
+    // Importance-weighted MSE on the taken action only; the other action's gradient is zero
+    float* output_gradients = ws.output_gradients.data() + begin * 2;
+    shard.loss = 0.0f;
+    for (std::size_t i = begin; i < end; ++i) {
+        std::size_t r = i - begin;
+        int action_idx = (batch.actions[i] == env_flappy::Action::FLAP) ? 1 : 0;
+        float error = predicted_q[r * 2 + action_idx] - ws.targets[i];
+        float weight = batch.weights[i];
+        output_gradients[r * 2 + action_idx] = weight * error;
+        shard.loss += weight * error * error;
+        ws.td_errors[i] = error;
+    }
+
+    // Gradients summed over the shard, laid out like the network's parameters; backward_batch
+    // accumulates, so start from zero
+    shard.gradients.assign(main_network_.parameters().size(), 0.0f);
+    {
+        CORE_TELEMETRY_SCOPE_N(kBackward, end - begin);
+        main_network_.backward_batch(shard.online_cache,
+                                     std::span<const float>(output_gradients, (end - begin) * 2),
+                                     shard.gradients);
+    }
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::reduce_gradients() {
+    // Every parameter sums its shard values in the same order whichever worker handles its
+    // block, so the reduction is deterministic without locks or a second buffer
+    constexpr std::size_t kBlock = 4096;
+    std::vector<TrainWorkspace::Shard>& shards = workspace_.shards;
+    const std::size_t n = shards[0].gradients.size();
+    pool_->parallel_for((n + kBlock - 1) / kBlock, [&](std::size_t block, std::size_t) {
+        float* sum = shards[0].gradients.data();
+        const std::size_t end = std::min(n, (block + 1) * kBlock);
+        for (std::size_t s = 1; s < shards.size(); ++s) {
+            const float* g = shards[s].gradients.data();
+            for (std::size_t k = block * kBlock; k < end; ++k) {
+                sum[k] += g[k];
+            }
+        }
+    });
+}
+
+template <DenseNetwork Net>
+float BasicDQNLearner<Net>::train() {
+    if (!replay_buffer_->can_sample(config_.batch_size)) {
+        return 0.0f;  // Not enough experiences yet
+    }
+
+    // Sample batch; states arrive already packed as a [batch x 4] input matrix
+    if (prioritized_buffer_ != nullptr) {
+        // Anneal the importance-sampling exponent linearly towards 1
+        float progress = std::min(1.0f, static_cast<float>(training_steps_) /
+                                            static_cast<float>(config_.priority_beta_steps));
+        prioritized_buffer_->set_beta(config_.priority_beta_start +
+                                      (1.0f - config_.priority_beta_start) * progress);
+    }
+    TrainWorkspace& ws = workspace_;
+    {
+        CORE_TELEMETRY_SCOPE_N(kReplaySample, config_.batch_size);
+        replay_buffer_->sample(config_.batch_size, ws.batch);
+    }
+    const TransitionBatch& batch = ws.batch;
+    ws.targets.resize(batch.size);
+    ws.td_errors.resize(batch.size);
+    ws.output_gradients.assign(batch.size * 2, 0.0f);
+
+    // Targets, loss and gradients per shard, then one sum in shard order
+    if (pool_ == nullptr) {
+        train_shard(0);
+    } else {
+        pool_->parallel_for(ws.shards.size(), [this](std::size_t shard, std::size_t) {
+            train_shard(shard);
+        });
+        reduce_gradients();
+    }
+    float total_loss = 0.0f;
+    for (const TrainWorkspace::Shard& shard : ws.shards) {
+        total_loss += shard.loss;
+    }
+
+    // TD errors become the new priorities of the sampled slots (no-op for uniform replay)
+    replay_buffer_->update_priorities(batch.slots, ws.td_errors);
+
+    // Apply Adam optimizer update in place on the flat parameter buffer
+    {
+        CORE_TELEMETRY_SCOPE(kOptimizer);
+        optimizer_.update(main_network_.parameters(), ws.shards[0].gradients);
+        main_network_.refresh_input_transform();
+    }
+
+    if (config_.target_tau > 0.0f) {
+        soft_update_target_network(config_.target_tau);
+    }
+
+    float avg_loss = total_loss / batch.size;
+
+    training_steps_++;
+    return avg_loss;
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::update_target_network() {
+    CORE_TELEMETRY_SCOPE(kTargetSync);
+    // Both flat buffers share one layout, so a sync is a single contiguous copy
+    std::span<const float> source = main_network_.parameters();
+    std::copy(source.begin(), source.end(), target_network_.parameters().begin());
+    target_network_.refresh_input_transform();
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::soft_update_target_network(float tau) {
+    CORE_TELEMETRY_SCOPE(kTargetSync);
+    std::span<float> target = target_network_.parameters();
+    kernels::active().polyak_update(target.data(), main_network_.parameters().data(),
+                                    target.size(), tau);
+    target_network_.refresh_input_transform();
+}
+
+template <DenseNetwork Net>
+std::span<const float> BasicDQNLearner<Net>::policy_parameters() const {
+    return raw_input_parameters(main_network_, export_policy_);
+}
+
+template <DenseNetwork Net>
+CheckpointContents BasicDQNLearner<Net>::checkpoint_contents(
+    bool include_training_state) const {
+    CheckpointContents contents;
+    contents.layer_sizes = main_network_.get_layer_sizes();
+    contents.parameters = raw_input_parameters(main_network_, export_parameters_);
+    contents.training_steps = training_steps_;
+    if (include_training_state) {
+        contents.target_parameters = raw_input_parameters(target_network_, export_target_);
+        contents.adam_step = optimizer_.get_step();
+        contents.adam_beta1_power = optimizer_.beta1_power();
+        contents.adam_beta2_power = optimizer_.beta2_power();
+        contents.adam_m = optimizer_.first_moments();   // empty before the first update
+        contents.adam_v = optimizer_.second_moments();
+    }
+    return contents;
+}
+
+template <DenseNetwork Net>
+void BasicDQNLearner<Net>::load_checkpoint(const Checkpoint& checkpoint) {
+    if (checkpoint.layer_sizes() != main_network_.get_layer_sizes()) {
+        throw std::invalid_argument("Checkpoint layer sizes do not match the network");
+    }
+
+    std::span<const float> parameters = checkpoint.parameters();
+    load_raw_input_parameters(main_network_, parameters);
+    training_steps_ = static_cast<int>(checkpoint.header().training_steps);
+
+    if (checkpoint.has_training_state()) {
+        load_raw_input_parameters(target_network_, checkpoint.target_parameters());
+        optimizer_.restore(static_cast<int>(checkpoint.header().adam_step),
+                           checkpoint.header().adam_beta1_power,
+                           checkpoint.header().adam_beta2_power,
+                           checkpoint.adam_m(), checkpoint.adam_v());
+    } else {
+        update_target_network();
+        optimizer_.reset();
+    }
+}
+
+template class BasicDQNLearner<Network>;
+template class BasicDQNLearner<DefaultFixedNetwork>;
+
+} // namespace rl_dqn
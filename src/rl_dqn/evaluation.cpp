@@ -0,0 +1,199 @@
+#include "rl_dqn/evaluation.h"
+#include "rl_dqn/fixed_network.h"
+#include "rl_dqn/inference.h"
+#include "rl_dqn/quantized_network.h"
+#include "rl_dqn/replay_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace rl_dqn {
+
+namespace {
+
+// Run episodes [first, first + count) to completion, stepping the live ones together.
+// Finished episodes leave the batch by swapping with the last live slot, which keeps the
+// layout a pure function of the chunk's episodes.
+template <InferenceNetwork Net>
+void run_chunk(const Net& network, const EvalConfig& config, std::size_t first,
+               std::size_t count, InferenceContext& inference,
+               std::span<EpisodeResult> results,
+               std::vector<env_flappy::EpisodeRecording>* recordings) {
+    std::vector<env_flappy::FlappyEnv> envs;
+    std::vector<std::size_t> episode;       // slot -> episode index
+    // Row-major [slot x kObservationSize], the layout the network reads directly
+    core::AlignedVector<float> observations(count * kObservationSize);
+    envs.reserve(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        envs.emplace_back(config.seed + first + k, config.env);
+        episode.push_back(first + k);
+        envs.back().observe(observations.data() + k * kObservationSize);
+        results[first + k] = EpisodeResult{};
+        if (recordings) {
+            (*recordings)[first + k] = {config.seed + first + k, 0, {}};
+        }
+    }
+    std::vector<env_flappy::Action> actions(count);
+
+    std::size_t live = count;
+    while (live > 0) {
+        inference.greedy_actions(network,
+                                 std::span<const float>(observations.data(),
+                                                        live * kObservationSize),
+                                 std::span(actions.data(), live));
+        std::size_t slot = 0;
+        while (slot < live) {
+            env_flappy::StepResult step = envs[slot].step(actions[slot]);
+            EpisodeResult& result = results[episode[slot]];
+            if (recordings) {
+                (*recordings)[episode[slot]].push(actions[slot]);
+            }
+            result.score += step.reward;
+            result.length += 1;
+            if (!step.done && step.reward > config.env.r_step) {
+                result.pipes += 1;
+            }
+            float* row = observations.data() + slot * kObservationSize;
+            write_observation(step.observation, row);
+
+            bool truncated = !step.done && result.length >= config.max_steps;
+            if (step.done || truncated) {
+                result.truncated = truncated;
+                --live;
+                std::swap(envs[slot], envs[live]);
+                std::swap(episode[slot], episode[live]);
+                std::swap_ranges(row, row + kObservationSize,
+                                 observations.data() + live * kObservationSize);
+                std::swap(actions[slot], actions[live]);  // the moved-in env has not stepped
+            } else {
+                ++slot;
+            }
+        }
+    }
+}
+
+void hash_bytes(std::uint64_t& hash, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+}
+
+template <class T>
+T percentile(const std::vector<T>& sorted, double p) {
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace
+
+template <InferenceNetwork Net>
+std::vector<EpisodeResult> evaluate_policy(
+    const Net& network, const EvalConfig& config, core::ThreadPool& pool,
+    std::vector<env_flappy::EpisodeRecording>* recordings) {
+    if (config.batch == 0 || config.max_steps <= 0) {
+        throw std::invalid_argument("Evaluation batch and max_steps must be positive");
+    }
+    env_flappy::FlappyEnv::validate_config(config.env);
+
+    std::vector<EpisodeResult> results(config.episodes);
+    if (recordings) {
+        recordings->resize(config.episodes);
+    }
+    const std::size_t num_chunks = (config.episodes + config.batch - 1) / config.batch;
+
+    // Chunk lengths are ragged (one long episode keeps its chunk alive), which the pool's
+    // stealing absorbs; each chunk writes only its own results
+    std::vector<InferenceContext> inference(pool.size());
+    pool.parallel_for(num_chunks, [&](std::size_t chunk, std::size_t worker) {
+        std::size_t first = chunk * config.batch;
+        std::size_t count = std::min(config.batch, config.episodes - first);
+        run_chunk(network, config, first, count, inference[worker], results, recordings);
+    });
+    return results;
+}
+
+template <InferenceNetwork Net>
+std::vector<EpisodeResult> evaluate_policy(
+    const Net& network, const EvalConfig& config,
+    std::vector<env_flappy::EpisodeRecording>* recordings) {
+    const std::size_t num_chunks =
+        config.batch > 0 ? (config.episodes + config.batch - 1) / config.batch : 1;
+    std::size_t threads = config.threads > 0
+                              ? static_cast<std::size_t>(config.threads)
+                              : std::max(1u, std::thread::hardware_concurrency());
+    core::ThreadPool pool(std::max<std::size_t>(1, std::min(threads, num_chunks)));
+    return evaluate_policy(network, config, pool, recordings);
+}
+
+EvalSummary summarize(std::span<const EpisodeResult> results) {
+    EvalSummary summary;
+    summary.episodes = results.size();
+    summary.digest = 0xcbf29ce484222325ull;
+    if (results.empty()) {
+        return summary;
+    }
+
+    std::vector<float> scores;
+    std::vector<int> pipes;
+    std::vector<int> lengths;
+    double score_sum = 0.0;
+    double pipes_sum = 0.0;
+    double length_sum = 0.0;
+    for (const EpisodeResult& r : results) {
+        scores.push_back(r.score);
+        pipes.push_back(r.pipes);
+        lengths.push_back(r.length);
+        score_sum += r.score;
+        pipes_sum += r.pipes;
+        length_sum += r.length;
+        summary.truncated += r.truncated ? 1 : 0;
+
+        std::uint8_t truncated = r.truncated ? 1 : 0;
+        hash_bytes(summary.digest, &r.score, sizeof(r.score));
+        hash_bytes(summary.digest, &r.pipes, sizeof(r.pipes));
+        hash_bytes(summary.digest, &r.length, sizeof(r.length));
+        hash_bytes(summary.digest, &truncated, sizeof(truncated));
+    }
+
+    const double n = static_cast<double>(results.size());
+    summary.mean_score = score_sum / n;
+    summary.mean_pipes = pipes_sum / n;
+    summary.mean_length = length_sum / n;
+    double squares = 0.0;
+    for (float s : scores) {
+        squares += (s - summary.mean_score) * (s - summary.mean_score);
+    }
+    summary.stddev_score = std::sqrt(squares / n);
+
+    std::sort(scores.begin(), scores.end());
+    std::sort(pipes.begin(), pipes.end());
+    std::sort(lengths.begin(), lengths.end());
+    for (std::size_t i = 0; i < std::size(EvalSummary::kPercentiles); ++i) {
+        summary.score_percentiles[i] = percentile(scores, EvalSummary::kPercentiles[i]);
+        summary.pipes_percentiles[i] = percentile(pipes, EvalSummary::kPercentiles[i]);
+        summary.length_percentiles[i] = percentile(lengths, EvalSummary::kPercentiles[i]);
+    }
+    summary.max_pipes = pipes.back();
+    return summary;
+}
+
+using Recordings = std::vector<env_flappy::EpisodeRecording>;
+template std::vector<EpisodeResult> evaluate_policy<Network>(const Network&, const EvalConfig&,
+                                                             Recordings*);
+template std::vector<EpisodeResult> evaluate_policy<DefaultFixedNetwork>(
+    const DefaultFixedNetwork&, const EvalConfig&, Recordings*);
+template std::vector<EpisodeResult> evaluate_policy<QuantizedNetwork>(const QuantizedNetwork&,
+                                                                      const EvalConfig&,
+                                                                      Recordings*);
+template std::vector<EpisodeResult> evaluate_policy<Network>(const Network&, const EvalConfig&,
+                                                             core::ThreadPool&, Recordings*);
+template std::vector<EpisodeResult> evaluate_policy<DefaultFixedNetwork>(
+    const DefaultFixedNetwork&, const EvalConfig&, core::ThreadPool&, Recordings*);
+template std::vector<EpisodeResult> evaluate_policy<QuantizedNetwork>(const QuantizedNetwork&,
+                                                                      const EvalConfig&,
+                                                                      core::ThreadPool&,
+                                                                      Recordings*);
+
+} // namespace rl_dqn
@@ -0,0 +1,112 @@
+#include "rl_dqn/inference.h"
+#include "rl_dqn/replay_buffer.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+template <InferenceNetwork Net>
+const float* InferenceContext::q_values(const Net& network,
+                                        std::span<const env_flappy::Observation> observations) {
+    if (observations.empty()) {
+        throw std::invalid_argument("No observations");
+    }
+    // Observations are laid out as matrix rows already (ObservationSchema): one bulk copy
+    inputs_.resize(observations.size() * kObservationSize);
+    std::memcpy(inputs_.data(), observations.data(), observations.size_bytes());
+    return network.forward_batch(inputs_, static_cast<int>(observations.size()), cache_);
+}
+
+template <InferenceNetwork Net>
+const float* InferenceContext::q_values(const Net& network, std::span<const float> observations) {
+    if (observations.empty() || observations.size() % kObservationSize != 0) {
+        throw std::invalid_argument("Observation matrix must hold whole rows");
+    }
+    return network.forward_batch(observations,
+                                 static_cast<int>(observations.size() / kObservationSize),
+                                 cache_);
+}
+
+namespace {
+
+void argmax_actions(const float* q, std::span<env_flappy::Action> actions) {
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        actions[i] = q[i * 2 + 1] > q[i * 2] ? env_flappy::Action::FLAP
+                                             : env_flappy::Action::NO_FLAP;
+    }
+}
+
+} // namespace
+
+template <InferenceNetwork Net>
+void InferenceContext::greedy_actions(const Net& network,
+                                      std::span<const env_flappy::Observation> observations,
+                                      std::span<env_flappy::Action> actions) {
+    if (actions.size() != observations.size()) {
+        throw std::invalid_argument("Action buffer size mismatch");
+    }
+    argmax_actions(q_values(network, observations), actions);
+}
+
+template <InferenceNetwork Net>
+void InferenceContext::greedy_actions(const Net& network, std::span<const float> observations,
+                                      std::span<env_flappy::Action> actions) {
+    if (actions.size() * kObservationSize != observations.size()) {
+        throw std::invalid_argument("Action buffer size mismatch");
+    }
+    argmax_actions(q_values(network, observations), actions);
+}
+
+template <InferenceNetwork Net>
+void InferenceContext::epsilon_greedy_actions(
+    const Net& network, std::span<const env_flappy::Observation> observations,
+    float epsilon, core::Pcg32& rng, std::span<env_flappy::Action> actions) {
+    greedy_actions(network, observations, actions);
+    for (env_flappy::Action& action : actions) {
+        if (rng.uniform() < epsilon) {
+            action = rng.uniform() < 0.5f ? env_flappy::Action::NO_FLAP
+                                          : env_flappy::Action::FLAP;
+        }
+    }
+}
+
+// Explicit instantiations for the network implementations
+template const float* InferenceContext::q_values(const Network&,
+                                                 std::span<const env_flappy::Observation>);
+template const float* InferenceContext::q_values(const Network&, std::span<const float>);
+template void InferenceContext::greedy_actions(const Network&, std::span<const float>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::greedy_actions(const Network&,
+                                               std::span<const env_flappy::Observation>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::epsilon_greedy_actions(const Network&,
+                                                       std::span<const env_flappy::Observation>,
+                                                       float, core::Pcg32&,
+                                                       std::span<env_flappy::Action>);
+template const float* InferenceContext::q_values(const DefaultFixedNetwork&,
+                                                 std::span<const env_flappy::Observation>);
+template const float* InferenceContext::q_values(const DefaultFixedNetwork&,
+                                                 std::span<const float>);
+template void InferenceContext::greedy_actions(const DefaultFixedNetwork&, std::span<const float>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::greedy_actions(const DefaultFixedNetwork&,
+                                               std::span<const env_flappy::Observation>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::epsilon_greedy_actions(const DefaultFixedNetwork&,
+                                                       std::span<const env_flappy::Observation>,
+                                                       float, core::Pcg32&,
+                                                       std::span<env_flappy::Action>);
+template const float* InferenceContext::q_values(const QuantizedNetwork&,
+                                                 std::span<const env_flappy::Observation>);
+template const float* InferenceContext::q_values(const QuantizedNetwork&, std::span<const float>);
+template void InferenceContext::greedy_actions(const QuantizedNetwork&, std::span<const float>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::greedy_actions(const QuantizedNetwork&,
+                                               std::span<const env_flappy::Observation>,
+                                               std::span<env_flappy::Action>);
+template void InferenceContext::epsilon_greedy_actions(const QuantizedNetwork&,
+                                                       std::span<const env_flappy::Observation>,
+                                                       float, core::Pcg32&,
+                                                       std::span<env_flappy::Action>);
+
+} // namespace rl_dqn
@@ -0,0 +1,299 @@
+#include "rl_dqn/kernels.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace rl_dqn {
+namespace kernels {
+
+namespace detail {
+// ISA-specific tables, each defined in its own translation unit built with matching flags
+#ifdef RL_DQN_HAVE_X86_KERNELS
+extern const KernelTable avx2_kernels;
+extern const KernelTable avx512_kernels;
+#endif
+#ifdef RL_DQN_HAVE_NEON_KERNELS
+extern const KernelTable neon_kernels;
+#endif
+} // namespace detail
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Portable scalar kernels (reference implementation and fallback)
+// ----------------------------------------------------------------------------
+
+// Rows of the batch processed together so each weight row is loaded once per tile
+constexpr int kBatchTile = 4;
+
+void scalar_dense_forward(const float* w, const float* b, const float* x, float* y,
+                          int batch, int in, int out, bool relu) {
+    int r = 0;
+    for (; r + kBatchTile <= batch; r += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(r) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(r) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+            for (int j = 0; j < in; ++j) {
+                s0 += wo[j] * x0[j];
+                s1 += wo[j] * x1[j];
+                s2 += wo[j] * x2[j];
+                s3 += wo[j] * x3[j];
+            }
+            y0[o] = s0 + b[o];
+            y0[o + out] = s1 + b[o];
+            y0[o + 2 * out] = s2 + b[o];
+            y0[o + 3 * out] = s3 + b[o];
+        }
+    }
+    // Remaining rows one at a time
+    for (; r < batch; ++r) {
+        const float* xr = x + static_cast<std::ptrdiff_t>(r) * in;
+        float* yr = y + static_cast<std::ptrdiff_t>(r) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float sum = 0.0f;
+            for (int j = 0; j < in; ++j) {
+                sum += wo[j] * xr[j];
+            }
+            yr[o] = sum + b[o];
+        }
+    }
+
+    if (relu) {
+        std::ptrdiff_t count = static_cast<std::ptrdiff_t>(batch) * out;
+        for (std::ptrdiff_t i = 0; i < count; ++i) {
+            y[i] = y[i] > 0.0f ? y[i] : 0.0f;
+        }
+    }
+}
+
+void scalar_dense_backward_params(const float* x, const float* dy, float* dw, float* db,
+                                  int batch, int in, int out) {
+    // Each gradient row stays hot while the batch streams past it
+    for (int o = 0; o < out; ++o) {
+        float* dw_row = dw + static_cast<std::ptrdiff_t>(o) * in;
+        float bias_sum = 0.0f;
+        for (int r = 0; r < batch; ++r) {
+            float d = dy[static_cast<std::ptrdiff_t>(r) * out + o];
+            if (d == 0.0f) {
+                continue;  // common for Q-heads of actions that were not taken
+            }
+            bias_sum += d;
+            const float* xr = x + static_cast<std::ptrdiff_t>(r) * in;
+            for (int j = 0; j < in; ++j) {
+                dw_row[j] += d * xr[j];
+            }
+        }
+        db[o] += bias_sum;
+    }
+}
+
+void scalar_dense_backward_input(const float* w, const float* x, const float* dy, float* dx,
+                                 int batch, int in, int out, bool relu_mask) {
+    for (int r = 0; r < batch; ++r) {
+        float* dxr = dx + static_cast<std::ptrdiff_t>(r) * in;
+        const float* dyr = dy + static_cast<std::ptrdiff_t>(r) * out;
+        for (int j = 0; j < in; ++j) {
+            dxr[j] = 0.0f;
+        }
+        for (int o = 0; o < out; ++o) {
+            float d = dyr[o];
+            if (d == 0.0f) {
+                continue;
+            }
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            for (int j = 0; j < in; ++j) {
+                dxr[j] += d * wo[j];
+            }
+        }
+        if (relu_mask) {
+            // x is a post-ReLU activation, so x > 0 exactly where the pre-activation was > 0
+            const float* xr = x + static_cast<std::ptrdiff_t>(r) * in;
+            for (int j = 0; j < in; ++j) {
+                dxr[j] = xr[j] > 0.0f ? dxr[j] : 0.0f;
+            }
+        }
+    }
+}
+
+void scalar_adam_update(float* params, const float* grads, float* m, float* v, std::size_t n,
+                        const AdamStep& step) {
+    const float one_minus_beta1 = 1.0f - step.beta1;
+    const float one_minus_beta2 = 1.0f - step.beta2;
+    for (std::size_t i = 0; i < n; ++i) {
+        float g = grads[i];
+        m[i] = step.beta1 * m[i] + one_minus_beta1 * g;
+        v[i] = step.beta2 * v[i] + one_minus_beta2 * g * g;
+        params[i] -= step.step_size * m[i] / (std::sqrt(v[i]) + step.epsilon);
+    }
+}
+
+void scalar_polyak_update(float* target, const float* source, std::size_t n, float tau) {
+    for (std::size_t i = 0; i < n; ++i) {
+        target[i] += tau * (source[i] - target[i]);
+    }
+}
+
+void scalar_quantized_dense_forward(const std::int8_t* w, const float* scales, const float* b,
+                                    const float* x, float* y, int batch, int in, int out,
+                                    bool relu) {
+    int r = 0;
+    for (; r + kBatchTile <= batch; r += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(r) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(r) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+            for (int j = 0; j < in; ++j) {
+                float wj = static_cast<float>(wo[j]);
+                s0 += wj * x0[j];
+                s1 += wj * x1[j];
+                s2 += wj * x2[j];
+                s3 += wj * x3[j];
+            }
+            y0[o] = s0 * scales[o] + b[o];
+            y0[o + out] = s1 * scales[o] + b[o];
+            y0[o + 2 * out] = s2 * scales[o] + b[o];
+            y0[o + 3 * out] = s3 * scales[o] + b[o];
+        }
+    }
+    // Remaining rows one at a time
+    for (; r < batch; ++r) {
+        const float* xr = x + static_cast<std::ptrdiff_t>(r) * in;
+        float* yr = y + static_cast<std::ptrdiff_t>(r) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float sum = 0.0f;
+            for (int j = 0; j < in; ++j) {
+                sum += static_cast<float>(wo[j]) * xr[j];
+            }
+            yr[o] = sum * scales[o] + b[o];
+        }
+    }
+
+    if (relu) {
+        std::ptrdiff_t count = static_cast<std::ptrdiff_t>(batch) * out;
+        for (std::ptrdiff_t i = 0; i < count; ++i) {
+            y[i] = y[i] > 0.0f ? y[i] : 0.0f;
+        }
+    }
+}
+
+const KernelTable scalar_kernels = {
+    "scalar",
+    scalar_dense_forward,
+    scalar_dense_backward_params,
+    scalar_dense_backward_input,
+    scalar_adam_update,
+    scalar_polyak_update,
+    scalar_quantized_dense_forward,
+    detail::make_fixed_kernels<scalar_dense_forward, scalar_dense_backward_params,
+                               scalar_dense_backward_input>(),
+};
+
+// ----------------------------------------------------------------------------
+// CPU feature detection
+// ----------------------------------------------------------------------------
+
+#ifdef RL_DQN_HAVE_X86_KERNELS
+#if defined(_MSC_VER)
+bool os_saves_state(unsigned long long mask) {
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    return osxsave && (_xgetbv(0) & mask) == mask;
+}
+
+bool cpu_has_avx2() {
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    return fma && avx2 && os_saves_state(0x6);  // XMM and YMM state
+}
+
+bool cpu_has_avx512() {
+    int info[4];
+    __cpuidex(info, 7, 0);
+    bool avx512f = (info[1] & (1 << 16)) != 0;
+    return avx512f && cpu_has_avx2() && os_saves_state(0xE6);  // plus opmask and ZMM state
+}
+#else
+bool cpu_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+bool cpu_has_avx512() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && cpu_has_avx2();
+}
+#endif
+#endif
+
+const KernelTable* select_best() {
+    std::vector<const KernelTable*> tables = available();
+
+    if (const char* forced = std::getenv("FLAPPY_KERNELS")) {
+        for (const KernelTable* table : tables) {
+            if (std::strcmp(table->name, forced) == 0) {
+                return table;
+            }
+        }
+    }
+
+    // available() lists tables from slowest to fastest
+    return tables.back();
+}
+
+} // namespace
+
+std::vector<const KernelTable*> available() {
+    std::vector<const KernelTable*> tables = {&scalar_kernels};
+#ifdef RL_DQN_HAVE_X86_KERNELS
+    if (cpu_has_avx2()) {
+        tables.push_back(&detail::avx2_kernels);
+    }
+    if (cpu_has_avx512()) {
+        tables.push_back(&detail::avx512_kernels);
+    }
+#endif
+#ifdef RL_DQN_HAVE_NEON_KERNELS
+    // NEON is part of the AArch64 baseline
+    tables.push_back(&detail::neon_kernels);
+#endif
+    return tables;
+}
+
+const KernelTable* find(const char* name) {
+    for (const KernelTable* table : available()) {
+        if (std::strcmp(table->name, name) == 0) {
+            return table;
+        }
+    }
+    return nullptr;
+}
+
+const KernelTable& active() {
+    static const KernelTable* const selected = select_best();
+    return *selected;
+}
+
+} // namespace kernels
+} // namespace rl_dqn
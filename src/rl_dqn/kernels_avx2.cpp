@@ -0,0 +1,386 @@
+// AVX2 + FMA dense kernels. This file is compiled with -mavx2 -mfma and is only entered after
+// kernels::active() has confirmed CPU support, so it must not pull in inline library code
+// (std::fill, std::max, ...) whose out-of-line copies could be shared with baseline code.
+#include "rl_dqn/kernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace rl_dqn {
+namespace kernels {
+
+namespace {
+
+constexpr int kLanes = 8;
+constexpr int kBatchTile = 4;
+
+inline float hsum(__m256 v) {
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+inline float relu(float v) {
+    return v > 0.0f ? v : 0.0f;
+}
+
+// Narrow layers (e.g. the 4-wide observation input): transpose a block of kLanes weight rows
+// once, then every sample is `in` broadcast-FMAs producing kLanes outputs
+void forward_narrow(const float* w, const float* b, const float* x, float* y,
+                    int batch, int in, int out, bool relu_out) {
+    alignas(32) float wt[kLanes][kLanes];
+    const __m256 zero = _mm256_setzero_ps();
+
+    int o0 = 0;
+    for (; o0 + kLanes <= out; o0 += kLanes) {
+        for (int k = 0; k < in; ++k) {
+            for (int r = 0; r < kLanes; ++r) {
+                wt[k][r] = w[static_cast<std::ptrdiff_t>(o0 + r) * in + k];
+            }
+        }
+        const __m256 bias = _mm256_loadu_ps(b + o0);
+        for (int s = 0; s < batch; ++s) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            __m256 acc = bias;
+            for (int k = 0; k < in; ++k) {
+                acc = _mm256_fmadd_ps(_mm256_set1_ps(xs[k]), _mm256_load_ps(wt[k]), acc);
+            }
+            if (relu_out) {
+                acc = _mm256_max_ps(acc, zero);
+            }
+            _mm256_storeu_ps(y + static_cast<std::ptrdiff_t>(s) * out + o0, acc);
+        }
+    }
+    // Leftover outputs
+    for (int o = o0; o < out; ++o) {
+        const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+        for (int s = 0; s < batch; ++s) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            float sum = b[o];
+            for (int k = 0; k < in; ++k) {
+                sum += wo[k] * xs[k];
+            }
+            y[static_cast<std::ptrdiff_t>(s) * out + o] = relu_out ? relu(sum) : sum;
+        }
+    }
+}
+
+// Wide layers: each weight row is dotted against kBatchTile samples at once
+void forward_wide(const float* w, const float* b, const float* x, float* y,
+                  int batch, int in, int out, bool relu_out) {
+    const int vec_end = in - in % kLanes;
+
+    int s = 0;
+    for (; s + kBatchTile <= batch; s += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(s) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m256 a0 = _mm256_setzero_ps();
+            __m256 a1 = _mm256_setzero_ps();
+            __m256 a2 = _mm256_setzero_ps();
+            __m256 a3 = _mm256_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                __m256 wv = _mm256_loadu_ps(wo + k);
+                a0 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x0 + k), a0);
+                a1 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x1 + k), a1);
+                a2 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x2 + k), a2);
+                a3 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x3 + k), a3);
+            }
+            float s0 = hsum(a0), s1 = hsum(a1), s2 = hsum(a2), s3 = hsum(a3);
+            for (int k = vec_end; k < in; ++k) {
+                s0 += wo[k] * x0[k];
+                s1 += wo[k] * x1[k];
+                s2 += wo[k] * x2[k];
+                s3 += wo[k] * x3[k];
+            }
+            s0 += b[o];
+            s1 += b[o];
+            s2 += b[o];
+            s3 += b[o];
+            y0[o] = relu_out ? relu(s0) : s0;
+            y0[o + out] = relu_out ? relu(s1) : s1;
+            y0[o + 2 * out] = relu_out ? relu(s2) : s2;
+            y0[o + 3 * out] = relu_out ? relu(s3) : s3;
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(wo + k), _mm256_loadu_ps(xs + k), acc);
+            }
+            float sum = hsum(acc);
+            for (int k = vec_end; k < in; ++k) {
+                sum += wo[k] * xs[k];
+            }
+            sum += b[o];
+            ys[o] = relu_out ? relu(sum) : sum;
+        }
+    }
+}
+
+void dense_forward(const float* w, const float* b, const float* x, float* y,
+                   int batch, int in, int out, bool relu_out) {
+    if (in < kLanes) {
+        forward_narrow(w, b, x, y, batch, in, out, relu_out);
+    } else {
+        forward_wide(w, b, x, y, batch, in, out, relu_out);
+    }
+}
+
+// acc[0..n) += d * x[0..n)
+inline void axpy(float d, const float* x, float* acc, int n) {
+    const __m256 dv = _mm256_set1_ps(d);
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        _mm256_storeu_ps(acc + k, _mm256_fmadd_ps(dv, _mm256_loadu_ps(x + k),
+                                                  _mm256_loadu_ps(acc + k)));
+    }
+    for (; k < n; ++k) {
+        acc[k] += d * x[k];
+    }
+}
+
+inline void zero(float* p, int n) {
+    const __m256 z = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        _mm256_storeu_ps(p + k, z);
+    }
+    for (; k < n; ++k) {
+        p[k] = 0.0f;
+    }
+}
+
+void dense_backward_params(const float* x, const float* dy, float* dw, float* db,
+                           int batch, int in, int out) {
+    for (int o = 0; o < out; ++o) {
+        float* dw_row = dw + static_cast<std::ptrdiff_t>(o) * in;
+        float bias_sum = 0.0f;
+        for (int s = 0; s < batch; ++s) {
+            float d = dy[static_cast<std::ptrdiff_t>(s) * out + o];
+            if (d == 0.0f) {
+                continue;
+            }
+            bias_sum += d;
+            axpy(d, x + static_cast<std::ptrdiff_t>(s) * in, dw_row, in);
+        }
+        db[o] += bias_sum;
+    }
+}
+
+void dense_backward_input(const float* w, const float* x, const float* dy, float* dx,
+                          int batch, int in, int out, bool relu_mask) {
+    const __m256 zero_v = _mm256_setzero_ps();
+    for (int s = 0; s < batch; ++s) {
+        float* dxs = dx + static_cast<std::ptrdiff_t>(s) * in;
+        const float* dys = dy + static_cast<std::ptrdiff_t>(s) * out;
+        zero(dxs, in);
+        for (int o = 0; o < out; ++o) {
+            if (dys[o] != 0.0f) {
+                axpy(dys[o], w + static_cast<std::ptrdiff_t>(o) * in, dxs, in);
+            }
+        }
+        if (relu_mask) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            int k = 0;
+            for (; k + kLanes <= in; k += kLanes) {
+                __m256 keep = _mm256_cmp_ps(_mm256_loadu_ps(xs + k), zero_v, _CMP_GT_OQ);
+                _mm256_storeu_ps(dxs + k, _mm256_and_ps(_mm256_loadu_ps(dxs + k), keep));
+            }
+            for (; k < in; ++k) {
+                dxs[k] = xs[k] > 0.0f ? dxs[k] : 0.0f;
+            }
+        }
+    }
+}
+
+void adam_update(float* params, const float* grads, float* m, float* v, std::size_t n,
+                 const AdamStep& step) {
+    const __m256 beta1 = _mm256_set1_ps(step.beta1);
+    const __m256 beta2 = _mm256_set1_ps(step.beta2);
+    const __m256 c1 = _mm256_set1_ps(1.0f - step.beta1);
+    const __m256 c2 = _mm256_set1_ps(1.0f - step.beta2);
+    const __m256 step_size = _mm256_set1_ps(step.step_size);
+    const __m256 eps = _mm256_set1_ps(step.epsilon);
+
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        __m256 g = _mm256_loadu_ps(grads + i);
+        __m256 mi = _mm256_fmadd_ps(c1, g, _mm256_mul_ps(beta1, _mm256_loadu_ps(m + i)));
+        __m256 vi = _mm256_fmadd_ps(_mm256_mul_ps(c2, g), g,
+                                    _mm256_mul_ps(beta2, _mm256_loadu_ps(v + i)));
+        __m256 denom = _mm256_add_ps(_mm256_sqrt_ps(vi), eps);
+        __m256 p = _mm256_fnmadd_ps(step_size, _mm256_div_ps(mi, denom),
+                                    _mm256_loadu_ps(params + i));
+        _mm256_storeu_ps(m + i, mi);
+        _mm256_storeu_ps(v + i, vi);
+        _mm256_storeu_ps(params + i, p);
+    }
+    for (; i < n; ++i) {
+        float g = grads[i];
+        m[i] = step.beta1 * m[i] + (1.0f - step.beta1) * g;
+        v[i] = step.beta2 * v[i] + (1.0f - step.beta2) * g * g;
+        float root = _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(v[i])));
+        params[i] -= step.step_size * m[i] / (root + step.epsilon);
+    }
+}
+
+void polyak_update(float* target, const float* source, std::size_t n, float tau) {
+    const __m256 t = _mm256_set1_ps(tau);
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        __m256 dst = _mm256_loadu_ps(target + i);
+        __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(source + i), dst);
+        _mm256_storeu_ps(target + i, _mm256_fmadd_ps(t, diff, dst));
+    }
+    for (; i < n; ++i) {
+        target[i] += tau * (source[i] - target[i]);
+    }
+}
+
+// int8 rows widened to fp32 eight at a time
+inline __m256 load_int8(const std::int8_t* p) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+}
+
+// Narrow quantized layers: dequantize a block of kLanes rows into a transposed fp32 tile once,
+// then proceed like forward_narrow
+void quantized_forward_narrow(const std::int8_t* w, const float* scales, const float* b,
+                              const float* x, float* y, int batch, int in, int out,
+                              bool relu_out) {
+    alignas(32) float wt[kLanes][kLanes];
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (int o0 = 0; o0 < out; o0 += kLanes) {
+        const int lanes = out - o0 < kLanes ? out - o0 : kLanes;
+        alignas(32) float bias[kLanes] = {};
+        for (int r = 0; r < lanes; ++r) {
+            bias[r] = b[o0 + r];
+        }
+        for (int k = 0; k < in; ++k) {
+            for (int r = 0; r < kLanes; ++r) {
+                wt[k][r] = r < lanes ? scales[o0 + r] *
+                                           w[static_cast<std::ptrdiff_t>(o0 + r) * in + k]
+                                     : 0.0f;
+            }
+        }
+        for (int s = 0; s < batch; ++s) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            __m256 acc = _mm256_load_ps(bias);
+            for (int k = 0; k < in; ++k) {
+                acc = _mm256_fmadd_ps(_mm256_set1_ps(xs[k]), _mm256_load_ps(wt[k]), acc);
+            }
+            if (relu_out) {
+                acc = _mm256_max_ps(acc, zero);
+            }
+            alignas(32) float result[kLanes];
+            _mm256_store_ps(result, acc);
+            float* ys = y + static_cast<std::ptrdiff_t>(s) * out + o0;
+            for (int r = 0; r < lanes; ++r) {
+                ys[r] = result[r];
+            }
+        }
+    }
+}
+
+// Samples per tile in the quantized kernel: twice kBatchTile, so each widened weight block
+// feeds enough FMAs to hide the int8 -> fp32 conversion
+constexpr int kQuantizedTile = 2 * kBatchTile;
+
+// Wide quantized layers: like forward_wide, widening each int8 weight block once per tile
+void quantized_forward_wide(const std::int8_t* w, const float* scales, const float* b,
+                            const float* x, float* y, int batch, int in, int out,
+                            bool relu_out) {
+    const int vec_end = in - in % kLanes;
+
+    int s = 0;
+    for (; s + kQuantizedTile <= batch; s += kQuantizedTile) {
+        const float* xt[kQuantizedTile];
+        for (int t = 0; t < kQuantizedTile; ++t) {
+            xt[t] = x + static_cast<std::ptrdiff_t>(s + t) * in;
+        }
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m256 acc[kQuantizedTile];
+            for (int t = 0; t < kQuantizedTile; ++t) {
+                acc[t] = _mm256_setzero_ps();
+            }
+            for (int k = 0; k < vec_end; k += kLanes) {
+                __m256 wv = load_int8(wo + k);
+                for (int t = 0; t < kQuantizedTile; ++t) {
+                    acc[t] = _mm256_fmadd_ps(wv, _mm256_loadu_ps(xt[t] + k), acc[t]);
+                }
+            }
+            const float scale = scales[o];
+            for (int t = 0; t < kQuantizedTile; ++t) {
+                float sum = hsum(acc[t]);
+                for (int k = vec_end; k < in; ++k) {
+                    sum += static_cast<float>(wo[k]) * xt[t][k];
+                }
+                sum = sum * scale + b[o];
+                y0[t * out + o] = relu_out ? relu(sum) : sum;
+            }
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                acc = _mm256_fmadd_ps(load_int8(wo + k), _mm256_loadu_ps(xs + k), acc);
+            }
+            float sum = hsum(acc);
+            for (int k = vec_end; k < in; ++k) {
+                sum += static_cast<float>(wo[k]) * xs[k];
+            }
+            sum = sum * scales[o] + b[o];
+            ys[o] = relu_out ? relu(sum) : sum;
+        }
+    }
+}
+
+void quantized_dense_forward(const std::int8_t* w, const float* scales, const float* b,
+                             const float* x, float* y, int batch, int in, int out,
+                             bool relu_out) {
+    if (in < kLanes) {
+        quantized_forward_narrow(w, scales, b, x, y, batch, in, out, relu_out);
+    } else {
+        quantized_forward_wide(w, scales, b, x, y, batch, in, out, relu_out);
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable avx2_kernels;
+const KernelTable avx2_kernels = {
+    "avx2",
+    dense_forward,
+    dense_backward_params,
+    dense_backward_input,
+    adam_update,
+    polyak_update,
+    quantized_dense_forward,
+    detail::make_fixed_kernels<dense_forward, dense_backward_params,
+                               dense_backward_input>(),
+};
+} // namespace detail
+
+} // namespace kernels
+} // namespace rl_dqn
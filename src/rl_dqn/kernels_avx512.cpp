@@ -0,0 +1,370 @@
+// AVX-512F dense kernels. Same rules as kernels_avx2.cpp: compiled with -mavx512f, entered only
+// after runtime detection, and free of inline library code.
+#include "rl_dqn/kernels.h"
+
+// GCC 12 reports the deliberately undefined pass-through operand inside max/reduce intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace rl_dqn {
+namespace kernels {
+
+namespace {
+
+constexpr int kLanes = 16;
+constexpr int kBatchTile = 4;
+
+// Mask selecting the first n (< kLanes) lanes
+inline __mmask16 tail_mask(int n) {
+    return static_cast<__mmask16>((1u << n) - 1u);
+}
+
+// Narrow layers: transpose a block of kLanes weight rows once, then every sample is
+// `in` broadcast-FMAs producing kLanes outputs
+void forward_narrow(const float* w, const float* b, const float* x, float* y,
+                    int batch, int in, int out, bool relu_out) {
+    alignas(64) float wt[kLanes][kLanes];
+    const __m512 zero = _mm512_setzero_ps();
+
+    for (int o0 = 0; o0 < out; o0 += kLanes) {
+        const int lanes = out - o0 < kLanes ? out - o0 : kLanes;
+        const __mmask16 mask = lanes == kLanes ? static_cast<__mmask16>(0xFFFF) : tail_mask(lanes);
+        for (int k = 0; k < in; ++k) {
+            for (int r = 0; r < lanes; ++r) {
+                wt[k][r] = w[static_cast<std::ptrdiff_t>(o0 + r) * in + k];
+            }
+            for (int r = lanes; r < kLanes; ++r) {
+                wt[k][r] = 0.0f;
+            }
+        }
+        const __m512 bias = _mm512_maskz_loadu_ps(mask, b + o0);
+        for (int s = 0; s < batch; ++s) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            __m512 acc = bias;
+            for (int k = 0; k < in; ++k) {
+                acc = _mm512_fmadd_ps(_mm512_set1_ps(xs[k]), _mm512_load_ps(wt[k]), acc);
+            }
+            if (relu_out) {
+                acc = _mm512_max_ps(acc, zero);
+            }
+            _mm512_mask_storeu_ps(y + static_cast<std::ptrdiff_t>(s) * out + o0, mask, acc);
+        }
+    }
+}
+
+inline float finish(__m512 acc, float bias, bool relu_out) {
+    float v = _mm512_reduce_add_ps(acc) + bias;
+    return relu_out && v < 0.0f ? 0.0f : v;
+}
+
+// Wide layers: each weight row is dotted against kBatchTile samples at once, tails masked
+void forward_wide(const float* w, const float* b, const float* x, float* y,
+                  int batch, int in, int out, bool relu_out) {
+    const int vec_end = in - in % kLanes;
+    const __mmask16 rest = tail_mask(in - vec_end);
+
+    int s = 0;
+    for (; s + kBatchTile <= batch; s += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(s) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m512 a0 = _mm512_setzero_ps();
+            __m512 a1 = _mm512_setzero_ps();
+            __m512 a2 = _mm512_setzero_ps();
+            __m512 a3 = _mm512_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                __m512 wv = _mm512_loadu_ps(wo + k);
+                a0 = _mm512_fmadd_ps(wv, _mm512_loadu_ps(x0 + k), a0);
+                a1 = _mm512_fmadd_ps(wv, _mm512_loadu_ps(x1 + k), a1);
+                a2 = _mm512_fmadd_ps(wv, _mm512_loadu_ps(x2 + k), a2);
+                a3 = _mm512_fmadd_ps(wv, _mm512_loadu_ps(x3 + k), a3);
+            }
+            if (rest) {
+                __m512 wv = _mm512_maskz_loadu_ps(rest, wo + vec_end);
+                a0 = _mm512_fmadd_ps(wv, _mm512_maskz_loadu_ps(rest, x0 + vec_end), a0);
+                a1 = _mm512_fmadd_ps(wv, _mm512_maskz_loadu_ps(rest, x1 + vec_end), a1);
+                a2 = _mm512_fmadd_ps(wv, _mm512_maskz_loadu_ps(rest, x2 + vec_end), a2);
+                a3 = _mm512_fmadd_ps(wv, _mm512_maskz_loadu_ps(rest, x3 + vec_end), a3);
+            }
+            y0[o] = finish(a0, b[o], relu_out);
+            y0[o + out] = finish(a1, b[o], relu_out);
+            y0[o + 2 * out] = finish(a2, b[o], relu_out);
+            y0[o + 3 * out] = finish(a3, b[o], relu_out);
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m512 acc = _mm512_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(wo + k), _mm512_loadu_ps(xs + k), acc);
+            }
+            if (rest) {
+                acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(rest, wo + vec_end),
+                                      _mm512_maskz_loadu_ps(rest, xs + vec_end), acc);
+            }
+            ys[o] = finish(acc, b[o], relu_out);
+        }
+    }
+}
+
+void dense_forward(const float* w, const float* b, const float* x, float* y,
+                   int batch, int in, int out, bool relu_out) {
+    if (in < kLanes) {
+        forward_narrow(w, b, x, y, batch, in, out, relu_out);
+    } else {
+        forward_wide(w, b, x, y, batch, in, out, relu_out);
+    }
+}
+
+// acc[0..n) += d * x[0..n)
+inline void axpy(float d, const float* x, float* acc, int n) {
+    const __m512 dv = _mm512_set1_ps(d);
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        _mm512_storeu_ps(acc + k, _mm512_fmadd_ps(dv, _mm512_loadu_ps(x + k),
+                                                  _mm512_loadu_ps(acc + k)));
+    }
+    if (k < n) {
+        const __mmask16 m = tail_mask(n - k);
+        _mm512_mask_storeu_ps(acc + k, m, _mm512_fmadd_ps(dv, _mm512_maskz_loadu_ps(m, x + k),
+                                                          _mm512_maskz_loadu_ps(m, acc + k)));
+    }
+}
+
+inline void zero(float* p, int n) {
+    const __m512 z = _mm512_setzero_ps();
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        _mm512_storeu_ps(p + k, z);
+    }
+    if (k < n) {
+        _mm512_mask_storeu_ps(p + k, tail_mask(n - k), z);
+    }
+}
+
+void dense_backward_params(const float* x, const float* dy, float* dw, float* db,
+                           int batch, int in, int out) {
+    for (int o = 0; o < out; ++o) {
+        float* dw_row = dw + static_cast<std::ptrdiff_t>(o) * in;
+        float bias_sum = 0.0f;
+        for (int s = 0; s < batch; ++s) {
+            float d = dy[static_cast<std::ptrdiff_t>(s) * out + o];
+            if (d == 0.0f) {
+                continue;
+            }
+            bias_sum += d;
+            axpy(d, x + static_cast<std::ptrdiff_t>(s) * in, dw_row, in);
+        }
+        db[o] += bias_sum;
+    }
+}
+
+void dense_backward_input(const float* w, const float* x, const float* dy, float* dx,
+                          int batch, int in, int out, bool relu_mask) {
+    const __m512 zero_v = _mm512_setzero_ps();
+    for (int s = 0; s < batch; ++s) {
+        float* dxs = dx + static_cast<std::ptrdiff_t>(s) * in;
+        const float* dys = dy + static_cast<std::ptrdiff_t>(s) * out;
+        zero(dxs, in);
+        for (int o = 0; o < out; ++o) {
+            if (dys[o] != 0.0f) {
+                axpy(dys[o], w + static_cast<std::ptrdiff_t>(o) * in, dxs, in);
+            }
+        }
+        if (relu_mask) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            for (int k = 0; k < in; k += kLanes) {
+                const __mmask16 m =
+                    in - k < kLanes ? tail_mask(in - k) : static_cast<__mmask16>(0xFFFF);
+                __mmask16 keep = _mm512_mask_cmp_ps_mask(m, _mm512_maskz_loadu_ps(m, xs + k),
+                                                         zero_v, _CMP_GT_OQ);
+                _mm512_mask_storeu_ps(dxs + k, m, _mm512_maskz_loadu_ps(keep, dxs + k));
+            }
+        }
+    }
+}
+
+void adam_update(float* params, const float* grads, float* m, float* v, std::size_t n,
+                 const AdamStep& step) {
+    const __m512 beta1 = _mm512_set1_ps(step.beta1);
+    const __m512 beta2 = _mm512_set1_ps(step.beta2);
+    const __m512 c1 = _mm512_set1_ps(1.0f - step.beta1);
+    const __m512 c2 = _mm512_set1_ps(1.0f - step.beta2);
+    const __m512 step_size = _mm512_set1_ps(step.step_size);
+    const __m512 eps = _mm512_set1_ps(step.epsilon);
+
+    for (std::size_t i = 0; i < n; i += kLanes) {
+        const __mmask16 mask = n - i < static_cast<std::size_t>(kLanes)
+                                   ? tail_mask(static_cast<int>(n - i))
+                                   : static_cast<__mmask16>(0xFFFF);
+        __m512 g = _mm512_maskz_loadu_ps(mask, grads + i);
+        __m512 mi = _mm512_fmadd_ps(c1, g,
+                                    _mm512_mul_ps(beta1, _mm512_maskz_loadu_ps(mask, m + i)));
+        __m512 vi = _mm512_fmadd_ps(_mm512_mul_ps(c2, g), g,
+                                    _mm512_mul_ps(beta2, _mm512_maskz_loadu_ps(mask, v + i)));
+        __m512 denom = _mm512_add_ps(_mm512_sqrt_ps(vi), eps);
+        __m512 p = _mm512_fnmadd_ps(step_size, _mm512_div_ps(mi, denom),
+                                    _mm512_maskz_loadu_ps(mask, params + i));
+        _mm512_mask_storeu_ps(m + i, mask, mi);
+        _mm512_mask_storeu_ps(v + i, mask, vi);
+        _mm512_mask_storeu_ps(params + i, mask, p);
+    }
+}
+
+void polyak_update(float* target, const float* source, std::size_t n, float tau) {
+    const __m512 t = _mm512_set1_ps(tau);
+    for (std::size_t i = 0; i < n; i += kLanes) {
+        const __mmask16 mask = n - i < static_cast<std::size_t>(kLanes)
+                                   ? tail_mask(static_cast<int>(n - i))
+                                   : static_cast<__mmask16>(0xFFFF);
+        __m512 dst = _mm512_maskz_loadu_ps(mask, target + i);
+        __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, source + i), dst);
+        _mm512_mask_storeu_ps(target + i, mask, _mm512_fmadd_ps(t, diff, dst));
+    }
+}
+
+// int8 rows widened to fp32 sixteen at a time
+inline __m512 load_int8(const std::int8_t* p) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(bytes));
+}
+
+// Narrow quantized layers: dequantize a block of kLanes rows into a transposed fp32 tile once,
+// then proceed like forward_narrow
+void quantized_forward_narrow(const std::int8_t* w, const float* scales, const float* b,
+                              const float* x, float* y, int batch, int in, int out,
+                              bool relu_out) {
+    alignas(64) float wt[kLanes][kLanes];
+    const __m512 zero = _mm512_setzero_ps();
+
+    for (int o0 = 0; o0 < out; o0 += kLanes) {
+        const int lanes = out - o0 < kLanes ? out - o0 : kLanes;
+        const __mmask16 mask = lanes == kLanes ? static_cast<__mmask16>(0xFFFF) : tail_mask(lanes);
+        for (int k = 0; k < in; ++k) {
+            for (int r = 0; r < lanes; ++r) {
+                wt[k][r] = scales[o0 + r] * w[static_cast<std::ptrdiff_t>(o0 + r) * in + k];
+            }
+            for (int r = lanes; r < kLanes; ++r) {
+                wt[k][r] = 0.0f;
+            }
+        }
+        const __m512 bias = _mm512_maskz_loadu_ps(mask, b + o0);
+        for (int s = 0; s < batch; ++s) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            __m512 acc = bias;
+            for (int k = 0; k < in; ++k) {
+                acc = _mm512_fmadd_ps(_mm512_set1_ps(xs[k]), _mm512_load_ps(wt[k]), acc);
+            }
+            if (relu_out) {
+                acc = _mm512_max_ps(acc, zero);
+            }
+            _mm512_mask_storeu_ps(y + static_cast<std::ptrdiff_t>(s) * out + o0, mask, acc);
+        }
+    }
+}
+
+inline float finish_quantized(__m512 acc, float tail, float scale, float bias, bool relu_out) {
+    float v = (_mm512_reduce_add_ps(acc) + tail) * scale + bias;
+    return relu_out && v < 0.0f ? 0.0f : v;
+}
+
+// Samples per tile in the quantized kernel: twice kBatchTile, so each widened weight block
+// feeds enough FMAs to hide the int8 -> fp32 conversion
+constexpr int kQuantizedTile = 2 * kBatchTile;
+
+// Wide quantized layers: like forward_wide, widening each int8 weight block once per tile.
+// Widening loads are not maskable without AVX-512BW, so row tails are finished in scalar code.
+void quantized_forward_wide(const std::int8_t* w, const float* scales, const float* b,
+                            const float* x, float* y, int batch, int in, int out,
+                            bool relu_out) {
+    const int vec_end = in - in % kLanes;
+
+    int s = 0;
+    for (; s + kQuantizedTile <= batch; s += kQuantizedTile) {
+        const float* xt[kQuantizedTile];
+        for (int t = 0; t < kQuantizedTile; ++t) {
+            xt[t] = x + static_cast<std::ptrdiff_t>(s + t) * in;
+        }
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m512 acc[kQuantizedTile];
+            for (int t = 0; t < kQuantizedTile; ++t) {
+                acc[t] = _mm512_setzero_ps();
+            }
+            for (int k = 0; k < vec_end; k += kLanes) {
+                __m512 wv = load_int8(wo + k);
+                for (int t = 0; t < kQuantizedTile; ++t) {
+                    acc[t] = _mm512_fmadd_ps(wv, _mm512_loadu_ps(xt[t] + k), acc[t]);
+                }
+            }
+            for (int t = 0; t < kQuantizedTile; ++t) {
+                float tail = 0.0f;
+                for (int k = vec_end; k < in; ++k) {
+                    tail += static_cast<float>(wo[k]) * xt[t][k];
+                }
+                y0[t * out + o] = finish_quantized(acc[t], tail, scales[o], b[o], relu_out);
+            }
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            __m512 acc = _mm512_setzero_ps();
+            for (int k = 0; k < vec_end; k += kLanes) {
+                acc = _mm512_fmadd_ps(load_int8(wo + k), _mm512_loadu_ps(xs + k), acc);
+            }
+            float tail = 0.0f;
+            for (int k = vec_end; k < in; ++k) {
+                tail += static_cast<float>(wo[k]) * xs[k];
+            }
+            ys[o] = finish_quantized(acc, tail, scales[o], b[o], relu_out);
+        }
+    }
+}
+
+void quantized_dense_forward(const std::int8_t* w, const float* scales, const float* b,
+                             const float* x, float* y, int batch, int in, int out,
+                             bool relu_out) {
+    if (in < kLanes) {
+        quantized_forward_narrow(w, scales, b, x, y, batch, in, out, relu_out);
+    } else {
+        quantized_forward_wide(w, scales, b, x, y, batch, in, out, relu_out);
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable avx512_kernels;
+const KernelTable avx512_kernels = {
+    "avx512",
+    dense_forward,
+    dense_backward_params,
+    dense_backward_input,
+    adam_update,
+    polyak_update,
+    quantized_dense_forward,
+    detail::make_fixed_kernels<dense_forward, dense_backward_params,
+                               dense_backward_input>(),
+};
+} // namespace detail
+
+} // namespace kernels
+} // namespace rl_dqn
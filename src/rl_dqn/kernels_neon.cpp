@@ -0,0 +1,285 @@
+// NEON dense kernels for AArch64, where Advanced SIMD is always available.
+#include "rl_dqn/kernels.h"
+#include <arm_neon.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rl_dqn {
+namespace kernels {
+
+namespace {
+
+constexpr int kLanes = 4;
+constexpr int kBatchTile = 4;
+
+inline float relu(float v) {
+    return v > 0.0f ? v : 0.0f;
+}
+
+void dense_forward(const float* w, const float* b, const float* x, float* y,
+                   int batch, int in, int out, bool relu_out) {
+    const int vec_end = in - in % kLanes;
+
+    int s = 0;
+    for (; s + kBatchTile <= batch; s += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(s) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float32x4_t a0 = vdupq_n_f32(0.0f);
+            float32x4_t a1 = vdupq_n_f32(0.0f);
+            float32x4_t a2 = vdupq_n_f32(0.0f);
+            float32x4_t a3 = vdupq_n_f32(0.0f);
+            for (int k = 0; k < vec_end; k += kLanes) {
+                float32x4_t wv = vld1q_f32(wo + k);
+                a0 = vfmaq_f32(a0, wv, vld1q_f32(x0 + k));
+                a1 = vfmaq_f32(a1, wv, vld1q_f32(x1 + k));
+                a2 = vfmaq_f32(a2, wv, vld1q_f32(x2 + k));
+                a3 = vfmaq_f32(a3, wv, vld1q_f32(x3 + k));
+            }
+            float s0 = vaddvq_f32(a0), s1 = vaddvq_f32(a1);
+            float s2 = vaddvq_f32(a2), s3 = vaddvq_f32(a3);
+            for (int k = vec_end; k < in; ++k) {
+                s0 += wo[k] * x0[k];
+                s1 += wo[k] * x1[k];
+                s2 += wo[k] * x2[k];
+                s3 += wo[k] * x3[k];
+            }
+            s0 += b[o];
+            s1 += b[o];
+            s2 += b[o];
+            s3 += b[o];
+            y0[o] = relu_out ? relu(s0) : s0;
+            y0[o + out] = relu_out ? relu(s1) : s1;
+            y0[o + 2 * out] = relu_out ? relu(s2) : s2;
+            y0[o + 3 * out] = relu_out ? relu(s3) : s3;
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const float* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (int k = 0; k < vec_end; k += kLanes) {
+                acc = vfmaq_f32(acc, vld1q_f32(wo + k), vld1q_f32(xs + k));
+            }
+            float sum = vaddvq_f32(acc);
+            for (int k = vec_end; k < in; ++k) {
+                sum += wo[k] * xs[k];
+            }
+            sum += b[o];
+            ys[o] = relu_out ? relu(sum) : sum;
+        }
+    }
+}
+
+// acc[0..n) += d * x[0..n)
+inline void axpy(float d, const float* x, float* acc, int n) {
+    const float32x4_t dv = vdupq_n_f32(d);
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        vst1q_f32(acc + k, vfmaq_f32(vld1q_f32(acc + k), dv, vld1q_f32(x + k)));
+    }
+    for (; k < n; ++k) {
+        acc[k] += d * x[k];
+    }
+}
+
+inline void zero(float* p, int n) {
+    const float32x4_t z = vdupq_n_f32(0.0f);
+    int k = 0;
+    for (; k + kLanes <= n; k += kLanes) {
+        vst1q_f32(p + k, z);
+    }
+    for (; k < n; ++k) {
+        p[k] = 0.0f;
+    }
+}
+
+void dense_backward_params(const float* x, const float* dy, float* dw, float* db,
+                           int batch, int in, int out) {
+    for (int o = 0; o < out; ++o) {
+        float* dw_row = dw + static_cast<std::ptrdiff_t>(o) * in;
+        float bias_sum = 0.0f;
+        for (int s = 0; s < batch; ++s) {
+            float d = dy[static_cast<std::ptrdiff_t>(s) * out + o];
+            if (d == 0.0f) {
+                continue;
+            }
+            bias_sum += d;
+            axpy(d, x + static_cast<std::ptrdiff_t>(s) * in, dw_row, in);
+        }
+        db[o] += bias_sum;
+    }
+}
+
+void dense_backward_input(const float* w, const float* x, const float* dy, float* dx,
+                          int batch, int in, int out, bool relu_mask) {
+    const float32x4_t zero_v = vdupq_n_f32(0.0f);
+    for (int s = 0; s < batch; ++s) {
+        float* dxs = dx + static_cast<std::ptrdiff_t>(s) * in;
+        const float* dys = dy + static_cast<std::ptrdiff_t>(s) * out;
+        zero(dxs, in);
+        for (int o = 0; o < out; ++o) {
+            if (dys[o] != 0.0f) {
+                axpy(dys[o], w + static_cast<std::ptrdiff_t>(o) * in, dxs, in);
+            }
+        }
+        if (relu_mask) {
+            const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+            int k = 0;
+            for (; k + kLanes <= in; k += kLanes) {
+                uint32x4_t keep = vcgtq_f32(vld1q_f32(xs + k), zero_v);
+                float32x4_t g = vld1q_f32(dxs + k);
+                vst1q_f32(dxs + k, vreinterpretq_f32_u32(
+                                       vandq_u32(vreinterpretq_u32_f32(g), keep)));
+            }
+            for (; k < in; ++k) {
+                dxs[k] = xs[k] > 0.0f ? dxs[k] : 0.0f;
+            }
+        }
+    }
+}
+
+void adam_update(float* params, const float* grads, float* m, float* v, std::size_t n,
+                 const AdamStep& step) {
+    const float32x4_t beta1 = vdupq_n_f32(step.beta1);
+    const float32x4_t beta2 = vdupq_n_f32(step.beta2);
+    const float32x4_t c1 = vdupq_n_f32(1.0f - step.beta1);
+    const float32x4_t c2 = vdupq_n_f32(1.0f - step.beta2);
+    const float32x4_t step_size = vdupq_n_f32(step.step_size);
+    const float32x4_t eps = vdupq_n_f32(step.epsilon);
+
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        float32x4_t g = vld1q_f32(grads + i);
+        float32x4_t mi = vfmaq_f32(vmulq_f32(beta1, vld1q_f32(m + i)), c1, g);
+        float32x4_t vi = vfmaq_f32(vmulq_f32(beta2, vld1q_f32(v + i)), vmulq_f32(c2, g), g);
+        float32x4_t denom = vaddq_f32(vsqrtq_f32(vi), eps);
+        float32x4_t p = vfmsq_f32(vld1q_f32(params + i), step_size, vdivq_f32(mi, denom));
+        vst1q_f32(m + i, mi);
+        vst1q_f32(v + i, vi);
+        vst1q_f32(params + i, p);
+    }
+    for (; i < n; ++i) {
+        float g = grads[i];
+        m[i] = step.beta1 * m[i] + (1.0f - step.beta1) * g;
+        v[i] = step.beta2 * v[i] + (1.0f - step.beta2) * g * g;
+        params[i] -= step.step_size * m[i] / (std::sqrt(v[i]) + step.epsilon);
+    }
+}
+
+void polyak_update(float* target, const float* source, std::size_t n, float tau) {
+    const float32x4_t t = vdupq_n_f32(tau);
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        float32x4_t dst = vld1q_f32(target + i);
+        float32x4_t diff = vsubq_f32(vld1q_f32(source + i), dst);
+        vst1q_f32(target + i, vfmaq_f32(dst, t, diff));
+    }
+    for (; i < n; ++i) {
+        target[i] += tau * (source[i] - target[i]);
+    }
+}
+
+// int8 rows widened to two fp32 vectors eight at a time
+inline void load_int8(const std::int8_t* p, float32x4_t& lo, float32x4_t& hi) {
+    int16x8_t wide = vmovl_s8(vld1_s8(p));
+    lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(wide)));
+    hi = vcvtq_f32_s32(vmovl_high_s16(wide));
+}
+
+void quantized_dense_forward(const std::int8_t* w, const float* scales, const float* b,
+                             const float* x, float* y, int batch, int in, int out,
+                             bool relu_out) {
+    constexpr int kBlock = 2 * kLanes;
+    const int vec_end = in - in % kBlock;
+
+    int s = 0;
+    for (; s + kBatchTile <= batch; s += kBatchTile) {
+        const float* x0 = x + static_cast<std::ptrdiff_t>(s) * in;
+        const float* x1 = x0 + in;
+        const float* x2 = x1 + in;
+        const float* x3 = x2 + in;
+        float* y0 = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float32x4_t a0 = vdupq_n_f32(0.0f);
+            float32x4_t a1 = vdupq_n_f32(0.0f);
+            float32x4_t a2 = vdupq_n_f32(0.0f);
+            float32x4_t a3 = vdupq_n_f32(0.0f);
+            for (int k = 0; k < vec_end; k += kBlock) {
+                float32x4_t lo, hi;
+                load_int8(wo + k, lo, hi);
+                a0 = vfmaq_f32(vfmaq_f32(a0, lo, vld1q_f32(x0 + k)), hi, vld1q_f32(x0 + k + 4));
+                a1 = vfmaq_f32(vfmaq_f32(a1, lo, vld1q_f32(x1 + k)), hi, vld1q_f32(x1 + k + 4));
+                a2 = vfmaq_f32(vfmaq_f32(a2, lo, vld1q_f32(x2 + k)), hi, vld1q_f32(x2 + k + 4));
+                a3 = vfmaq_f32(vfmaq_f32(a3, lo, vld1q_f32(x3 + k)), hi, vld1q_f32(x3 + k + 4));
+            }
+            float s0 = vaddvq_f32(a0), s1 = vaddvq_f32(a1);
+            float s2 = vaddvq_f32(a2), s3 = vaddvq_f32(a3);
+            for (int k = vec_end; k < in; ++k) {
+                float wk = static_cast<float>(wo[k]);
+                s0 += wk * x0[k];
+                s1 += wk * x1[k];
+                s2 += wk * x2[k];
+                s3 += wk * x3[k];
+            }
+            const float scale = scales[o];
+            s0 = s0 * scale + b[o];
+            s1 = s1 * scale + b[o];
+            s2 = s2 * scale + b[o];
+            s3 = s3 * scale + b[o];
+            y0[o] = relu_out ? relu(s0) : s0;
+            y0[o + out] = relu_out ? relu(s1) : s1;
+            y0[o + 2 * out] = relu_out ? relu(s2) : s2;
+            y0[o + 3 * out] = relu_out ? relu(s3) : s3;
+        }
+    }
+    // Remaining samples one at a time
+    for (; s < batch; ++s) {
+        const float* xs = x + static_cast<std::ptrdiff_t>(s) * in;
+        float* ys = y + static_cast<std::ptrdiff_t>(s) * out;
+        for (int o = 0; o < out; ++o) {
+            const std::int8_t* wo = w + static_cast<std::ptrdiff_t>(o) * in;
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (int k = 0; k < vec_end; k += kBlock) {
+                float32x4_t lo, hi;
+                load_int8(wo + k, lo, hi);
+                acc = vfmaq_f32(vfmaq_f32(acc, lo, vld1q_f32(xs + k)), hi, vld1q_f32(xs + k + 4));
+            }
+            float sum = vaddvq_f32(acc);
+            for (int k = vec_end; k < in; ++k) {
+                sum += static_cast<float>(wo[k]) * xs[k];
+            }
+            sum = sum * scales[o] + b[o];
+            ys[o] = relu_out ? relu(sum) : sum;
+        }
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable neon_kernels;
+const KernelTable neon_kernels = {
+    "neon",
+    dense_forward,
+    dense_backward_params,
+    dense_backward_input,
+    adam_update,
+    polyak_update,
+    quantized_dense_forward,
+    detail::make_fixed_kernels<dense_forward, dense_backward_params,
+                               dense_backward_input>(),
+};
+} // namespace detail
+
+} // namespace kernels
+} // namespace rl_dqn
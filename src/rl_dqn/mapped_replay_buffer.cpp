@@ -0,0 +1,293 @@
+#include "rl_dqn/mapped_replay_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'L', 'P', 'Y', 'R', 'P', 'L', 'Y'};
+
+static_assert(sizeof(ReplaySegmentHeader) <= kReplaySegmentHeaderSize,
+              "Header outgrew its slot");
+static_assert(kReplaySegmentHeaderSize % alignof(ReplayRecord) == 0,
+              "Records must stay aligned in the mapping");
+
+std::size_t whole_segments(std::size_t capacity, std::size_t segment_records) {
+    if (capacity == 0 || segment_records == 0) {
+        throw std::invalid_argument("Replay capacity and segment size must be positive");
+    }
+    return (capacity + segment_records - 1) / segment_records;
+}
+
+ReplayRecord to_record(const Experience& e) {
+    ReplayRecord record{};
+    write_observation(e.state, record.state);
+    write_observation(e.next_state, record.next_state);
+    record.reward = e.reward;
+    record.action = static_cast<std::uint8_t>(e.action);
+    record.done = e.done ? 1 : 0;
+    return record;
+}
+
+// A mapped segment file with its validated header
+struct SegmentFile {
+    core::MappedFile file;
+    ReplaySegmentHeader header;
+};
+
+SegmentFile open_segment(const std::string& path, std::size_t segment_records) {
+    SegmentFile segment{core::MappedFile(path), {}};
+    if (segment.file.size() < kReplaySegmentHeaderSize) {
+        throw std::runtime_error("Not a replay segment (too small): " + path);
+    }
+    ReplaySegmentHeader& header = segment.header;
+    std::memcpy(&header, segment.file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a replay segment (bad magic): " + path);
+    }
+    if (header.version != kReplaySegmentVersion || header.record_bytes != sizeof(ReplayRecord)) {
+        throw std::runtime_error("Unsupported replay segment version: " + path);
+    }
+    if (header.capacity != segment_records) {
+        throw std::runtime_error("Replay segment holds " + std::to_string(header.capacity) +
+                                 " records, expected " + std::to_string(segment_records) +
+                                 ": " + path);
+    }
+    if (header.count > header.capacity ||
+        segment.file.size() != kReplaySegmentHeaderSize + header.count * sizeof(ReplayRecord)) {
+        throw std::runtime_error("Truncated replay segment: " + path);
+    }
+    return segment;
+}
+
+} // namespace
+
+MappedReplayBuffer::MappedReplayBuffer(const std::string& directory, std::size_t capacity,
+                                       std::size_t segment_records, std::uint64_t seed)
+    : ReplayBuffer(whole_segments(capacity, segment_records) * segment_records, seed,
+                   ExternalStorage{}),
+      directory_(directory),
+      segment_records_(segment_records),
+      segments_(whole_segments(capacity, segment_records)) {
+    tail_.reserve(segment_records_);
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        throw std::runtime_error("Cannot create " + directory_ + ": " + error.message());
+    }
+    load();
+}
+
+MappedReplayBuffer::~MappedReplayBuffer() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Nothing to report to from a destructor; the sealed segments are intact
+    }
+}
+
+std::string MappedReplayBuffer::segment_path(std::uint64_t sequence) const {
+    std::string name = std::to_string(sequence);
+    name.insert(0, name.size() < 12 ? 12 - name.size() : 0, '0');
+    return (std::filesystem::path(directory_) / ("segment_" + name + ".replay")).string();
+}
+
+void MappedReplayBuffer::load() {
+    // Every segment in the directory, oldest first
+    std::vector<SegmentFile> found;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("segment_") &&
+            entry.path().extension() == ".replay") {
+            found.push_back(open_segment(entry.path().string(), segment_records_));
+        }
+    }
+    std::sort(found.begin(), found.end(), [](const SegmentFile& a, const SegmentFile& b) {
+        return a.header.sequence < b.header.sequence;
+    });
+
+    // Only the newest segment may be partial: it becomes the tail again
+    bool has_tail = !found.empty() && found.back().header.count < segment_records_;
+    std::size_t sealed = found.size() - (has_tail ? 1 : 0);
+    for (std::size_t i = 0; i < sealed; ++i) {
+        if (found[i].header.count != segment_records_) {
+            throw std::runtime_error("Partial replay segment before the newest: " +
+                                     segment_path(found[i].header.sequence));
+        }
+    }
+
+    // Keep the newest ring's worth of sealed segments
+    const std::size_t ring = segments_.size();
+    const std::size_t kept = std::min(sealed, ring);
+    const std::size_t first = sealed - kept;
+    for (std::size_t i = 0; i < first; ++i) {
+        std::uint64_t sequence = found[i].header.sequence;
+        found[i].file = core::MappedFile();
+        std::filesystem::remove(segment_path(sequence));
+    }
+
+    // Segment s sits at ring position s % ring, as it did when it was written, so a resumed
+    // run samples the same slots. Files this layout cannot hold (a changed capacity, gaps)
+    // are packed from position 0 instead.
+    bool consecutive = true;
+    for (std::size_t i = first + 1; i < found.size(); ++i) {
+        consecutive = consecutive &&
+                      found[i].header.sequence == found[i - 1].header.sequence + 1;
+    }
+    const std::uint64_t first_sequence = found.empty() ? 0 : found[first].header.sequence;
+    const std::size_t offset =
+        consecutive && (kept == ring || first_sequence == 0) ? first_sequence % ring : 0;
+    for (std::size_t i = 0; i < kept; ++i) {
+        SegmentFile& file = found[first + i];
+        Segment& segment = segments_[(offset + i) % ring];
+        segment.file = std::move(file.file);
+        segment.sequence = file.header.sequence;
+    }
+
+    tail_position_ = (offset + kept) % ring;
+    tail_sequence_ = found.empty() ? 0 : found.back().header.sequence + (has_tail ? 0 : 1);
+    if (has_tail) {
+        const SegmentFile& file = found.back();
+        const auto* records =
+            reinterpret_cast<const ReplayRecord*>(file.file.data() + kReplaySegmentHeaderSize);
+        tail_.assign(records, records + file.header.count);
+    }
+
+    // A full ring means the tail is overwriting the oldest segment
+    if (kept == ring) {
+        restore(capacity(), tail_position_ * segment_records_ + tail_.size());
+    } else {
+        restore(kept * segment_records_ + tail_.size(), kept * segment_records_ + tail_.size());
+    }
+}
+
+void MappedReplayBuffer::push(const Experience& experience) {
+    claim_slot();  // always tail_position_ * segment_records_ + tail_.size()
+    tail_.push_back(to_record(experience));
+    if (tail_.size() == segment_records_) {
+        seal_tail();
+    }
+}
+
+void MappedReplayBuffer::write_tail() const {
+    ReplaySegmentHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kReplaySegmentVersion;
+    header.record_bytes = sizeof(ReplayRecord);
+    header.sequence = tail_sequence_;
+    header.capacity = segment_records_;
+    header.count = tail_.size();
+    char padded[kReplaySegmentHeaderSize] = {};
+    std::memcpy(padded, &header, sizeof(header));
+
+    // Write beside the target and rename, like checkpoints, so no reader sees a torn file
+    const std::string path = segment_path(tail_sequence_);
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot write " + tmp_path);
+        }
+        out.write(padded, sizeof(padded));
+        out.write(reinterpret_cast<const char*>(tail_.data()),
+                  static_cast<std::streamsize>(tail_.size() * sizeof(ReplayRecord)));
+        if (!out) {
+            throw std::runtime_error("Write failed: " + tmp_path);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp_path, path, error);
+    if (error) {
+        throw std::runtime_error("Cannot replace " + path + ": " + error.message());
+    }
+}
+
+void MappedReplayBuffer::seal_tail() {
+    write_tail();
+
+    // The sealed tail takes over its ring position; the segment it overwrote goes away
+    Segment& segment = segments_[tail_position_];
+    const bool replaced = segment.file.size() > 0;
+    const std::uint64_t replaced_sequence = segment.sequence;
+    segment.file = core::MappedFile(segment_path(tail_sequence_));
+    segment.sequence = tail_sequence_;
+    if (replaced) {
+        std::error_code error;
+        std::filesystem::remove(segment_path(replaced_sequence), error);
+    }
+
+    tail_.clear();
+    tail_position_ = (tail_position_ + 1) % segments_.size();
+    ++tail_sequence_;
+}
+
+void MappedReplayBuffer::flush() {
+    if (!tail_.empty()) {
+        write_tail();
+    }
+}
+
+const ReplayRecord& MappedReplayBuffer::record(std::size_t slot) const {
+    const std::size_t position = slot / segment_records_;
+    const std::size_t offset = slot % segment_records_;
+    if (position == tail_position_ && offset < tail_.size()) {
+        return tail_[offset];
+    }
+    return segments_[position].records()[offset];
+}
+
+Experience MappedReplayBuffer::at(std::size_t i) const {
+    const ReplayRecord& r = record(i);
+    Experience exp;
+    exp.state = read_observation(r.state);
+    exp.action = static_cast<env_flappy::Action>(r.action);
+    exp.reward = r.reward;
+    exp.next_state = read_observation(r.next_state);
+    exp.done = r.done != 0;
+    return exp;
+}
+
+void MappedReplayBuffer::sample(std::size_t batch_size, TransitionBatch& batch) const {
+    std::span<const std::size_t> slots = sample_indices(batch_size);
+    batch.resize(batch_size);
+
+    // Random record reads: each touches one 40-byte record, so only sampled pages load
+    constexpr std::size_t row_bytes = kObservationSize * sizeof(float);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        const ReplayRecord& r = record(slots[i]);
+        batch.slots[i] = slots[i];
+        std::memcpy(batch.states.data() + i * kObservationSize, r.state, row_bytes);
+        std::memcpy(batch.next_states.data() + i * kObservationSize, r.next_state, row_bytes);
+        batch.actions[i] = static_cast<env_flappy::Action>(r.action);
+        batch.rewards[i] = r.reward;
+        batch.dones[i] = r.done;
+    }
+    std::fill(batch.weights.begin(), batch.weights.end(), 1.0f);
+}
+
+void MappedReplayBuffer::clear() {
+    ReplayBuffer::clear();
+    for (Segment& segment : segments_) {
+        if (segment.file.size() > 0) {
+            segment.file = core::MappedFile();
+            std::filesystem::remove(segment_path(segment.sequence));
+        }
+    }
+    std::error_code error;
+    std::filesystem::remove(segment_path(tail_sequence_), error);  // a flushed tail
+    tail_.clear();
+    tail_position_ = 0;
+    tail_sequence_ = 0;
+}
+
+std::size_t MappedReplayBuffer::mapped_segments() const {
+    return static_cast<std::size_t>(std::count_if(
+        segments_.begin(), segments_.end(),
+        [](const Segment& segment) { return segment.file.size() > 0; }));
+}
+
+} // namespace rl_dqn
@@ -0,0 +1,45 @@
+#include "rl_dqn/n_step.h"
+#include <stdexcept>
+
+namespace rl_dqn {
+
+NStepAccumulator::NStepAccumulator(int n, float gamma) : gamma_(gamma) {
+    if (n < 1) {
+        throw std::invalid_argument("n-step length must be at least 1");
+    }
+    window_.resize(static_cast<std::size_t>(n));
+}
+
+void NStepAccumulator::push(const Experience& step, std::vector<Experience>& out) {
+    const std::size_t n = window_.size();
+    window_[(head_ + count_) % n] = step;
+    ++count_;
+
+    if (step.done) {
+        // Nothing to bootstrap from: every pending step becomes a terminal transition
+        while (count_ > 0) {
+            emit_oldest(step.next_state, true, out);
+        }
+        head_ = 0;
+    } else if (count_ == n) {
+        emit_oldest(step.next_state, false, out);
+    }
+}
+
+void NStepAccumulator::emit_oldest(const env_flappy::Observation& next_state, bool done,
+                                   std::vector<Experience>& out) {
+    const std::size_t n = window_.size();
+    float reward = 0.0f;
+    float discount = 1.0f;
+    for (std::size_t k = 0; k < count_; ++k) {
+        reward += discount * window_[(head_ + k) % n].reward;
+        discount *= gamma_;
+    }
+
+    const Experience& first = window_[head_];
+    out.push_back({first.state, first.action, reward, next_state, done});
+    head_ = (head_ + 1) % n;
+    --count_;
+}
+
+} // namespace rl_dqn
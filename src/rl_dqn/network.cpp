@@ -1,4 +1,5 @@
 #include "rl_dqn/network.h"
+#include "rl_dqn/kernels.h"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -8,39 +9,103 @@ namespace rl_dqn {
 
 Network::Network(const std::vector<int>& layer_sizes, std::uint64_t seed)
     : layer_sizes_(layer_sizes), rng_(static_cast<std::mt19937::result_type>(seed)) {
-    
+
     if (layer_sizes.size() < 2) {
         throw std::invalid_argument("Network needs at least input and output layers");
     }
-    
-    // Initialize weights and biases
-    weights_.resize(layer_sizes.size() - 1);
-    biases_.resize(layer_sizes.size() - 1);
-    
+
+    // Lay out every layer's weights and biases back to back in one buffer
+    std::size_t total = 0;
+    layer_offsets_.resize(layer_sizes.size() - 1);
     for (size_t i = 0; i < layer_sizes.size() - 1; ++i) {
-        int fan_in = layer_sizes[i];
-        int fan_out = layer_sizes[i + 1];
-        
-        // Initialize weights
-        weights_[i].resize(fan_out);
-        for (int j = 0; j < fan_out; ++j) {
-            weights_[i][j].resize(fan_in);
-            for (int k = 0; k < fan_in; ++k) {
-                weights_[i][j][k] = xavier_init(fan_in, fan_out);
-            }
+        if (layer_sizes[i] <= 0 || layer_sizes[i + 1] <= 0) {
+            throw std::invalid_argument("Layer sizes must be positive");
         }
-        
-        // Initialize biases to zero
-        biases_[i].resize(fan_out, 0.0f);
+        layer_offsets_[i] = total;
+        total += static_cast<std::size_t>(layer_sizes[i + 1]) * (layer_sizes[i] + 1);
     }
+
+    // Biases start at zero; weights are drawn below
+    params_.assign(total, 0.0f);
+    initialize_weights();
+}
+
+LayerView Network::layer(std::size_t index) {
+    int fan_in = layer_sizes_[index];
+    int fan_out = layer_sizes_[index + 1];
+    float* weights = params_.data() + layer_offsets_[index];
+    return {weights, weights + static_cast<std::size_t>(fan_out) * fan_in, fan_in, fan_out};
 }
 
-float Network::relu(float x) {
-    return std::max(0.0f, x);
+ConstLayerView Network::layer(std::size_t index) const {
+    int fan_in = layer_sizes_[index];
+    int fan_out = layer_sizes_[index + 1];
+    const float* weights = params_.data() + layer_offsets_[index];
+    return {weights, weights + static_cast<std::size_t>(fan_out) * fan_in, fan_in, fan_out};
+}
+
+void fold_input_transform(LayerView layer, std::span<const float> scale,
+                          std::span<const float> shift) {
+    if (scale.size() != static_cast<std::size_t>(layer.fan_in) ||
+        shift.size() != static_cast<std::size_t>(layer.fan_in)) {
+        throw std::invalid_argument("Input transform size mismatch");
+    }
+    // W (scale * x + shift) + b = (W diag(scale)) x + (W shift + b)
+    for (int i = 0; i < layer.fan_out; ++i) {
+        float* w = layer.row(i);
+        float bias = layer.biases[i];
+        for (int j = 0; j < layer.fan_in; ++j) {
+            bias += w[j] * shift[j];
+            w[j] *= scale[j];
+        }
+        layer.biases[i] = bias;
+    }
+}
+
+void unfold_input_gradients(std::span<const float> folded, std::span<const float> scale,
+                            std::span<const float> shift, int fan_out, float* dw, float* db) {
+    const std::size_t fan_in = scale.size();
+    const float* folded_db = folded.data() + static_cast<std::size_t>(fan_out) * fan_in;
+    for (int i = 0; i < fan_out; ++i) {
+        const float* row = folded.data() + static_cast<std::size_t>(i) * fan_in;
+        float* out = dw + static_cast<std::size_t>(i) * fan_in;
+        for (std::size_t j = 0; j < fan_in; ++j) {
+            out[j] += row[j] * scale[j] + folded_db[i] * shift[j];
+        }
+        db[i] += folded_db[i];
+    }
+}
+
+void Network::set_input_transform(std::span<const float> scale, std::span<const float> shift) {
+    if (scale.size() != static_cast<std::size_t>(layer_sizes_[0]) ||
+        shift.size() != scale.size()) {
+        throw std::invalid_argument("Input transform size mismatch");
+    }
+    input_scale_.assign(scale.begin(), scale.end());
+    input_shift_.assign(shift.begin(), shift.end());
+    refresh_input_transform();
+}
+
+void Network::refresh_input_transform() {
+    if (!has_input_transform()) {
+        return;
+    }
+    ConstLayerView first = layer(0);
+    const std::size_t weights = static_cast<std::size_t>(first.fan_out) * first.fan_in;
+    input_layer_.assign(first.weights, first.weights + weights + first.fan_out);
+    fold_input_transform({input_layer_.data(), input_layer_.data() + weights, first.fan_in,
+                          first.fan_out},
+                         input_scale_, input_shift_);
 }
 
-float Network::relu_derivative(float x) {
-    return x > 0.0f ? 1.0f : 0.0f;
+ConstLayerView Network::input_layer() const {
+    ConstLayerView first = layer(0);
+    if (!has_input_transform()) {
+        return first;
+    }
+    const float* weights = input_layer_.data();
+    return {weights, weights + static_cast<std::size_t>(first.fan_out) * first.fan_in,
+            first.fan_in, first.fan_out};
 }
 
 float Network::xavier_init(int fan_in, int fan_out) {
@@ -51,57 +116,34 @@ float Network::xavier_init(int fan_in, int fan_out) {
 }
 
 void Network::initialize_weights() {
-    // Already done in constructor, but kept for potential re-initialization
-    for (size_t i = 0; i < layer_sizes_.size() - 1; ++i) {
-        int fan_in = layer_sizes_[i];
-        int fan_out = layer_sizes_[i + 1];
-        
-        for (int j = 0; j < fan_out; ++j) {
-            for (int k = 0; k < fan_in; ++k) {
-                weights_[i][j][k] = xavier_init(fan_in, fan_out);
-            }
-        }
-    }
-}
-
-std::vector<float> Network::matvec_mult(const std::vector<std::vector<float>>& W,
-                                         const std::vector<float>& x) const {
-    std::vector<float> result(W.size(), 0.0f);
-    for (size_t i = 0; i < W.size(); ++i) {
-        for (size_t j = 0; j < x.size(); ++j) {
-            result[i] += W[i][j] * x[j];
+    // Row-major order matches the [neuron][weight] order the weights were always drawn in
+    for (size_t i = 0; i < num_layers(); ++i) {
+        LayerView view = layer(i);
+        std::size_t count = static_cast<std::size_t>(view.fan_out) * view.fan_in;
+        for (std::size_t k = 0; k < count; ++k) {
+            view.weights[k] = xavier_init(view.fan_in, view.fan_out);
         }
     }
-    return result;
 }
 
 std::vector<float> Network::forward(const std::vector<float>& input) const {
     if (static_cast<int>(input.size()) != layer_sizes_[0]) {
         throw std::invalid_argument("Input size mismatch");
     }
-    
+
+    const auto& k = kernels::active();
     std::vector<float> activations = input;
-    
-    // Forward through all layers
-    for (size_t layer = 0; layer < weights_.size(); ++layer) {
-        // Compute: z = W * x + b
-        std::vector<float> z = matvec_mult(weights_[layer], activations);
-        for (size_t i = 0; i < z.size(); ++i) {
-            z[i] += biases_[layer][i];
-        }
-        
-        // Apply activation (ReLU for hidden, linear for output)
-        if (layer < weights_.size() - 1) {
-            // Hidden layer: ReLU
-            for (float& val : z) {
-                val = relu(val);
-            }
-        }
-        // Output layer: linear (no activation)
-        
-        activations = z;
+    std::vector<float> z;
+
+    // Forward through all layers: z = W * x + b, ReLU for hidden, linear for output
+    for (size_t l = 0; l < num_layers(); ++l) {
+        ConstLayerView view = l == 0 ? input_layer() : layer(l);
+        z.resize(view.fan_out);
+        k.dense_forward(view.weights, view.biases, activations.data(), z.data(), 1,
+                        view.fan_in, view.fan_out, l < num_layers() - 1);
+        activations.swap(z);
     }
-    
+
     return activations;
 }
 
@@ -110,83 +152,131 @@ void Network::backward(const std::vector<float>& input,
                        const std::vector<float>& predicted_q_values,
                        std::vector<std::vector<std::vector<float>>>& weight_gradients,
                        std::vector<std::vector<float>>& bias_gradients) const {
-    
-    // Initialize gradients
-    weight_gradients.resize(weights_.size());
-    bias_gradients.resize(biases_.size());
-    
-    for (size_t i = 0; i < weights_.size(); ++i) {
-        weight_gradients[i].resize(weights_[i].size());
-        for (size_t j = 0; j < weights_[i].size(); ++j) {
-            weight_gradients[i][j].resize(weights_[i][j].size(), 0.0f);
-        }
-        bias_gradients[i].resize(biases_[i].size(), 0.0f);
-    }
-    
-    // Forward pass to get all activations (both pre and post activation)
-    std::vector<std::vector<float>> layer_activations;  // Post-activation (input to next layer)
-    std::vector<std::vector<float>> pre_activations;    // Pre-activation (before ReLU)
-    std::vector<float> current_activation = input;
-    layer_activations.push_back(current_activation);
-    
-    for (size_t layer = 0; layer < weights_.size(); ++layer) {
-        std::vector<float> z = matvec_mult(weights_[layer], current_activation);
-        for (size_t i = 0; i < z.size(); ++i) {
-            z[i] += biases_[layer][i];
-        }
-        
-        // Store pre-activation
-        pre_activations.push_back(z);
-        
-        if (layer < weights_.size() - 1) {
-            // Apply ReLU
-            for (float& val : z) {
-                val = relu(val);
-            }
-        }
-        
-        layer_activations.push_back(z);
-        current_activation = z;
+
+    const int output_size = layer_sizes_.back();
+    if (static_cast<int>(target_q_values.size()) != output_size ||
+        static_cast<int>(predicted_q_values.size()) != output_size) {
+        throw std::invalid_argument("Output size mismatch");
     }
-    
+
+    // A single sample is a batch of one
+    BatchCache cache;
+    forward_batch(input, 1, cache);
+
     // Compute output error (MSE derivative)
-    std::vector<float> output_error(predicted_q_values.size());
-    for (size_t i = 0; i < predicted_q_values.size(); ++i) {
+    std::vector<float> output_error(output_size);
+    for (int i = 0; i < output_size; ++i) {
         output_error[i] = predicted_q_values[i] - target_q_values[i];
     }
-    
-    // Backward pass
-    std::vector<float> delta = output_error;
-    
-    for (int layer = static_cast<int>(weights_.size()) - 1; layer >= 0; --layer) {
-        const std::vector<float>& prev_activation = layer_activations[layer];
-        
-        // Compute gradients for this layer
-        for (size_t i = 0; i < weights_[layer].size(); ++i) {
-            // Bias gradient
-            bias_gradients[layer][i] = delta[i];
-            
-            // Weight gradients
-            for (size_t j = 0; j < weights_[layer][i].size(); ++j) {
-                weight_gradients[layer][i][j] = delta[i] * prev_activation[j];
-            }
+
+    std::vector<float> gradients(params_.size());
+    backward_batch(cache, output_error, gradients);
+
+    // Unpack into the nested [layer][neuron][weight] / [layer][neuron] shape
+    weight_gradients.resize(num_layers());
+    bias_gradients.resize(num_layers());
+    for (size_t l = 0; l < num_layers(); ++l) {
+        ConstLayerView view = layer(l);
+        const float* dw = gradients.data() + layer_offsets_[l];
+        const float* db = dw + static_cast<std::size_t>(view.fan_out) * view.fan_in;
+        weight_gradients[l].resize(view.fan_out);
+        for (int i = 0; i < view.fan_out; ++i) {
+            weight_gradients[l][i].assign(dw + static_cast<std::size_t>(i) * view.fan_in,
+                                          dw + static_cast<std::size_t>(i + 1) * view.fan_in);
         }
-        
-        // Propagate error to previous layer (if not input layer)
-        if (layer > 0) {
-            std::vector<float> prev_delta(prev_activation.size(), 0.0f);
-            // pre_activations[layer-1] contains the pre-activation for the previous layer
-            const std::vector<float>& prev_pre_activation = pre_activations[layer - 1];
-            for (size_t i = 0; i < weights_[layer].size(); ++i) {
-                // Apply ReLU derivative using pre-activation value
-                // For hidden layers, use ReLU derivative; for output layer, derivative is 1.0
-                float relu_deriv = (layer < weights_.size() - 1) ? 
-                    relu_derivative(prev_pre_activation[i]) : 1.0f;
-                for (size_t j = 0; j < weights_[layer][i].size(); ++j) {
-                    prev_delta[j] += weights_[layer][i][j] * delta[i] * relu_deriv;
-                }
-            }
-            delta = prev_delta;
+        bias_gradients[l].assign(db, db + view.fan_out);
+    }
+}
+
+void Network::BatchCache::reserve(const std::vector<int>& layer_sizes, int batch_size) {
+    std::size_t rows = static_cast<std::size_t>(std::max(batch_size, 0));
+    int widest = 0;
+    activations.resize(layer_sizes.size());
+    for (std::size_t l = 0; l < layer_sizes.size(); ++l) {
+        activations[l].reserve(rows * layer_sizes[l]);
+        widest = std::max(widest, layer_sizes[l]);
+    }
+    // delta and prev_delta swap roles layer by layer, so both need the widest layer
+    delta.reserve(rows * widest);
+    prev_delta.reserve(rows * widest);
+    if (layer_sizes.size() >= 2) {
+        input_layer_gradients.reserve(static_cast<std::size_t>(layer_sizes[1]) *
+                                      (layer_sizes[0] + 1));
+    }
+}
+
+const float* Network::forward_batch(std::span<const float> inputs, int batch_size,
+                                    BatchCache& cache) const {
+    if (batch_size <= 0) {
+        throw std::invalid_argument("Batch size must be positive");
+    }
+    if (inputs.size() != static_cast<std::size_t>(batch_size) * layer_sizes_[0]) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+
+    cache.batch_size = batch_size;
+    cache.activations.resize(layer_sizes_.size());
+    for (size_t l = 0; l < layer_sizes_.size(); ++l) {
+        cache.activations[l].resize(static_cast<std::size_t>(batch_size) * layer_sizes_[l]);
+    }
+    std::copy(inputs.begin(), inputs.end(), cache.activations[0].begin());
+
+    // One matrix-matrix product per layer (ReLU for hidden, linear for output); an input
+    // transform lives in layer 0's folded weights
+    const auto& k = kernels::active();
+    for (size_t l = 0; l < num_layers(); ++l) {
+        ConstLayerView view = l == 0 ? input_layer() : layer(l);
+        k.dense_forward(view.weights, view.biases, cache.activations[l].data(),
+                        cache.activations[l + 1].data(), batch_size, view.fan_in, view.fan_out,
+                        l < num_layers() - 1);
+    }
+
+    return cache.output();
+}
+
+void Network::backward_batch(BatchCache& cache, std::span<const float> output_gradients,
+                             std::span<float> gradients) const {
+    const int batch_size = cache.batch_size;
+    if (batch_size <= 0 || cache.activations.size() != layer_sizes_.size()) {
+        throw std::logic_error("backward_batch() requires a preceding forward_batch()");
+    }
+    if (output_gradients.size() != static_cast<std::size_t>(batch_size) * layer_sizes_.back()) {
+        throw std::invalid_argument("Output gradient size mismatch");
+    }
+    if (gradients.size() != params_.size()) {
+        throw std::invalid_argument("Gradient buffer size mismatch");
+    }
+
+    const auto& k = kernels::active();
+    cache.delta.assign(output_gradients.begin(), output_gradients.end());
+
+    for (int l = static_cast<int>(num_layers()) - 1; l >= 0; --l) {
+        ConstLayerView view = layer(l);
+        const float* x = cache.activations[l].data();
+
+        // Gradients for this layer's weights and biases
+        float* dw = gradients.data() + layer_offsets_[l];
+        float* db = dw + static_cast<std::size_t>(view.fan_out) * view.fan_in;
+        if (l == 0 && has_input_transform()) {
+            // Layer 0 ran folded on raw inputs: take its gradient, then the chain rule
+            std::size_t weights = static_cast<std::size_t>(view.fan_out) * view.fan_in;
+            cache.input_layer_gradients.assign(weights + view.fan_out, 0.0f);
+            float* folded = cache.input_layer_gradients.data();
+            k.dense_backward_params(x, cache.delta.data(), folded, folded + weights,
+                                    batch_size, view.fan_in, view.fan_out);
+            unfold_input_gradients(cache.input_layer_gradients, input_scale_, input_shift_,
+                                   view.fan_out, dw, db);
+        } else {
+            k.dense_backward_params(x, cache.delta.data(), dw, db, batch_size, view.fan_in,
+                                    view.fan_out);
+        }
+
+        // Propagate error to previous layer (if not input layer); its output went through ReLU
+        if (l > 0) {
+            cache.prev_delta.resize(static_cast<std::size_t>(batch_size) * view.fan_in);
+            k.dense_backward_input(view.weights, x, cache.delta.data(), cache.prev_delta.data(),
+                                   batch_size, view.fan_in, view.fan_out, true);
+            cache.delta.swap(cache.prev_delta);
         }
     }
 }
@@ -194,70 +284,85 @@ void Network::backward(const std::vector<float>& input,
 void Network::update_weights(const std::vector<std::vector<std::vector<float>>>& weight_gradients,
                              const std::vector<std::vector<float>>& bias_gradients,
                              float learning_rate) {
-    for (size_t layer = 0; layer < weights_.size(); ++layer) {
-        for (size_t i = 0; i < weights_[layer].size(); ++i) {
+    for (size_t l = 0; l < num_layers(); ++l) {
+        LayerView view = layer(l);
+        for (int i = 0; i < view.fan_out; ++i) {
             // Update bias
-            biases_[layer][i] -= learning_rate * bias_gradients[layer][i];
-            
+            view.biases[i] -= learning_rate * bias_gradients[l][i];
+
             // Update weights
-            for (size_t j = 0; j < weights_[layer][i].size(); ++j) {
-                weights_[layer][i][j] -= learning_rate * weight_gradients[layer][i][j];
+            float* w = view.row(i);
+            for (int j = 0; j < view.fan_in; ++j) {
+                w[j] -= learning_rate * weight_gradients[l][i][j];
             }
         }
     }
 }
 
 std::vector<std::vector<std::vector<float>>> Network::get_weights() const {
-    return weights_;
+    std::vector<std::vector<std::vector<float>>> weights(num_layers());
+    for (size_t l = 0; l < num_layers(); ++l) {
+        ConstLayerView view = layer(l);
+        weights[l].resize(view.fan_out);
+        for (int i = 0; i < view.fan_out; ++i) {
+            weights[l][i].assign(view.row(i), view.row(i) + view.fan_in);
+        }
+    }
+    return weights;
 }
 
 std::vector<std::vector<float>> Network::get_biases() const {
-    return biases_;
+    std::vector<std::vector<float>> biases(num_layers());
+    for (size_t l = 0; l < num_layers(); ++l) {
+        ConstLayerView view = layer(l);
+        biases[l].assign(view.biases, view.biases + view.fan_out);
+    }
+    return biases;
 }
 
 void Network::set_weights(const std::vector<std::vector<std::vector<float>>>& weights) {
-    if (weights.size() != weights_.size()) {
+    if (weights.size() != num_layers()) {
         throw std::invalid_argument("Weight structure mismatch");
     }
-    
-    for (size_t i = 0; i < weights.size(); ++i) {
-        if (weights[i].size() != weights_[i].size()) {
+
+    for (size_t l = 0; l < weights.size(); ++l) {
+        ConstLayerView view = layer(l);
+        if (static_cast<int>(weights[l].size()) != view.fan_out) {
             throw std::invalid_argument("Weight structure mismatch");
         }
-        for (size_t j = 0; j < weights[i].size(); ++j) {
-            if (weights[i][j].size() != weights_[i][j].size()) {
+        for (int i = 0; i < view.fan_out; ++i) {
+            if (static_cast<int>(weights[l][i].size()) != view.fan_in) {
                 throw std::invalid_argument("Weight structure mismatch");
             }
         }
     }
-    
-    weights_ = weights;
+
+    for (size_t l = 0; l < weights.size(); ++l) {
+        LayerView view = layer(l);
+        for (int i = 0; i < view.fan_out; ++i) {
+            std::copy(weights[l][i].begin(), weights[l][i].end(), view.row(i));
+        }
+    }
 }
 
 void Network::set_biases(const std::vector<std::vector<float>>& biases) {
-    if (biases.size() != biases_.size()) {
+    if (biases.size() != num_layers()) {
         throw std::invalid_argument("Bias structure mismatch");
     }
-    
-    for (size_t i = 0; i < biases.size(); ++i) {
-        if (biases[i].size() != biases_[i].size()) {
+
+    for (size_t l = 0; l < biases.size(); ++l) {
+        if (static_cast<int>(biases[l].size()) != layer(l).fan_out) {
             throw std::invalid_argument("Bias structure mismatch");
         }
     }
-    
-    biases_ = biases;
+
+    for (size_t l = 0; l < biases.size(); ++l) {
+        std::copy(biases[l].begin(), biases[l].end(), layer(l).biases);
+    }
 }
 
 int Network::get_num_parameters() const {
-    int total = 0;
-    for (size_t i = 0; i < weights_.size(); ++i) {
-        for (size_t j = 0; j < weights_[i].size(); ++j) {
-            total += static_cast<int>(weights_[i][j].size());  // weights
-        }
-        total += static_cast<int>(biases_[i].size());  // biases
-    }
-    return total;
+    return static_cast<int>(params_.size());
 }
 
 } // namespace rl_dqn
-
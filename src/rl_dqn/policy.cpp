@@ -0,0 +1,71 @@
+#include "rl_dqn/policy.h"
+#include "core/telemetry.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+Policy::Policy(const DQNConfig& config, std::uint64_t seed)
+    : network_(config.layer_sizes, config.seed),
+      rng_(seed) {
+    if (config.quantized_policy) {
+        quantized_.emplace(network_);
+    }
+}
+
+env_flappy::Action Policy::select_action(const env_flappy::Observation& state, float epsilon) {
+    if (rng_.uniform() < epsilon) {
+        return rng_.uniform() < 0.5f ? env_flappy::Action::NO_FLAP : env_flappy::Action::FLAP;
+    }
+    return greedy_action(state);
+}
+
+env_flappy::Action Policy::greedy_action(const env_flappy::Observation& state) {
+    env_flappy::Action action;
+    if (quantized_) {
+        inference_.greedy_actions(*quantized_, {&state, 1}, {&action, 1});
+    } else {
+        inference_.greedy_actions(network_, {&state, 1}, {&action, 1});
+    }
+    return action;
+}
+
+void Policy::select_actions(std::span<const env_flappy::Observation> states, float epsilon,
+                            std::span<env_flappy::Action> actions) {
+    CORE_TELEMETRY_SCOPE_N(kActionSelect, states.size());
+    if (quantized_) {
+        inference_.epsilon_greedy_actions(*quantized_, states, epsilon, rng_, actions);
+    } else {
+        inference_.epsilon_greedy_actions(network_, states, epsilon, rng_, actions);
+    }
+}
+
+void Policy::load_parameters(std::span<const float> parameters) {
+    std::span<float> destination = network_.parameters();
+    if (parameters.size() != destination.size()) {
+        throw std::invalid_argument("Parameter count mismatch");
+    }
+    std::copy(parameters.begin(), parameters.end(), destination.begin());
+    if (quantized_) {
+        quantized_->quantize(parameters);
+    }
+}
+
+PolicySnapshot::PolicySnapshot(std::size_t num_parameters) : parameters_(num_parameters) {}
+
+void PolicySnapshot::publish(std::span<const float> parameters) {
+    if (parameters.size() != parameters_.size()) {
+        throw std::invalid_argument("Parameter count mismatch");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::copy(parameters.begin(), parameters.end(), parameters_.begin());
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t PolicySnapshot::read(Policy& policy) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy.load_parameters(parameters_);
+    return version_.load(std::memory_order_relaxed);
+}
+
+} // namespace rl_dqn
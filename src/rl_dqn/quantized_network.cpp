@@ -0,0 +1,122 @@
+#include "rl_dqn/quantized_network.h"
+#include "rl_dqn/kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+QuantizedNetwork::QuantizedNetwork(const std::vector<int>& layer_sizes)
+    : layer_sizes_(layer_sizes) {
+    if (layer_sizes.size() < 2) {
+        throw std::invalid_argument("Network needs at least input and output layers");
+    }
+
+    std::size_t weights = 0;
+    std::size_t channels = 0;
+    weight_offsets_.resize(layer_sizes.size() - 1);
+    channel_offsets_.resize(layer_sizes.size() - 1);
+    for (std::size_t l = 0; l + 1 < layer_sizes.size(); ++l) {
+        if (layer_sizes[l] <= 0 || layer_sizes[l + 1] <= 0) {
+            throw std::invalid_argument("Layer sizes must be positive");
+        }
+        weight_offsets_[l] = weights;
+        channel_offsets_[l] = channels;
+        weights += static_cast<std::size_t>(layer_sizes[l + 1]) * layer_sizes[l];
+        channels += static_cast<std::size_t>(layer_sizes[l + 1]);
+    }
+    num_parameters_ = weights + channels;
+
+    weights_.assign(weights, 0);
+    scales_.assign(channels, 0.0f);
+    biases_.assign(channels, 0.0f);
+}
+
+void QuantizedNetwork::quantize(std::span<const float> parameters) {
+    if (parameters.size() != num_parameters_) {
+        throw std::invalid_argument("Parameter count mismatch");
+    }
+
+    const float* layer_params = parameters.data();
+    for (std::size_t l = 0; l < num_layers(); ++l) {
+        const int fan_in = layer_sizes_[l];
+        const int fan_out = layer_sizes_[l + 1];
+        const float* w = layer_params;
+        const float* b = w + static_cast<std::size_t>(fan_out) * fan_in;
+        std::int8_t* q = weights_.data() + weight_offsets_[l];
+        float* scales = scales_.data() + channel_offsets_[l];
+
+        // Symmetric per-row quantization: the largest magnitude in a row maps to +-127
+        for (int o = 0; o < fan_out; ++o) {
+            const float* row = w + static_cast<std::size_t>(o) * fan_in;
+            float max_abs = 0.0f;
+            for (int j = 0; j < fan_in; ++j) {
+                max_abs = std::max(max_abs, std::fabs(row[j]));
+            }
+            float inv_scale = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+            scales[o] = max_abs / 127.0f;
+
+            std::int8_t* q_row = q + static_cast<std::size_t>(o) * fan_in;
+            for (int j = 0; j < fan_in; ++j) {
+                float v = std::nearbyint(row[j] * inv_scale);
+                q_row[j] = static_cast<std::int8_t>(std::clamp(v, -127.0f, 127.0f));
+            }
+        }
+        std::copy(b, b + fan_out, biases_.data() + channel_offsets_[l]);
+
+        layer_params = b + fan_out;
+    }
+}
+
+std::vector<float> QuantizedNetwork::forward(const std::vector<float>& input) const {
+    Network::BatchCache cache;
+    const float* out = forward_batch(input, 1, cache);
+    return std::vector<float>(out, out + layer_sizes_.back());
+}
+
+const float* QuantizedNetwork::forward_batch(std::span<const float> inputs, int batch_size,
+                                             Network::BatchCache& cache) const {
+    if (batch_size <= 0) {
+        throw std::invalid_argument("Batch size must be positive");
+    }
+    if (inputs.size() != static_cast<std::size_t>(batch_size) * layer_sizes_[0]) {
+        throw std::invalid_argument("Input size mismatch");
+    }
+
+    cache.batch_size = batch_size;
+    cache.activations.resize(layer_sizes_.size());
+    for (std::size_t l = 0; l < layer_sizes_.size(); ++l) {
+        cache.activations[l].resize(static_cast<std::size_t>(batch_size) * layer_sizes_[l]);
+    }
+    std::copy(inputs.begin(), inputs.end(), cache.activations[0].begin());
+
+    // ReLU for hidden, linear for output
+    const auto& k = kernels::active();
+    for (std::size_t l = 0; l < num_layers(); ++l) {
+        k.quantized_dense_forward(weights_.data() + weight_offsets_[l],
+                                  scales_.data() + channel_offsets_[l],
+                                  biases_.data() + channel_offsets_[l],
+                                  cache.activations[l].data(), cache.activations[l + 1].data(),
+                                  batch_size, layer_sizes_[l], layer_sizes_[l + 1],
+                                  l + 1 < num_layers());
+    }
+
+    return cache.output();
+}
+
+std::span<const std::int8_t> QuantizedNetwork::weights(std::size_t layer) const {
+    std::size_t count = static_cast<std::size_t>(layer_sizes_[layer + 1]) * layer_sizes_[layer];
+    return {weights_.data() + weight_offsets_[layer], count};
+}
+
+std::span<const float> QuantizedNetwork::scales(std::size_t layer) const {
+    return {scales_.data() + channel_offsets_[layer],
+            static_cast<std::size_t>(layer_sizes_[layer + 1])};
+}
+
+std::span<const float> QuantizedNetwork::biases(std::size_t layer) const {
+    return {biases_.data() + channel_offsets_[layer],
+            static_cast<std::size_t>(layer_sizes_[layer + 1])};
+}
+
+} // namespace rl_dqn
@@ -0,0 +1,298 @@
+#include "rl_dqn/remote.h"
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace rl_dqn {
+
+namespace {
+
+// Transitions per kExperiences frame at most; the sender takes whatever is queued up to this
+constexpr std::size_t kMaxFrameTransitions = 2048;
+
+// Idle wait of the I/O threads that poll a queue
+constexpr auto kIdleWait = std::chrono::microseconds(200);
+
+} // namespace
+
+ActorServer::ActorServer(std::uint16_t port, const wire::ActorConfig& actor_config,
+                         std::uint32_t first_actor_id, std::size_t queue_capacity)
+    : listener_(port),
+      actor_config_(actor_config),
+      next_actor_id_(first_actor_id),
+      queue_capacity_(queue_capacity) {
+    accept_thread_ = std::thread(&ActorServer::accept_loop, this);
+}
+
+ActorServer::~ActorServer() {
+    stopping_.store(true);
+    listener_.shutdown();
+    accept_thread_.join();
+    notify_writers();
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (std::unique_ptr<Connection>& connection : connections_) {
+        connection->socket.shutdown();
+        connection->reader.join();
+        connection->writer.join();
+    }
+}
+
+void ActorServer::accept_loop() {
+    while (!stopping_.load()) {
+        core::TcpSocket socket = listener_.accept();
+        if (!socket.valid()) {
+            if (stopping_.load()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));  // e.g. out of fds
+            continue;
+        }
+        socket.set_no_delay(true);
+
+        // Both threads run before the connection is listed, so poll() never reaps a
+        // connection whose threads are still being started
+        auto connection =
+            std::make_unique<Connection>(std::move(socket), next_actor_id_++, queue_capacity_);
+        connection->reader = std::thread(&ActorServer::read_loop, this, std::ref(*connection));
+        connection->writer = std::thread(&ActorServer::write_loop, this, std::ref(*connection));
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.push_back(std::move(connection));
+    }
+}
+
+void ActorServer::read_loop(Connection& connection) {
+    try {
+        wire::MessageType type;
+        std::vector<std::byte> payload;
+        if (!wire::recv_message(connection.socket, type, payload) ||
+            type != wire::MessageType::kHello ||
+            wire::decode_hello(payload).version != wire::kProtocolVersion) {
+            throw std::runtime_error("Actor handshake failed");
+        }
+        connection.greeted.store(true);
+        notify_writers();
+
+        std::vector<Experience> batch;
+        while (!stopping_.load() && wire::recv_message(connection.socket, type, payload)) {
+            if (type != wire::MessageType::kExperiences) {
+                throw std::runtime_error("Unexpected message from actor");
+            }
+            batch.clear();
+            wire::EpisodeStats stats = wire::decode_experiences(payload, batch);
+            for (const Experience& experience : batch) {
+                while (!connection.queue.try_push(experience)) {
+                    if (stopping_.load()) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(kIdleWait);
+                }
+            }
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.episodes += stats.episodes;
+            stats_.pipes += stats.pipes;
+            stats_.return_sum += stats.return_sum;
+        }
+    } catch (const std::exception&) {
+        // A broken or misbehaving actor only loses its own connection
+    }
+    close(connection);
+}
+
+void ActorServer::write_loop(Connection& connection) {
+    try {
+        std::uint64_t sent_version = 0;
+        bool configured = false;
+        while (true) {
+            std::shared_ptr<const std::vector<std::byte>> snapshot;
+            {
+                std::unique_lock<std::mutex> lock(snapshot_mutex_);
+                snapshot_changed_.wait(lock, [&] {
+                    return stopping_.load() || connection.closed.load() ||
+                           (connection.greeted.load() &&
+                            (!configured || snapshot_version_ != sent_version));
+                });
+                if (stopping_.load() || connection.closed.load()) {
+                    break;
+                }
+                if (configured) {
+                    snapshot = snapshot_;
+                    sent_version = snapshot_version_;
+                }
+            }
+
+            if (!configured) {
+                wire::ActorConfig config = actor_config_;
+                config.actor_id = connection.actor_id;
+                std::vector<std::byte> payload;
+                wire::encode_config(config, payload);
+                wire::send_message(connection.socket, wire::MessageType::kConfig, payload);
+                configured = true;
+            } else if (snapshot) {
+                wire::send_message(connection.socket, wire::MessageType::kSnapshot, *snapshot);
+            }
+        }
+    } catch (const std::exception&) {
+    }
+    close(connection);
+}
+
+void ActorServer::close(Connection& connection) {
+    connection.closed.store(true);
+    connection.socket.shutdown();
+    notify_writers();
+}
+
+void ActorServer::notify_writers() {
+    // Taking the lock orders the state change before any waiting writer re-checks it
+    { std::lock_guard<std::mutex> lock(snapshot_mutex_); }
+    snapshot_changed_.notify_all();
+}
+
+std::size_t ActorServer::poll(Experience* out, std::size_t max_items) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    std::size_t count = 0;
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        Connection& connection = **it;
+        // Read closed first: a closed reader pushes nothing more, so an empty pop after it
+        // means the queue is drained for good
+        bool closed = connection.closed.load(std::memory_order_acquire);
+        std::size_t room = max_items - count;
+        std::size_t popped = connection.queue.try_pop(out + count, room);
+        count += popped;
+        if (closed && popped < room) {
+            connection.socket.shutdown();
+            connection.reader.join();
+            connection.writer.join();
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return count;
+}
+
+void ActorServer::broadcast(std::span<const float> parameters, float epsilon) {
+    wire::SnapshotInfo info;
+    info.version = ++broadcasts_;
+    info.epsilon = epsilon;
+    info.encoding = actor_config_.encoding;
+    auto payload = std::make_shared<std::vector<std::byte>>();
+    wire::encode_snapshot(parameters, actor_config_.layer_sizes, info, *payload);
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot_ = std::move(payload);
+        snapshot_version_ = info.version;
+    }
+    snapshot_changed_.notify_all();
+}
+
+wire::EpisodeStats ActorServer::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+std::size_t ActorServer::num_connections() const {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    std::size_t open = 0;
+    for (const std::unique_ptr<Connection>& connection : connections_) {
+        open += connection->closed.load() ? 0 : 1;
+    }
+    return open;
+}
+
+LearnerClient::LearnerClient(const std::string& host, std::uint16_t port,
+                             std::uint32_t num_envs, std::size_t queue_capacity)
+    : socket_(core::TcpSocket::connect(host, port)), queue_(queue_capacity) {
+    socket_.set_no_delay(true);
+
+    std::vector<std::byte> payload;
+    wire::Hello hello;
+    hello.num_envs = num_envs;
+    wire::encode_hello(hello, payload);
+    wire::send_message(socket_, wire::MessageType::kHello, payload);
+
+    wire::MessageType type;
+    if (!wire::recv_message(socket_, type, payload) || type != wire::MessageType::kConfig) {
+        throw std::runtime_error("Learner at " + host + " did not send a config");
+    }
+    config_ = wire::decode_config(payload);
+    snapshot_ = std::make_unique<PolicySnapshot>(wire::num_parameters(config_.layer_sizes));
+
+    sender_ = std::thread(&LearnerClient::send_loop, this);
+    receiver_ = std::thread(&LearnerClient::receive_loop, this);
+}
+
+LearnerClient::~LearnerClient() {
+    // The sender flushes what is queued before it exits
+    stopping_.store(true);
+    sender_.join();
+    socket_.shutdown();
+    receiver_.join();
+}
+
+bool LearnerClient::push(const Experience& experience) {
+    while (!queue_.try_push(experience)) {
+        if (closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        std::this_thread::sleep_for(kIdleWait);
+    }
+    return connected();
+}
+
+void LearnerClient::add_episode(double episode_return, std::uint32_t pipes) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    pending_stats_.episodes += 1;
+    pending_stats_.pipes += pipes;
+    pending_stats_.return_sum += episode_return;
+}
+
+void LearnerClient::send_loop() {
+    std::vector<Experience> batch(kMaxFrameTransitions);
+    std::vector<std::byte> payload;
+    try {
+        while (!closed_.load(std::memory_order_acquire)) {
+            std::size_t count = queue_.try_pop(batch.data(), batch.size());
+            if (count == 0) {
+                if (stopping_.load()) {
+                    break;  // the producer is done and everything it pushed went out
+                }
+                std::this_thread::sleep_for(kIdleWait);
+                continue;
+            }
+            wire::EpisodeStats stats;
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats = std::exchange(pending_stats_, wire::EpisodeStats{});
+            }
+            wire::encode_experiences(std::span(batch.data(), count), stats, payload);
+            wire::send_message(socket_, wire::MessageType::kExperiences, payload);
+        }
+    } catch (const std::exception&) {
+    }
+    closed_.store(true, std::memory_order_release);
+}
+
+void LearnerClient::receive_loop() {
+    std::vector<float> parameters(wire::num_parameters(config_.layer_sizes));
+    std::vector<std::byte> payload;
+    try {
+        wire::MessageType type;
+        while (wire::recv_message(socket_, type, payload)) {
+            if (type != wire::MessageType::kSnapshot) {
+                throw std::runtime_error("Unexpected message from learner");
+            }
+            // Epsilon first, so an actor that sees the new version also sees its epsilon
+            wire::SnapshotInfo info = wire::decode_snapshot(payload, config_.layer_sizes,
+                                                            parameters);
+            epsilon_.store(info.epsilon, std::memory_order_relaxed);
+            snapshot_->publish(parameters);
+        }
+    } catch (const std::exception&) {
+    }
+    closed_.store(true, std::memory_order_release);
+}
+
+} // namespace rl_dqn
@@ -1,53 +1,200 @@
 #include "rl_dqn/replay_buffer.h"
 #include <algorithm>
-#include <numeric>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 namespace rl_dqn {
 
+void TransitionBatch::resize(std::size_t batch_size) {
+    size = batch_size;
+    states.resize(batch_size * kObservationSize);
+    next_states.resize(batch_size * kObservationSize);
+    actions.resize(batch_size);
+    rewards.resize(batch_size);
+    dones.resize(batch_size);
+    slots.resize(batch_size);
+    weights.resize(batch_size);
+}
+
 ReplayBuffer::ReplayBuffer(std::size_t capacity, std::uint64_t seed)
-    : capacity_(capacity), write_index_(0), rng_(static_cast<std::mt19937::result_type>(seed)) {
-    experiences_.reserve(capacity);
+    : rng_(static_cast<std::mt19937::result_type>(seed)),
+      capacity_(capacity), size_(0), write_index_(0) {
+    states_.resize(capacity * kObservationSize);
+    next_states_.resize(capacity * kObservationSize);
+    actions_.resize(capacity);
+    rewards_.resize(capacity);
+    dones_.resize(capacity);
+}
+
+ReplayBuffer::ReplayBuffer(std::size_t capacity, std::uint64_t seed, ExternalStorage)
+    : rng_(static_cast<std::mt19937::result_type>(seed)),
+      capacity_(capacity), size_(0), write_index_(0) {}
+
+std::size_t ReplayBuffer::claim_slot() {
+    // Circular buffer: once full, replace the oldest experience
+    const std::size_t slot = write_index_;
+    write_index_ = (write_index_ + 1) % capacity_;
+    if (size_ < capacity_) {
+        ++size_;
+    }
+    return slot;
+}
+
+void ReplayBuffer::restore(std::size_t size, std::size_t next_slot) {
+    if (size > capacity_ || next_slot >= std::max<std::size_t>(capacity_, 1) ||
+        (size < capacity_ && next_slot != size)) {
+        throw std::invalid_argument("Replay ring position out of range");
+    }
+    size_ = size;
+    write_index_ = next_slot;
 }
 
 void ReplayBuffer::push(const Experience& experience) {
-    if (experiences_.size() < capacity_) {
-        experiences_.push_back(experience);
-    } else {
-        // Circular buffer: replace oldest experience
-        experiences_[write_index_] = experience;
-        write_index_ = (write_index_ + 1) % capacity_;
+    if (capacity_ == 0) {
+        return;
     }
+
+    const std::size_t slot = claim_slot();
+    write_observation(experience.state, states_.data() + slot * kObservationSize);
+    write_observation(experience.next_state, next_states_.data() + slot * kObservationSize);
+    actions_[slot] = experience.action;
+    rewards_[slot] = experience.reward;
+    dones_[slot] = experience.done ? 1 : 0;
 }
 
-std::vector<Experience> ReplayBuffer::sample(std::size_t batch_size) const {
-    if (experiences_.size() < batch_size) {
+Experience ReplayBuffer::at(std::size_t i) const {
+    const float* s = states_.data() + i * kObservationSize;
+    const float* ns = next_states_.data() + i * kObservationSize;
+    Experience exp;
+    exp.state = read_observation(s);
+    exp.action = actions_[i];
+    exp.reward = rewards_[i];
+    exp.next_state = read_observation(ns);
+    exp.done = dones_[i] != 0;
+    return exp;
+}
+
+std::span<const std::size_t> ReplayBuffer::sample_indices(std::size_t batch_size) const {
+    if (size_ < batch_size) {
         throw std::runtime_error("Not enough experiences in buffer");
     }
-    
+
+    // Floyd's algorithm: batch_size distinct indices with batch_size draws. The membership
+    // test scans the indices chosen so far, which for minibatch sizes beats any hashing.
+    const std::size_t n = size_;
+    indices_.clear();
+    for (std::size_t j = n - batch_size; j < n; ++j) {
+        std::uniform_int_distribution<std::size_t> dist(0, j);
+        std::size_t t = dist(rng_);
+        if (std::find(indices_.begin(), indices_.end(), t) != indices_.end()) {
+            t = j;
+        }
+        indices_.push_back(t);
+    }
+    return indices_;
+}
+
+std::vector<Experience> ReplayBuffer::sample(std::size_t batch_size) const {
     std::vector<Experience> batch;
-    batch.reserve(batch_size);
-    
-    // Sample random indices without replacement
-    std::vector<std::size_t> indices(experiences_.size());
-    std::iota(indices.begin(), indices.end(), 0);
-    
-    std::shuffle(indices.begin(), indices.end(), rng_);
-    
+    sample(batch_size, batch);
+    return batch;
+}
+
+void ReplayBuffer::sample(std::size_t batch_size, std::vector<Experience>& batch) const {
+    std::span<const std::size_t> slots = sample_indices(batch_size);
+    batch.resize(batch_size);
     for (std::size_t i = 0; i < batch_size; ++i) {
-        batch.push_back(experiences_[indices[i]]);
+        batch[i] = at(slots[i]);
+    }
+}
+
+void ReplayBuffer::sample(std::size_t batch_size, TransitionBatch& batch) const {
+    gather(sample_indices(batch_size), batch);
+    std::fill(batch.weights.begin(), batch.weights.end(), 1.0f);
+}
+
+void ReplayBuffer::update_priorities(std::span<const std::size_t>, std::span<const float>) {}
+
+void ReplayBuffer::gather(std::span<const std::size_t> slots, TransitionBatch& batch) const {
+    batch.resize(slots.size());
+
+    constexpr std::size_t row_bytes = kObservationSize * sizeof(float);
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        const std::size_t slot = slots[i];
+        batch.slots[i] = slot;
+        std::memcpy(batch.states.data() + i * kObservationSize,
+                    states_.data() + slot * kObservationSize, row_bytes);
+        std::memcpy(batch.next_states.data() + i * kObservationSize,
+                    next_states_.data() + slot * kObservationSize, row_bytes);
+        batch.actions[i] = actions_[slot];
+        batch.rewards[i] = rewards_[slot];
+        batch.dones[i] = dones_[slot];
     }
-    
-    return batch;
 }
 
 bool ReplayBuffer::can_sample(std::size_t batch_size) const {
-    return experiences_.size() >= batch_size;
+    return size_ >= batch_size;
 }
 
 void ReplayBuffer::clear() {
-    experiences_.clear();
+    size_ = 0;
+    write_index_ = 0;
 }
 
-} // namespace rl_dqn
+PrioritizedReplayBuffer::PrioritizedReplayBuffer(std::size_t capacity,
+                                                 float alpha,
+                                                 float epsilon,
+                                                 std::uint64_t seed)
+    : ReplayBuffer(capacity, seed), alpha_(alpha), epsilon_(epsilon), tree_(capacity) {}
+
+void PrioritizedReplayBuffer::push(const Experience& experience) {
+    const std::size_t slot = next_slot();
+    ReplayBuffer::push(experience);
+    tree_.set(slot, max_priority_);
+}
+
+void PrioritizedReplayBuffer::sample(std::size_t batch_size, TransitionBatch& batch) const {
+    if (!can_sample(batch_size) || batch_size == 0) {
+        throw std::runtime_error("Not enough experiences in buffer");
+    }
+
+    const float total = tree_.total();
+    const float segment = total / static_cast<float>(batch_size);
+    std::uniform_real_distribution<float> uni01(0.0f, 1.0f);
+    sampled_slots_.resize(batch_size);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        float mass = (static_cast<float>(i) + uni01(rng_)) * segment;
+        sampled_slots_[i] = tree_.find(mass < total ? mass : total);
+    }
+    gather(sampled_slots_, batch);
 
+    // w_i = (N * P(i))^-beta / max_j w_j = (p_i / p_min)^-beta
+    const float min_priority = tree_.min();
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        batch.weights[i] = std::pow(tree_.get(sampled_slots_[i]) / min_priority, -beta_);
+    }
+}
+
+void PrioritizedReplayBuffer::update_priorities(std::span<const std::size_t> slots,
+                                                std::span<const float> td_errors) {
+    if (slots.size() != td_errors.size()) {
+        throw std::invalid_argument("Priority update size mismatch");
+    }
+
+    new_priorities_.resize(td_errors.size());
+    for (std::size_t i = 0; i < td_errors.size(); ++i) {
+        float priority = std::pow(std::fabs(td_errors[i]) + epsilon_, alpha_);
+        new_priorities_[i] = priority;
+        max_priority_ = std::max(max_priority_, priority);
+    }
+    tree_.set(slots, new_priorities_);
+}
+
+void PrioritizedReplayBuffer::clear() {
+    ReplayBuffer::clear();
+    tree_.clear();
+    max_priority_ = 1.0f;
+}
+
+} // namespace rl_dqn
@@ -0,0 +1,114 @@
+#include "rl_dqn/sum_tree.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+std::size_t round_up(std::size_t n, std::size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+SumTree::SumTree(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("SumTree capacity must be positive");
+    }
+
+    std::size_t level_size = round_up(capacity, kFanout);
+    while (true) {
+        sums_.emplace_back(level_size, 0.0f);
+        mins_.emplace_back(level_size, kInfinity);
+        if (level_size == 1) {
+            break;
+        }
+        std::size_t parents = level_size / kFanout;
+        level_size = parents == 1 ? 1 : round_up(parents, kFanout);
+    }
+}
+
+// Helper: Recompute node `node` of `level` (>= 1) from its kFanout children
+void SumTree::refresh(std::size_t level, std::size_t node) {
+    const float* sums = sums_[level - 1].data() + node * kFanout;
+    const float* mins = mins_[level - 1].data() + node * kFanout;
+    float sum = 0.0f;
+    float lowest = kInfinity;
+    for (std::size_t c = 0; c < kFanout; ++c) {
+        sum += sums[c];
+        lowest = mins[c] < lowest ? mins[c] : lowest;
+    }
+    sums_[level][node] = sum;
+    mins_[level][node] = lowest;
+}
+
+void SumTree::set(std::size_t index, float priority) {
+    sums_[0][index] = priority;
+    mins_[0][index] = priority;
+    for (std::size_t level = 1; level < sums_.size(); ++level) {
+        index /= kFanout;
+        refresh(level, index);
+    }
+}
+
+void SumTree::set(std::span<const std::size_t> indices, std::span<const float> priorities) {
+    if (indices.size() != priorities.size()) {
+        throw std::invalid_argument("SumTree update size mismatch");
+    }
+
+    dirty_.clear();
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        sums_[0][indices[i]] = priorities[i];
+        mins_[0][indices[i]] = priorities[i];
+        dirty_.push_back(indices[i] / kFanout);
+    }
+
+    // Sorted, de-duplicated parents stay sorted when divided by kFanout, so each level is
+    // a single unique() pass and shared ancestors are recomputed only once
+    std::sort(dirty_.begin(), dirty_.end());
+    for (std::size_t level = 1; level < sums_.size(); ++level) {
+        dirty_.erase(std::unique(dirty_.begin(), dirty_.end()), dirty_.end());
+        for (std::size_t& node : dirty_) {
+            refresh(level, node);
+            node /= kFanout;
+        }
+    }
+}
+
+std::size_t SumTree::find(float mass) const {
+    std::size_t node = 0;
+    for (std::size_t level = sums_.size() - 1; level > 0; --level) {
+        const float* children = sums_[level - 1].data() + node * kFanout;
+        std::size_t chosen = kFanout;
+        std::size_t last_nonempty = 0;
+        for (std::size_t c = 0; c < kFanout; ++c) {
+            if (children[c] > 0.0f) {
+                last_nonempty = c;
+                if (mass < children[c]) {
+                    chosen = c;
+                    break;
+                }
+            }
+            mass -= children[c];
+        }
+        if (chosen == kFanout) {
+            chosen = last_nonempty;  // round-off carried mass past the last child
+            mass = children[chosen] * 0.5f;
+        }
+        node = node * kFanout + chosen;
+    }
+    return node;
+}
+
+void SumTree::clear() {
+    for (std::size_t level = 0; level < sums_.size(); ++level) {
+        std::fill(sums_[level].begin(), sums_[level].end(), 0.0f);
+        std::fill(mins_[level].begin(), mins_[level].end(), kInfinity);
+    }
+}
+
+} // namespace rl_dqn
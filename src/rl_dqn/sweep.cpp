@@ -0,0 +1,265 @@
+#include "rl_dqn/sweep.h"
+#include "core/rng.h"
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+
+namespace rl_dqn {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const char* space = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(space);
+    if (begin == std::string::npos) {
+        return {};
+    }
+    return text.substr(begin, text.find_last_not_of(space) - begin + 1);
+}
+
+// A number, or true/false for boolean fields; throws std::invalid_argument
+double parse_number(const std::string& text) {
+    std::string token = trim(text);
+    if (token == "true") {
+        return 1.0;
+    }
+    if (token == "false") {
+        return 0.0;
+    }
+    std::size_t used = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(token, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != token.size()) {
+        throw std::invalid_argument("not a number: '" + token + "'");
+    }
+    return value;
+}
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::size_t begin = 0;
+    while (true) {
+        std::size_t end = text.find(separator, begin);
+        parts.push_back(text.substr(begin, end - begin));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        begin = end + 1;
+    }
+}
+
+void check_range(const std::string& name, double value, double low, double high) {
+    if (!(value >= low && value <= high)) {
+        throw std::invalid_argument(name + " out of range: " + std::to_string(value));
+    }
+}
+
+double set_real(float& field, const std::string& name, double value, double low, double high) {
+    check_range(name, value, low, high);
+    field = static_cast<float>(value);
+    return field;
+}
+
+template <class Int>
+double set_integer(Int& field, const std::string& name, double value, double low) {
+    double rounded = std::round(value);
+    check_range(name, rounded, low, static_cast<double>(std::numeric_limits<int>::max()));
+    field = static_cast<Int>(rounded);
+    return static_cast<double>(field);
+}
+
+double set_flag(bool& field, const std::string& name, double value) {
+    if (value != 0.0 && value != 1.0) {
+        throw std::invalid_argument(name + " must be 0/1 or false/true");
+    }
+    field = value != 0.0;
+    return value;
+}
+
+} // namespace
+
+bool SweepSpec::is_random() const {
+    return std::any_of(parameters.begin(), parameters.end(),
+                       [](const SweepParameter& p) { return p.is_range(); });
+}
+
+double set_config_value(DQNConfig& config, const std::string& name, double value) {
+    if (name == "learning_rate") {
+        return set_real(config.learning_rate, name, value, 1e-12, 1.0);
+    } else if (name == "gamma") {
+        return set_real(config.gamma, name, value, 0.0, 1.0);
+    } else if (name == "n_step") {
+        return set_integer(config.n_step, name, value, 1);
+    } else if (name == "double_dqn") {
+        return set_flag(config.double_dqn, name, value);
+    } else if (name == "epsilon_start") {
+        return set_real(config.epsilon_start, name, value, 0.0, 1.0);
+    } else if (name == "epsilon_end") {
+        return set_real(config.epsilon_end, name, value, 0.0, 1.0);
+    } else if (name == "epsilon_decay_steps") {
+        return set_integer(config.epsilon_decay_steps, name, value, 1);
+    } else if (name == "replay_buffer_size") {
+        return set_integer(config.replay_buffer_size, name, value, 1);
+    } else if (name == "batch_size") {
+        return set_integer(config.batch_size, name, value, 1);
+    } else if (name == "prioritized_replay") {
+        return set_flag(config.prioritized_replay, name, value);
+    } else if (name == "priority_alpha") {
+        return set_real(config.priority_alpha, name, value, 0.0, 1.0);
+    } else if (name == "train_frequency") {
+        return set_integer(config.train_frequency, name, value, 1);
+    } else if (name == "target_update_frequency") {
+        return set_integer(config.target_update_frequency, name, value, 1);
+    } else if (name == "target_tau") {
+        return set_real(config.target_tau, name, value, 0.0, 1.0);
+    } else if (name == "normalize_observations") {
+        return set_flag(config.normalize_observations, name, value);
+    } else if (name == "hidden") {
+        int width = 0;
+        set_integer(width, name, value, 1);
+        for (std::size_t layer = 1; layer + 1 < config.layer_sizes.size(); ++layer) {
+            config.layer_sizes[layer] = width;
+        }
+        return width;
+    }
+    throw std::invalid_argument("unknown parameter '" + name + "'");
+}
+
+SweepSpec parse_sweep_spec(std::istream& in) {
+    SweepSpec spec;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            std::size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                throw std::invalid_argument("expected 'name = values'");
+            }
+            SweepParameter parameter;
+            parameter.name = trim(line.substr(0, equals));
+            std::string values = trim(line.substr(equals + 1));
+            for (const SweepParameter& other : spec.parameters) {
+                if (other.name == parameter.name) {
+                    throw std::invalid_argument("'" + parameter.name + "' is given twice");
+                }
+            }
+
+            const bool log_range = values.rfind("log_uniform(", 0) == 0;
+            if (log_range || values.rfind("uniform(", 0) == 0) {
+                if (values.back() != ')') {
+                    throw std::invalid_argument("expected ')'");
+                }
+                std::size_t open = values.find('(');
+                std::vector<std::string> bounds =
+                    split(values.substr(open + 1, values.size() - open - 2), ',');
+                if (bounds.size() != 2) {
+                    throw std::invalid_argument("a range takes two bounds");
+                }
+                parameter.log_scale = log_range;
+                parameter.low = parse_number(bounds[0]);
+                parameter.high = parse_number(bounds[1]);
+                if (!(parameter.low < parameter.high) || (log_range && parameter.low <= 0.0)) {
+                    throw std::invalid_argument("empty or non-positive log range");
+                }
+            } else {
+                for (const std::string& value : split(values, ',')) {
+                    parameter.values.push_back(parse_number(value));
+                }
+            }
+
+            // Reject unknown names and values the field cannot take up front
+            DQNConfig scratch;
+            if (parameter.is_range()) {
+                set_config_value(scratch, parameter.name, parameter.low);
+                set_config_value(scratch, parameter.name, parameter.high);
+            }
+            for (double value : parameter.values) {
+                set_config_value(scratch, parameter.name, value);
+            }
+            spec.parameters.push_back(std::move(parameter));
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument("Sweep spec line " + std::to_string(number) + ": " +
+                                        e.what());
+        }
+    }
+    return spec;
+}
+
+std::vector<SweepTrial> expand_sweep(const SweepSpec& spec, const DQNConfig& base,
+                                     std::size_t samples, std::uint64_t seed) {
+    std::size_t count = 1;
+    if (spec.is_random()) {
+        if (samples == 0) {
+            throw std::invalid_argument("A random sweep needs at least one sample");
+        }
+        count = samples;
+    } else {
+        for (const SweepParameter& parameter : spec.parameters) {
+            count *= parameter.values.size();
+        }
+    }
+
+    core::Pcg32 rng(seed);
+    std::vector<SweepTrial> trials(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        SweepTrial& trial = trials[i];
+        trial.index = i;
+        trial.config = base;
+        trial.config.seed = base.seed + i;
+        trial.values.resize(spec.parameters.size());
+
+        std::size_t rest = i;   // mixed-radix digits of i, last parameter fastest
+        for (std::size_t p = spec.parameters.size(); p-- > 0;) {
+            const SweepParameter& parameter = spec.parameters[p];
+            double value = 0.0;
+            if (!spec.is_random()) {
+                value = parameter.values[rest % parameter.values.size()];
+                rest /= parameter.values.size();
+            } else if (parameter.is_range()) {
+                double u = rng.uniform();
+                value = parameter.log_scale
+                            ? std::exp(std::log(parameter.low) +
+                                       u * (std::log(parameter.high) - std::log(parameter.low)))
+                            : parameter.low + u * (parameter.high - parameter.low);
+            } else {
+                std::size_t pick = static_cast<std::size_t>(rng.uniform() *
+                                                            parameter.values.size());
+                value = parameter.values[std::min(pick, parameter.values.size() - 1)];
+            }
+            trial.values[p] = set_config_value(trial.config, parameter.name, value);
+        }
+    }
+    return trials;
+}
+
+MedianStoppingRule::MedianStoppingRule(std::size_t min_reports, std::size_t grace_rounds)
+    : min_reports_(std::max<std::size_t>(1, min_reports)), grace_rounds_(grace_rounds) {}
+
+bool MedianStoppingRule::report(std::size_t round, double score) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scores_.size() <= round) {
+        scores_.resize(round + 1);
+    }
+    std::vector<double>& reported = scores_[round];
+    bool keep = true;
+    if (round >= grace_rounds_ && reported.size() >= min_reports_) {
+        std::vector<double> sorted = reported;
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t mid = sorted.size() / 2;
+        double median = sorted.size() % 2 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+        keep = score >= median;
+    }
+    reported.push_back(score);
+    return keep;
+}
+
+} // namespace rl_dqn
@@ -0,0 +1,321 @@
+#include "rl_dqn/wire.h"
+#include "rl_dqn/quantized_network.h"
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rl_dqn {
+namespace wire {
+
+static_assert(std::endian::native == std::endian::little,
+              "The wire format is little-endian; add byte swapping for this target");
+
+namespace {
+
+constexpr char kMagic[4] = {'F', 'R', 'L', 'W'};
+constexpr std::uint8_t kFlagFlap = 1u << 0;
+constexpr std::uint8_t kFlagDone = 1u << 1;
+constexpr std::size_t kTransitionBytes = 2 * kObservationSize * sizeof(float) + sizeof(float) + 1;
+
+class Writer {
+public:
+    explicit Writer(std::vector<std::byte>& out) : out_(out) { out_.clear(); }
+
+    template <class T>
+    void put(const T& value) {
+        put_array(&value, 1);
+    }
+
+    template <class T>
+    void put_array(const T* values, std::size_t count) {
+        std::size_t offset = out_.size();
+        out_.resize(offset + count * sizeof(T));
+        std::memcpy(out_.data() + offset, values, count * sizeof(T));
+    }
+
+private:
+    std::vector<std::byte>& out_;
+};
+
+class Reader {
+public:
+    Reader(std::span<const std::byte> payload, const char* what)
+        : payload_(payload), what_(what) {}
+
+    template <class T>
+    T get() {
+        T value;
+        get_array(&value, 1);
+        return value;
+    }
+
+    template <class T>
+    void get_array(T* values, std::size_t count) {
+        if (count > (payload_.size() - offset_) / sizeof(T)) {
+            fail("truncated");
+        }
+        std::memcpy(values, payload_.data() + offset_, count * sizeof(T));
+        offset_ += count * sizeof(T);
+    }
+
+    void expect_end() const {
+        if (offset_ != payload_.size()) {
+            fail("trailing bytes");
+        }
+    }
+
+    [[noreturn]] void fail(const char* reason) const {
+        throw std::runtime_error(std::string("Malformed ") + what_ + " message (" + reason + ")");
+    }
+
+private:
+    std::span<const std::byte> payload_;
+    std::size_t offset_ = 0;
+    const char* what_;
+};
+
+} // namespace
+
+std::size_t num_parameters(const std::vector<int>& layer_sizes) {
+    std::size_t count = 0;
+    for (std::size_t l = 0; l + 1 < layer_sizes.size(); ++l) {
+        count += static_cast<std::size_t>(layer_sizes[l + 1]) *
+                 (static_cast<std::size_t>(layer_sizes[l]) + 1);
+    }
+    return count;
+}
+
+void encode_hello(const Hello& hello, std::vector<std::byte>& out) {
+    Writer w(out);
+    w.put(hello.version);
+    w.put(hello.num_envs);
+}
+
+Hello decode_hello(std::span<const std::byte> payload) {
+    Reader r(payload, "hello");
+    Hello hello;
+    hello.version = r.get<std::uint32_t>();
+    hello.num_envs = r.get<std::uint32_t>();
+    r.expect_end();
+    return hello;
+}
+
+void encode_config(const ActorConfig& config, std::vector<std::byte>& out) {
+    Writer w(out);
+    w.put(config.actor_id);
+    w.put(config.seed);
+    w.put(static_cast<std::uint32_t>(config.n_step));
+    w.put(config.gamma);
+    w.put(static_cast<std::uint8_t>(config.quantized_policy ? 1 : 0));
+    w.put(static_cast<std::uint8_t>(config.encoding));
+    w.put(static_cast<std::uint32_t>(config.layer_sizes.size()));
+    for (int size : config.layer_sizes) {
+        w.put(static_cast<std::int32_t>(size));
+    }
+}
+
+ActorConfig decode_config(std::span<const std::byte> payload) {
+    Reader r(payload, "config");
+    ActorConfig config;
+    config.actor_id = r.get<std::uint32_t>();
+    config.seed = r.get<std::uint64_t>();
+    config.n_step = static_cast<int>(r.get<std::uint32_t>());
+    config.gamma = r.get<float>();
+    config.quantized_policy = r.get<std::uint8_t>() != 0;
+    std::uint8_t encoding = r.get<std::uint8_t>();
+    if (encoding > static_cast<std::uint8_t>(SnapshotEncoding::kInt8)) {
+        r.fail("snapshot encoding");
+    }
+    config.encoding = static_cast<SnapshotEncoding>(encoding);
+    std::uint32_t num_layers = r.get<std::uint32_t>();
+    if (num_layers < 2 || num_layers > 64) {
+        r.fail("layer count");
+    }
+    for (std::uint32_t l = 0; l < num_layers; ++l) {
+        std::int32_t size = r.get<std::int32_t>();
+        if (size <= 0 || size > kMaxLayerSize) {
+            r.fail("layer size");
+        }
+        config.layer_sizes.push_back(size);
+    }
+    // Bounds the actor's PolicySnapshot, which holds fp32 parameters whatever the encoding.
+    // At most 64 layers of kMaxLayerSize, so the count below cannot overflow.
+    constexpr std::size_t kSnapshotPrefixBytes =
+        sizeof(std::uint64_t) + sizeof(float) + sizeof(std::uint8_t);
+    if (num_parameters(config.layer_sizes) >
+        (kMaxPayloadBytes - kSnapshotPrefixBytes) / sizeof(float)) {
+        r.fail("network size");
+    }
+    if (config.n_step < 1) {
+        r.fail("n_step");
+    }
+    r.expect_end();
+    return config;
+}
+
+void encode_experiences(std::span<const Experience> experiences, const EpisodeStats& stats,
+                        std::vector<std::byte>& out) {
+    Writer w(out);
+    w.put(static_cast<std::uint32_t>(experiences.size()));
+    w.put(stats.episodes);
+    w.put(stats.pipes);
+    w.put(stats.return_sum);
+
+    // Columns, so each block is a flat array on the receiving side
+    for (const Experience& e : experiences) {
+        float state[kObservationSize];
+        write_observation(e.state, state);
+        w.put_array(state, kObservationSize);
+    }
+    for (const Experience& e : experiences) {
+        float next[kObservationSize];
+        write_observation(e.next_state, next);
+        w.put_array(next, kObservationSize);
+    }
+    for (const Experience& e : experiences) {
+        w.put(e.reward);
+    }
+    for (const Experience& e : experiences) {
+        std::uint8_t flags = (e.action == env_flappy::Action::FLAP ? kFlagFlap : 0) |
+                             (e.done ? kFlagDone : 0);
+        w.put(flags);
+    }
+}
+
+EpisodeStats decode_experiences(std::span<const std::byte> payload,
+                                std::vector<Experience>& out) {
+    Reader r(payload, "experiences");
+    std::uint32_t count = r.get<std::uint32_t>();
+    EpisodeStats stats;
+    stats.episodes = r.get<std::uint32_t>();
+    stats.pipes = r.get<std::uint32_t>();
+    stats.return_sum = r.get<double>();
+    if (count > payload.size() / kTransitionBytes) {
+        r.fail("count");
+    }
+
+    const std::size_t first = out.size();
+    out.resize(first + count);
+    std::span<Experience> batch(out.data() + first, count);
+    for (Experience& e : batch) {
+        float state[kObservationSize];
+        r.get_array(state, kObservationSize);
+        e.state = read_observation(state);
+    }
+    for (Experience& e : batch) {
+        float next[kObservationSize];
+        r.get_array(next, kObservationSize);
+        e.next_state = read_observation(next);
+    }
+    for (Experience& e : batch) {
+        e.reward = r.get<float>();
+    }
+    for (Experience& e : batch) {
+        std::uint8_t flags = r.get<std::uint8_t>();
+        e.action = (flags & kFlagFlap) ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+        e.done = (flags & kFlagDone) != 0;
+    }
+    r.expect_end();
+    return stats;
+}
+
+void encode_snapshot(std::span<const float> parameters, const std::vector<int>& layer_sizes,
+                     const SnapshotInfo& info, std::vector<std::byte>& out) {
+    if (parameters.size() != num_parameters(layer_sizes)) {
+        throw std::invalid_argument("Parameter count mismatch");
+    }
+    Writer w(out);
+    w.put(info.version);
+    w.put(info.epsilon);
+    w.put(static_cast<std::uint8_t>(info.encoding));
+    if (info.encoding == SnapshotEncoding::kFloat32) {
+        w.put_array(parameters.data(), parameters.size());
+        return;
+    }
+
+    QuantizedNetwork quantized(layer_sizes);
+    quantized.quantize(parameters);
+    for (std::size_t l = 0; l < quantized.num_layers(); ++l) {
+        std::span<const float> scales = quantized.scales(l);
+        std::span<const std::int8_t> weights = quantized.weights(l);
+        std::span<const float> biases = quantized.biases(l);
+        w.put_array(scales.data(), scales.size());
+        w.put_array(weights.data(), weights.size());
+        w.put_array(biases.data(), biases.size());
+    }
+}
+
+SnapshotInfo decode_snapshot(std::span<const std::byte> payload,
+                             const std::vector<int>& layer_sizes, std::span<float> parameters) {
+    if (parameters.size() != num_parameters(layer_sizes)) {
+        throw std::invalid_argument("Parameter count mismatch");
+    }
+    Reader r(payload, "snapshot");
+    SnapshotInfo info;
+    info.version = r.get<std::uint64_t>();
+    info.epsilon = r.get<float>();
+    std::uint8_t encoding = r.get<std::uint8_t>();
+    if (encoding == static_cast<std::uint8_t>(SnapshotEncoding::kFloat32)) {
+        info.encoding = SnapshotEncoding::kFloat32;
+        r.get_array(parameters.data(), parameters.size());
+    } else if (encoding == static_cast<std::uint8_t>(SnapshotEncoding::kInt8)) {
+        info.encoding = SnapshotEncoding::kInt8;
+        float* layer = parameters.data();
+        std::vector<float> scales;
+        std::vector<std::int8_t> weights;
+        for (std::size_t l = 0; l + 1 < layer_sizes.size(); ++l) {
+            const std::size_t in = static_cast<std::size_t>(layer_sizes[l]);
+            const std::size_t out = static_cast<std::size_t>(layer_sizes[l + 1]);
+            scales.resize(out);
+            weights.resize(out * in);
+            r.get_array(scales.data(), out);
+            r.get_array(weights.data(), out * in);
+            for (std::size_t o = 0; o < out; ++o) {
+                for (std::size_t j = 0; j < in; ++j) {
+                    layer[o * in + j] = scales[o] * static_cast<float>(weights[o * in + j]);
+                }
+            }
+            r.get_array(layer + out * in, out);
+            layer += out * (in + 1);
+        }
+    } else {
+        r.fail("snapshot encoding");
+    }
+    r.expect_end();
+    return info;
+}
+
+void send_message(core::TcpSocket& socket, MessageType type, std::span<const std::byte> payload) {
+    if (payload.size() > kMaxPayloadBytes) {
+        throw std::invalid_argument("Wire payload too large");
+    }
+    FrameHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.type = static_cast<std::uint16_t>(type);
+    header.payload_bytes = static_cast<std::uint32_t>(payload.size());
+    socket.send_all(std::as_bytes(std::span(&header, 1)));
+    socket.send_all(payload);
+}
+
+bool recv_message(core::TcpSocket& socket, MessageType& type, std::vector<std::byte>& payload) {
+    FrameHeader header;
+    if (!socket.recv_all(std::as_writable_bytes(std::span(&header, 1)))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a FlappyRL wire frame (bad magic)");
+    }
+    if (header.payload_bytes > kMaxPayloadBytes) {
+        throw std::runtime_error("Wire frame too large");
+    }
+    type = static_cast<MessageType>(header.type);
+    payload.resize(header.payload_bytes);
+    if (!payload.empty() && !socket.recv_all(payload)) {
+        throw std::runtime_error("Connection closed mid-message");
+    }
+    return true;
+}
+
+} // namespace wire
+} // namespace rl_dqn
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+#include "rl_dqn/checkpoint.h"
+#include "rl_dqn/dqn_agent.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+rl_dqn::DQNConfig small_config() {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 16, 2};
+    config.batch_size = 8;
+    return config;
+}
+
+void train_a_little(rl_dqn::DQNAgent& agent) {
+    env_flappy::FlappyEnv env(3);
+    env_flappy::Observation obs = env.reset(3);
+    for (int t = 0; t < 64; ++t) {
+        env_flappy::Action action = agent.select_action(obs);
+        env_flappy::StepResult result = env.step(action);
+        agent.store_experience(obs, action, result.reward, result.observation, result.done);
+        obs = result.done ? env.reset(t) : result.observation;
+        agent.train();
+    }
+    agent.update_target_network();
+}
+
+bool same(std::span<const float> a, std::span<const float> b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+} // namespace
+
+TEST_CASE("Checkpoint round trip restores the learner", "[checkpoint]") {
+    const std::string path = temp_path("flappyrl_roundtrip.ckpt");
+    rl_dqn::DQNAgent agent(small_config());
+    train_a_little(agent);
+    agent.save_weights(path);
+
+    rl_dqn::Checkpoint checkpoint(path);
+    REQUIRE(checkpoint.has_training_state());
+    REQUIRE(checkpoint.layer_sizes() == std::vector<int>{4, 16, 2});
+    REQUIRE(reinterpret_cast<std::uintptr_t>(checkpoint.parameters().data()) % 64 == 0);
+    REQUIRE(same(checkpoint.parameters(), agent.learner().network().parameters()));
+    REQUIRE(checkpoint.header().adam_step == agent.get_training_steps());
+
+    rl_dqn::DQNAgent restored(small_config());
+    restored.load_weights(path);
+    REQUIRE(same(restored.learner().network().parameters(),
+                 agent.learner().network().parameters()));
+    REQUIRE(same(restored.learner().target_network().parameters(),
+                 agent.learner().target_network().parameters()));
+    REQUIRE(restored.get_training_steps() == agent.get_training_steps());
+    REQUIRE(restored.get_total_steps() == agent.get_total_steps());
+    REQUIRE(restored.get_epsilon() == agent.get_epsilon());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Inference-only checkpoints hold just the online network", "[checkpoint]") {
+    const std::string path = temp_path("flappyrl_inference.ckpt");
+    rl_dqn::DQNLearner learner(small_config());
+    rl_dqn::write_checkpoint(path, learner.checkpoint_contents(false));
+
+    rl_dqn::Checkpoint checkpoint(path);
+    REQUIRE(!checkpoint.has_training_state());
+    REQUIRE(checkpoint.target_parameters().empty());
+    REQUIRE(same(checkpoint.parameters(), learner.network().parameters()));
+    // Header, layer sizes padded to 64 bytes, 114 floats padded to 512 bytes
+    REQUIRE(std::filesystem::file_size(path) == rl_dqn::kCheckpointHeaderSize + 64 + 512);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Corrupt or mismatched checkpoints are rejected", "[checkpoint]") {
+    const std::string path = temp_path("flappyrl_corrupt.ckpt");
+    rl_dqn::DQNLearner learner(small_config());
+    rl_dqn::write_checkpoint(path, learner.checkpoint_contents(true));
+
+    // Different architecture
+    rl_dqn::DQNConfig other = small_config();
+    other.layer_sizes = {4, 8, 2};
+    rl_dqn::DQNLearner other_learner(other);
+    REQUIRE_THROWS_AS(other_learner.load_checkpoint(rl_dqn::Checkpoint(path)),
+                      std::invalid_argument);
+
+    // Flip one parameter byte: the checksum catches it unless verification is skipped
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) - 5));
+        file.put('\x7f');
+    }
+    REQUIRE_THROWS_AS(rl_dqn::Checkpoint(path), std::runtime_error);
+    REQUIRE_NOTHROW(rl_dqn::Checkpoint(path, false));
+
+    // A parameter count the file cannot hold is rejected before it is used for sizes
+    {
+        rl_dqn::CheckpointHeader header = rl_dqn::Checkpoint(path, false).header();
+        header.num_parameters = std::uint64_t{1} << 62;
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    REQUIRE_THROWS_AS(rl_dqn::Checkpoint(path, false), std::runtime_error);
+
+    // Truncated file
+    std::filesystem::resize_file(path, 100);
+    REQUIRE_THROWS_AS(rl_dqn::Checkpoint(path), std::runtime_error);
+    REQUIRE_THROWS_AS(rl_dqn::Checkpoint(temp_path("flappyrl_missing.ckpt")),
+                      std::runtime_error);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,252 @@
+#include <catch2/catch_test_macros.hpp>
+#include "core/latest_value.h"
+#include "core/rng.h"
+#include "core/spsc_queue.h"
+#include "core/telemetry.h"
+#include "core/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SPSC queue preserves order across threads", "[core]") {
+    core::SpscQueue<std::uint64_t> queue(100);
+    REQUIRE(queue.capacity() == 128);
+
+    const std::uint64_t count = 200000;
+    std::thread producer([&queue, count]() {
+        for (std::uint64_t i = 0; i < count; ++i) {
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<std::uint64_t> out(37);
+    std::uint64_t expected = 0;
+    bool in_order = true;
+    while (expected < count) {
+        std::size_t popped = queue.try_pop(out.data(), out.size());
+        for (std::size_t k = 0; k < popped; ++k) {
+            in_order = in_order && out[k] == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.try_pop(out.data(), out.size()) == 0);
+}
+
+TEST_CASE("SPSC queue rejects pushes when full", "[core]") {
+    core::SpscQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.try_push(i));
+    }
+    REQUIRE(!queue.try_push(4));
+
+    int out[2];
+    REQUIRE(queue.try_pop(out, 2) == 2);
+    REQUIRE(out[0] == 0);
+    REQUIRE(out[1] == 1);
+    REQUIRE(queue.try_push(4));
+    REQUIRE(queue.size_approx() == 3);
+}
+
+TEST_CASE("Latest value hands over whole values in order", "[core]") {
+    struct Sample {
+        std::uint64_t id = 0;
+        std::uint64_t words[15] = {};   // all equal to id unless a publish was torn
+    };
+    core::LatestValue<Sample> latest;
+    REQUIRE(!latest.update());
+    REQUIRE(latest.value().id == 0);
+
+    const std::uint64_t count = 200000;
+    std::thread producer([&latest, count]() {
+        Sample sample;
+        for (std::uint64_t i = 1; i <= count; ++i) {
+            sample.id = i;
+            for (std::uint64_t& word : sample.words) {
+                word = i;
+            }
+            latest.publish(sample);
+        }
+    });
+
+    std::uint64_t last = 0;
+    bool consistent = true;
+    while (last < count) {
+        if (!latest.update()) {
+            continue;
+        }
+        const Sample& sample = latest.value();
+        consistent = consistent && sample.id > last;
+        for (std::uint64_t word : sample.words) {
+            consistent = consistent && word == sample.id;
+        }
+        last = sample.id;
+    }
+    producer.join();
+
+    REQUIRE(consistent);
+    REQUIRE(!latest.update());
+    REQUIRE(latest.value().id == count);
+}
+
+TEST_CASE("Pcg32 matches the reference generator", "[core]") {
+    // First outputs of the pcg32 reference demo for seed 42, stream 54
+    core::Pcg32 rng(42, 54);
+    const std::uint32_t expected[] = {0xa15c02b7u, 0x7b47f409u, 0xba1d3330u,
+                                      0x83d2f293u, 0xbfa4784bu, 0xcbed606eu};
+    for (std::uint32_t value : expected) {
+        REQUIRE(rng() == value);
+    }
+
+    core::Pcg32 copy = rng;
+    REQUIRE(copy == rng);
+    for (int i = 0; i < 1000; ++i) {
+        float u = rng.uniform();
+        REQUIRE(u >= 0.0f);
+        REQUIRE(u < 1.0f);
+    }
+    REQUIRE_FALSE(copy == rng);
+}
+
+TEST_CASE("Telemetry sums per-thread probe slots", "[core]") {
+    using core::telemetry::Probe;
+    core::telemetry::Snapshot before = core::telemetry::snapshot();
+
+    // Threads that exit before the snapshot still count
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) {
+                core::telemetry::record(Probe::kReplaySample, 10, 32);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    {
+        core::telemetry::ScopedTimer timer(Probe::kReplaySample, 8);
+    }
+
+    core::telemetry::Snapshot delta = core::telemetry::snapshot() - before;
+    REQUIRE(delta[Probe::kReplaySample].calls == 4001);
+    REQUIRE(delta[Probe::kReplaySample].items == 4 * 1000 * 32 + 8);
+    REQUIRE(delta[Probe::kReplaySample].nanoseconds >= 4 * 1000 * 10);
+    REQUIRE(std::string(core::telemetry::probe_name(Probe::kTargetSync)) == "target_sync");
+}
+
+TEST_CASE("Telemetry training log writes CSV rows", "[core]") {
+    const std::string path = "telemetry_test_log.csv";
+    core::telemetry::Snapshot probes;
+    probes.probes[static_cast<std::size_t>(core::telemetry::Probe::kEnvStep)] = {3, 24, 2000000};
+    {
+        core::telemetry::TrainingLog log(path);
+        const core::telemetry::Metric metrics[] = {{"env_steps", 1000}, {"loss", 0.25}};
+        log.write(metrics, probes);
+        log.write(metrics, probes);
+    }
+
+    std::ifstream in(path);
+    std::string header, row, second;
+    std::getline(in, header);
+    std::getline(in, row);
+    std::getline(in, second);
+    REQUIRE(header.rfind("env_steps,loss,env_step_ms,env_step_calls,", 0) == 0);
+    REQUIRE(row.rfind("1000,0.25,2,3,", 0) == 0);
+    REQUIRE(second == row);  // header only once
+    in.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Telemetry training log writes non-finite JSON values as null", "[core]") {
+    const std::string path = "telemetry_test_log.json";
+    {
+        core::telemetry::TrainingLog log(path);
+        const core::telemetry::Metric metrics[] = {
+            {"env_steps", 1000}, {"loss", std::numeric_limits<double>::quiet_NaN()},
+            {"episode_return", std::numeric_limits<double>::infinity()}};
+        log.write(metrics, core::telemetry::Snapshot{});
+    }
+
+    std::ifstream in(path);
+    std::string row;
+    std::getline(in, row);
+    REQUIRE(row.rfind("{\"env_steps\":1000,\"loss\":null,\"episode_return\":null,", 0) == 0);
+    REQUIRE(row.find("nan") == std::string::npos);
+    REQUIRE(row.find("inf") == std::string::npos);
+    in.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Thread pool runs every index once under ragged load", "[core]") {
+    core::ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    for (int round = 0; round < 3; ++round) {  // the pool is reused across loops
+        const std::size_t count = 1000;
+        std::vector<std::atomic<int>> runs(count);
+        std::vector<std::atomic<int>> busy(pool.size());
+        std::atomic<bool> overlap{false};
+        pool.parallel_for(count, [&](std::size_t i, std::size_t worker) {
+            // No two bodies share a worker id at the same time
+            if (busy[worker].fetch_add(1) != 0) {
+                overlap = true;
+            }
+            if (i % 97 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));  // a long episode
+            }
+            runs[i].fetch_add(1);
+            busy[worker].fetch_sub(1);
+        });
+        REQUIRE_FALSE(overlap);
+        for (const std::atomic<int>& r : runs) {
+            REQUIRE(r.load() == 1);
+        }
+    }
+
+    // Single-worker pools run inline
+    core::ThreadPool inline_pool(1);
+    std::size_t sum = 0;
+    inline_pool.parallel_for(10, [&](std::size_t i, std::size_t worker) {
+        REQUIRE(worker == 0);
+        sum += i;
+    });
+    REQUIRE(sum == 45);
+}
+
+TEST_CASE("Thread pool propagates exceptions and rejects nesting", "[core]") {
+    core::ThreadPool pool(3);
+    REQUIRE_THROWS_AS(pool.parallel_for(100, [](std::size_t i, std::size_t) {
+        if (i == 42) {
+            throw std::runtime_error("body failed");
+        }
+    }), std::runtime_error);
+
+    REQUIRE_THROWS_AS(pool.parallel_for(4, [&](std::size_t, std::size_t) {
+        pool.parallel_for(1, [](std::size_t, std::size_t) {});
+    }), std::logic_error);
+
+    // Still usable afterwards
+    std::atomic<std::size_t> done{0};
+    pool.parallel_for(50, [&](std::size_t, std::size_t) { done.fetch_add(1); });
+    REQUIRE(done.load() == 50);
+
+    // Loops on other pools nest
+    std::atomic<std::size_t> nested{0};
+    pool.parallel_for(4, [&](std::size_t, std::size_t) {
+        core::ThreadPool inner(1);
+        inner.parallel_for(3, [&](std::size_t, std::size_t) { nested.fetch_add(1); });
+    });
+    REQUIRE(nested.load() == 12);
+}
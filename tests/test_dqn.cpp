@@ -1,7 +1,86 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include "rl_dqn/dqn_agent.h"
+#include "rl_dqn/evaluation.h"
+#include "rl_dqn/fixed_network.h"
+#include "rl_dqn/inference.h"
+#include "rl_dqn/mapped_replay_buffer.h"
+#include "rl_dqn/n_step.h"
+#include "rl_dqn/quantized_network.h"
+#include "rl_dqn/policy.h"
+#include "rl_dqn/remote.h"
+#include "rl_dqn/sweep.h"
+#include "rl_dqn/wire.h"
 #include "env_flappy/env_flappy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Count every heap allocation in the test binary, so tests can assert a hot path makes none.
+// The array, nothrow and sized forms all forward to these by default.
+namespace {
+std::atomic<std::size_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* p = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc wants the size rounded up to a multiple of the alignment
+    std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    void* p = std::aligned_alloc(align, rounded);
+#endif
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// GCC inlines these into callers, pairs the std::free with the replaced operator new above and
+// reports -Wmismatched-new-delete, although both are this file's own malloc-based pair
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
 
 TEST_CASE("DQN Network Forward Pass", "[dqn]") {
     rl_dqn::Network network({4, 8, 2}, 12345);
@@ -102,6 +181,122 @@ TEST_CASE("DQN Agent Training", "[dqn]") {
     REQUIRE(std::isfinite(loss2));
 }
 
+TEST_CASE("Target Network Sync Copies Weights And Biases", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 8, 2};
+    config.batch_size = 4;
+    config.replay_buffer_size = 100;
+    rl_dqn::DQNLearner learner(config);
+
+    env_flappy::Observation state{0.5f, 0.1f, 1.0f, 0.2f};
+    env_flappy::Observation next{0.4f, 0.2f, 0.8f, 0.1f};
+    for (int i = 0; i < 8; ++i) {
+        learner.store({state, env_flappy::Action::FLAP, 1.0f, next, i % 4 == 0});
+    }
+    for (int i = 0; i < 5; ++i) {
+        (void)learner.train();
+    }
+
+    // Training only moves the main network; biases start at zero and become non-zero
+    auto main_params = learner.network().parameters();
+    rl_dqn::ConstLayerView last = learner.network().layer(learner.network().num_layers() - 1);
+    REQUIRE(std::any_of(last.biases, last.biases + last.fan_out,
+                        [](float b) { return b != 0.0f; }));
+
+    std::vector<float> old_target(learner.target_network().parameters().begin(),
+                                  learner.target_network().parameters().end());
+    const float tau = 0.25f;
+    learner.soft_update_target_network(tau);
+    auto soft = learner.target_network().parameters();
+    for (std::size_t i = 0; i < soft.size(); ++i) {
+        REQUIRE(soft[i] ==
+                Catch::Approx(old_target[i] + tau * (main_params[i] - old_target[i])).margin(1e-6));
+    }
+
+    learner.update_target_network();
+    auto target = learner.target_network().parameters();
+    REQUIRE(std::equal(target.begin(), target.end(), main_params.begin(), main_params.end()));
+}
+
+TEST_CASE("N-Step Accumulator Folds Discounted Returns", "[dqn]") {
+    const float gamma = 0.5f;
+    rl_dqn::NStepAccumulator accumulator(3, gamma);
+    std::vector<rl_dqn::Experience> out;
+
+    auto obs = [](float y) { return env_flappy::Observation{y, 0.0f, 0.0f, 0.0f}; };
+    auto step = [&](float y, float reward, bool done) {
+        return rl_dqn::Experience{obs(y), env_flappy::Action::FLAP, reward, obs(y + 1.0f), done};
+    };
+
+    // The window fills before anything is emitted
+    accumulator.push(step(0.0f, 1.0f, false), out);
+    accumulator.push(step(1.0f, 2.0f, false), out);
+    REQUIRE(out.empty());
+    accumulator.push(step(2.0f, 4.0f, false), out);
+    REQUIRE(out.size() == 1);
+    REQUIRE(out[0].state.y == 0.0f);
+    REQUIRE(out[0].next_state.y == 3.0f);
+    REQUIRE(out[0].reward == Catch::Approx(1.0f + 0.5f * 2.0f + 0.25f * 4.0f));
+    REQUIRE_FALSE(out[0].done);
+
+    // A terminal step flushes the whole window as shorter terminal returns
+    out.clear();
+    accumulator.push(step(3.0f, 8.0f, true), out);
+    REQUIRE(out.size() == 3);
+    REQUIRE(out[0].state.y == 1.0f);
+    REQUIRE(out[0].reward == Catch::Approx(2.0f + 0.5f * 4.0f + 0.25f * 8.0f));
+    REQUIRE(out[1].state.y == 2.0f);
+    REQUIRE(out[1].reward == Catch::Approx(4.0f + 0.5f * 8.0f));
+    REQUIRE(out[2].state.y == 3.0f);
+    REQUIRE(out[2].reward == Catch::Approx(8.0f));
+    for (const rl_dqn::Experience& e : out) {
+        REQUIRE(e.done);
+        REQUIRE(e.next_state.y == 4.0f);
+    }
+    REQUIRE(accumulator.pending() == 0);
+
+    // n = 1 is a pass-through
+    rl_dqn::NStepAccumulator single(1, gamma);
+    out.clear();
+    single.push(step(0.0f, 3.0f, false), out);
+    REQUIRE(out.size() == 1);
+    REQUIRE(out[0].reward == 3.0f);
+
+    REQUIRE_THROWS_AS(rl_dqn::NStepAccumulator(0, gamma), std::invalid_argument);
+}
+
+TEST_CASE("Double DQN Matches DQN While Target Equals Online", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 8, 2};
+    config.batch_size = 4;
+    config.replay_buffer_size = 100;
+    config.n_step = 3;
+    rl_dqn::DQNConfig double_config = config;
+    double_config.double_dqn = true;
+
+    rl_dqn::DQNLearner learner(config);
+    rl_dqn::DQNLearner double_learner(double_config);
+    for (int i = 0; i < 8; ++i) {
+        env_flappy::Observation state{0.1f * i, 0.2f, 0.8f - 0.1f * i, 0.05f * i};
+        env_flappy::Observation next{0.1f * i + 0.05f, 0.1f, 0.7f - 0.1f * i, 0.0f};
+        rl_dqn::Experience exp{state, env_flappy::Action::NO_FLAP, 0.5f, next, i == 7};
+        learner.store(exp);
+        double_learner.store(exp);
+    }
+
+    // Right after a sync the online network's argmax is the target's, so both agree exactly
+    float loss = learner.train();
+    float double_loss = double_learner.train();
+    REQUIRE(loss > 0.0f);
+    REQUIRE(double_loss == loss);
+    auto a = learner.network().parameters();
+    auto b = double_learner.network().parameters();
+    REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    config.n_step = 0;
+    REQUIRE_THROWS_AS(rl_dqn::DQNLearner(config), std::invalid_argument);
+}
+
 TEST_CASE("Replay Buffer", "[dqn]") {
     rl_dqn::ReplayBuffer buffer(10, 12345);
     
@@ -129,3 +324,1106 @@ TEST_CASE("Replay Buffer", "[dqn]") {
     REQUIRE(batch.size() == 5);
 }
 
+TEST_CASE("Replay Buffer Samples Distinct Experiences", "[dqn]") {
+    rl_dqn::ReplayBuffer buffer(50, 7);
+    rl_dqn::Experience exp{};
+    for (int i = 0; i < 50; ++i) {
+        exp.reward = static_cast<float>(i);
+        buffer.push(exp);
+    }
+
+    std::vector<rl_dqn::Experience> batch;
+    std::vector<int> hits(50, 0);
+    for (int round = 0; round < 200; ++round) {
+        buffer.sample(8, batch);
+        REQUIRE(batch.size() == 8);
+        std::vector<bool> seen(50, false);
+        for (const auto& e : batch) {
+            int id = static_cast<int>(e.reward);
+            REQUIRE(!seen[id]);
+            seen[id] = true;
+            ++hits[id];
+        }
+    }
+    // 1600 draws over 50 slots: every slot must come up
+    for (int h : hits) {
+        REQUIRE(h > 0);
+    }
+
+    // Sampling the whole buffer yields a permutation of it
+    buffer.sample(50, batch);
+    std::vector<bool> seen(50, false);
+    for (const auto& e : batch) {
+        seen[static_cast<int>(e.reward)] = true;
+    }
+    REQUIRE(std::find(seen.begin(), seen.end(), false) == seen.end());
+    REQUIRE_THROWS_AS(buffer.sample(51, batch), std::runtime_error);
+}
+
+TEST_CASE("Replay Buffer Gathers Column Batches", "[dqn]") {
+    // Same seed and contents: both sampling paths must pick the same slots
+    rl_dqn::ReplayBuffer rows(16, 3);
+    rl_dqn::ReplayBuffer columns(16, 3);
+    for (int i = 0; i < 20; ++i) {  // wraps the ring
+        rl_dqn::Experience exp;
+        float f = static_cast<float>(i);
+        exp.state = {f, -f, 0.5f * f, 2.0f * f};
+        exp.action = i % 3 == 0 ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+        exp.reward = 10.0f + f;
+        exp.next_state = {f + 1.0f, -f - 1.0f, 0.25f * f, 3.0f * f};
+        exp.done = i % 4 == 0;
+        rows.push(exp);
+        columns.push(exp);
+    }
+    REQUIRE(columns.size() == 16);
+    REQUIRE(columns.at(0).reward == 26.0f);  // slot 0 was overwritten by experience 16
+
+    std::vector<rl_dqn::Experience> expected;
+    rl_dqn::TransitionBatch batch;
+    rows.sample(6, expected);
+    columns.sample(6, batch);
+    REQUIRE(batch.size == 6);
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        const float* s = batch.states.data() + i * rl_dqn::kObservationSize;
+        const float* ns = batch.next_states.data() + i * rl_dqn::kObservationSize;
+        REQUIRE(s[0] == expected[i].state.y);
+        REQUIRE(s[1] == expected[i].state.vy);
+        REQUIRE(s[2] == expected[i].state.dx_to_pipe);
+        REQUIRE(s[3] == expected[i].state.dy_to_gap);
+        REQUIRE(ns[0] == expected[i].next_state.y);
+        REQUIRE(ns[3] == expected[i].next_state.dy_to_gap);
+        REQUIRE(batch.actions[i] == expected[i].action);
+        REQUIRE(batch.rewards[i] == expected[i].reward);
+        REQUIRE(static_cast<bool>(batch.dones[i]) == expected[i].done);
+    }
+}
+
+
+TEST_CASE("Mapped Replay Buffer Matches The In-Memory Ring And Persists", "[dqn]") {
+    const std::string directory =
+        (std::filesystem::temp_directory_path() / "flappy_test_mapped_replay").string();
+    std::filesystem::remove_all(directory);
+    auto experience = [](int i) {
+        float f = static_cast<float>(i);
+        return rl_dqn::Experience{{f, -f, 0.5f * f, 2.0f * f},
+                                  i % 3 == 0 ? env_flappy::Action::FLAP
+                                             : env_flappy::Action::NO_FLAP,
+                                  10.0f + f,
+                                  {f + 1.0f, -f - 1.0f, 0.25f * f, 3.0f * f},
+                                  i % 4 == 0};
+    };
+    auto same = [](const rl_dqn::Experience& a, const rl_dqn::Experience& b) {
+        return a.state.y == b.state.y && a.state.dy_to_gap == b.state.dy_to_gap &&
+               a.next_state.vy == b.next_state.vy && a.action == b.action &&
+               a.reward == b.reward && a.done == b.done;
+    };
+
+    // 4 segments of 4 slots; 22 pushes wrap the ring and leave a partial tail over segment 0
+    rl_dqn::ReplayBuffer reference(16, 3);
+    {
+        rl_dqn::MappedReplayBuffer mapped(directory, 16, 4, 3);
+        for (int i = 0; i < 22; ++i) {
+            reference.push(experience(i));
+            mapped.push(experience(i));
+        }
+        REQUIRE(mapped.size() == 16);
+        REQUIRE(mapped.mapped_segments() == 4);
+        for (std::size_t i = 0; i < 16; ++i) {
+            REQUIRE(same(mapped.at(i), reference.at(i)));
+        }
+
+        // Same seed, same slots: batches match the in-memory buffer exactly
+        rl_dqn::TransitionBatch expected;
+        rl_dqn::TransitionBatch batch;
+        reference.sample(6, expected);
+        mapped.sample(6, batch);
+        REQUIRE(batch.slots == expected.slots);
+        REQUIRE(std::equal(batch.states.begin(), batch.states.end(), expected.states.begin()));
+        REQUIRE(std::equal(batch.next_states.begin(), batch.next_states.end(),
+                           expected.next_states.begin()));
+        REQUIRE(batch.actions == expected.actions);
+        REQUIRE(batch.rewards == expected.rewards);
+        REQUIRE(batch.dones == expected.dones);
+        REQUIRE(batch.weights == expected.weights);
+    }
+    auto files = [&] {
+        return std::distance(std::filesystem::directory_iterator(directory),
+                             std::filesystem::directory_iterator());
+    };
+    REQUIRE(files() == 5);  // four sealed segments and the flushed tail
+
+    // Reopening maps the segments and resumes the ring where it stopped
+    {
+        rl_dqn::MappedReplayBuffer mapped(directory, 16, 4, 3);
+        REQUIRE(mapped.size() == 16);
+        for (int i = 22; i < 27; ++i) {
+            reference.push(experience(i));
+            mapped.push(experience(i));
+        }
+        for (std::size_t i = 0; i < 16; ++i) {
+            REQUIRE(same(mapped.at(i), reference.at(i)));
+        }
+        REQUIRE_THROWS_AS(rl_dqn::MappedReplayBuffer(directory, 16, 8), std::runtime_error);
+
+        mapped.clear();
+        REQUIRE(mapped.size() == 0);
+        REQUIRE(files() == 0);
+    }
+    REQUIRE(rl_dqn::MappedReplayBuffer(directory, 10, 4).capacity() == 12);
+    REQUIRE_THROWS_AS(rl_dqn::MappedReplayBuffer(directory, 16, 0), std::invalid_argument);
+    std::filesystem::remove_all(directory);
+}
+
+
+TEST_CASE("Sum Tree Matches Brute Force", "[dqn]") {
+    const std::size_t n = 1000;  // three levels with padding
+    rl_dqn::SumTree single(n);
+    rl_dqn::SumTree bulk(n);
+    std::vector<float> reference(n, 0.0f);
+
+    std::uint32_t lcg = 1;
+    auto next = [&lcg]() {
+        lcg = lcg * 1664525u + 1013904223u;
+        return lcg >> 8;
+    };
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::size_t> indices;
+        std::vector<float> priorities;
+        for (int k = 0; k < 64; ++k) {
+            indices.push_back(next() % n);
+            priorities.push_back(static_cast<float>(next() % 1000 + 1));
+        }
+        bulk.set(indices, priorities);
+        for (std::size_t k = 0; k < indices.size(); ++k) {
+            single.set(indices[k], priorities[k]);
+            reference[indices[k]] = priorities[k];
+        }
+    }
+
+    double total = 0.0;
+    float lowest = std::numeric_limits<float>::infinity();
+    for (float p : reference) {
+        total += p;
+        if (p > 0.0f) {
+            lowest = std::min(lowest, p);
+        }
+    }
+    REQUIRE(single.total() == bulk.total());
+    REQUIRE(single.total() == Catch::Approx(total));
+    REQUIRE(bulk.min() == lowest);
+
+    // find() lands on the leaf whose cumulative range holds the mass
+    double prefix = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (reference[i] > 0.0f) {
+            REQUIRE(bulk.find(static_cast<float>(prefix + 0.5 * reference[i])) == i);
+        }
+        prefix += reference[i];
+    }
+    REQUIRE(reference[bulk.find(bulk.total() * 2.0f)] > 0.0f);
+}
+
+TEST_CASE("Prioritized Replay Samples Proportionally", "[dqn]") {
+    rl_dqn::PrioritizedReplayBuffer buffer(8, 1.0f, 0.0f, 11);
+    rl_dqn::Experience exp{};
+    for (int i = 0; i < 8; ++i) {
+        exp.reward = static_cast<float>(i);
+        buffer.push(exp);
+        REQUIRE(buffer.priority(i) == 1.0f);  // new experiences get the max priority
+    }
+
+    // alpha = 1, epsilon = 0: priority equals |td error|
+    std::vector<std::size_t> slots = {0, 1, 2, 3, 4, 5, 6, 7};
+    std::vector<float> errors = {1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -9.0f};
+    buffer.update_priorities(slots, errors);
+    REQUIRE(buffer.priority(7) == 9.0f);
+
+    buffer.set_beta(1.0f);
+    rl_dqn::TransitionBatch batch;
+    int hits_heavy = 0, draws = 0;
+    for (int round = 0; round < 500; ++round) {
+        buffer.sample(4, batch);
+        for (std::size_t i = 0; i < batch.size; ++i) {
+            ++draws;
+            REQUIRE(batch.rewards[i] == static_cast<float>(batch.slots[i]));
+            if (batch.slots[i] == 7) {
+                ++hits_heavy;
+                REQUIRE(batch.weights[i] == Catch::Approx(1.0f / 9.0f));
+            } else {
+                REQUIRE(batch.weights[i] == Catch::Approx(1.0f));
+            }
+        }
+    }
+    // Slot 7 holds 9 of the 16 units of priority mass
+    REQUIRE(static_cast<double>(hits_heavy) / draws == Catch::Approx(9.0 / 16.0).margin(0.03));
+
+    // A new experience overwrites slot 0 and gets the max priority seen (9)
+    buffer.push(exp);
+    REQUIRE(buffer.priority(0) == 9.0f);
+}
+
+TEST_CASE("DQN Agent Trains With Prioritized Replay", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 16, 2};
+    config.batch_size = 8;
+    config.prioritized_replay = true;
+    rl_dqn::DQNAgent agent(config);
+
+    env_flappy::Observation state{0.5f, 0.0f, 0.8f, 0.1f};
+    for (int i = 0; i < 32; ++i) {
+        env_flappy::Observation next{0.5f, 0.01f * i, 0.8f - 0.01f * i, 0.1f};
+        auto action = i % 2 ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+        agent.store_experience(state, action, i % 7 == 0 ? 1.0f : 0.0f, next, i % 11 == 0);
+        state = next;
+    }
+    for (int i = 0; i < 10; ++i) {
+        float loss = agent.train();
+        REQUIRE(std::isfinite(loss));
+    }
+    REQUIRE(agent.get_training_steps() == 10);
+}
+
+TEST_CASE("Policy Snapshot Mirrors The Learner Network", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 16, 2};
+    rl_dqn::DQNLearner learner(config);
+    rl_dqn::Policy policy(config, 5);
+
+    // Policy starts from different weights; a published snapshot makes them identical
+    rl_dqn::PolicySnapshot snapshot(learner.network().parameters().size());
+    REQUIRE(snapshot.version() == 0);
+    learner.network().parameters()[0] += 0.5f;
+    snapshot.publish(learner.network().parameters());
+    REQUIRE(snapshot.read(policy) == 1);
+
+    auto params = policy.network().parameters();
+    auto expected = learner.network().parameters();
+    REQUIRE(std::equal(params.begin(), params.end(), expected.begin(), expected.end()));
+
+    for (int i = 0; i < 20; ++i) {
+        env_flappy::Observation obs{0.05f * i, 0.1f - 0.01f * i, 0.9f - 0.04f * i, 0.02f * i};
+        std::vector<float> q = learner.network().forward({obs.y, obs.vy, obs.dx_to_pipe,
+                                                          obs.dy_to_gap});
+        auto greedy = q[1] > q[0] ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+        REQUIRE(policy.greedy_action(obs) == greedy);
+        REQUIRE(policy.select_action(obs, 0.0f) == greedy);
+    }
+}
+
+TEST_CASE("DQN Network Flat Parameter Layout", "[dqn]") {
+    rl_dqn::Network network({4, 8, 2}, 12345);
+
+    // One contiguous, cache-line aligned buffer holding every weight and bias
+    auto params = network.parameters();
+    REQUIRE(params.size() == static_cast<std::size_t>(network.get_num_parameters()));
+    REQUIRE(params.size() == (4 * 8 + 8) + (8 * 2 + 2));
+    REQUIRE(reinterpret_cast<std::uintptr_t>(params.data()) % core::kCacheLineSize == 0);
+
+    // Layer views agree with the nested copies
+    auto weights = network.get_weights();
+    auto biases = network.get_biases();
+    REQUIRE(network.num_layers() == 2);
+    for (std::size_t l = 0; l < network.num_layers(); ++l) {
+        rl_dqn::ConstLayerView view = std::as_const(network).layer(l);
+        REQUIRE(view.weights == params.data() + network.layer_offset(l));
+        for (int i = 0; i < view.fan_out; ++i) {
+            REQUIRE(view.biases[i] == biases[l][i]);
+            for (int j = 0; j < view.fan_in; ++j) {
+                REQUIRE(view.row(i)[j] == weights[l][i][j]);
+            }
+        }
+    }
+
+    // Writing through the nested API lands in the flat buffer
+    weights[1][1][3] = 42.0f;
+    biases[0][5] = -7.0f;
+    network.set_weights(weights);
+    network.set_biases(biases);
+    REQUIRE(network.layer(1).row(1)[3] == 42.0f);
+    REQUIRE(network.layer(0).biases[5] == -7.0f);
+}
+
+TEST_CASE("DQN Network Batched Forward Matches Single", "[dqn]") {
+    rl_dqn::Network network({4, 16, 8, 2}, 777);
+
+    // 7 rows exercises both the tiled rows and the remainder
+    const int batch_size = 7;
+    std::vector<float> inputs(batch_size * 4);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = std::sin(0.37f * static_cast<float>(i));
+    }
+
+    rl_dqn::Network::BatchCache cache;
+    const float* batch_out = network.forward_batch(inputs, batch_size, cache);
+
+    for (int b = 0; b < batch_size; ++b) {
+        std::vector<float> row(inputs.begin() + b * 4, inputs.begin() + (b + 1) * 4);
+        std::vector<float> single = network.forward(row);
+        REQUIRE(batch_out[b * 2] == Catch::Approx(single[0]).margin(1e-5));
+        REQUIRE(batch_out[b * 2 + 1] == Catch::Approx(single[1]).margin(1e-5));
+    }
+}
+
+TEST_CASE("Inference Context Batched Actions Match Single Forward", "[dqn]") {
+    rl_dqn::Network network({4, 16, 8, 2}, 31);
+    std::vector<env_flappy::Observation> observations(9);
+    for (std::size_t i = 0; i < observations.size(); ++i) {
+        float t = static_cast<float>(i);
+        observations[i] = {std::sin(t), std::cos(0.7f * t), 0.1f * t, -0.05f * t};
+    }
+
+    rl_dqn::InferenceContext inference;
+    std::vector<env_flappy::Action> actions(observations.size());
+    inference.greedy_actions(network, observations, actions);
+    for (std::size_t i = 0; i < observations.size(); ++i) {
+        const env_flappy::Observation& o = observations[i];
+        std::vector<float> q = network.forward({o.y, o.vy, o.dx_to_pipe, o.dy_to_gap});
+        env_flappy::Action expected =
+            q[1] > q[0] ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+        REQUIRE(actions[i] == expected);
+    }
+
+    // epsilon = 0 is greedy, epsilon = 1 ignores the network
+    std::vector<env_flappy::Action> explored(observations.size());
+    core::Pcg32 rng(5);
+    inference.epsilon_greedy_actions(network, observations, 0.0f, rng, explored);
+    REQUIRE(explored == actions);
+
+    int flaps = 0;
+    std::vector<env_flappy::Action> random_actions(1);
+    for (int i = 0; i < 2000; ++i) {
+        inference.epsilon_greedy_actions(network, {observations.data(), 1}, 1.0f, rng,
+                                         random_actions);
+        flaps += random_actions[0] == env_flappy::Action::FLAP ? 1 : 0;
+    }
+    REQUIRE(flaps > 850);
+    REQUIRE(flaps < 1150);
+
+    REQUIRE_THROWS_AS(inference.greedy_actions(network, observations, random_actions),
+                      std::invalid_argument);
+
+    // A row-major observation matrix goes to the network as is
+    std::vector<float> matrix(observations.size() * rl_dqn::kObservationSize);
+    for (std::size_t i = 0; i < observations.size(); ++i) {
+        rl_dqn::write_observation(observations[i], matrix.data() + i * rl_dqn::kObservationSize);
+    }
+    std::vector<env_flappy::Action> from_matrix(observations.size());
+    inference.greedy_actions(network, std::span<const float>(matrix), from_matrix);
+    REQUIRE(from_matrix == actions);
+    REQUIRE_THROWS_AS(inference.q_values(network, std::span<const float>(matrix.data(), 5)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Observation Normalization Folds Into The First Layer", "[dqn]") {
+    using Schema = env_flappy::ObservationSchema;
+    auto normalize = [](const env_flappy::Observation& raw) {
+        float row[rl_dqn::kObservationSize];
+        rl_dqn::write_observation(raw, row);
+        for (std::size_t i = 0; i < rl_dqn::kObservationSize; ++i) {
+            row[i] = Schema::scale(i) * row[i] + Schema::shift(i);
+        }
+        return rl_dqn::read_observation(row);
+    };
+    auto input = [](const env_flappy::Observation& o) {
+        std::vector<float> row(rl_dqn::kObservationSize);
+        rl_dqn::write_observation(o, row.data());
+        return row;
+    };
+
+    // A normalizing learner fed raw observations must train exactly like a plain learner
+    // fed normalized ones, and keep doing so: the transform is part of every pass
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 16, 2};
+    config.batch_size = 8;
+    config.seed = 8;
+    rl_dqn::DQNLearner plain(config);
+    config.normalize_observations = true;
+    rl_dqn::DQNLearner normalized(config);
+
+    env_flappy::FlappyEnv env(5);
+    env_flappy::Observation obs = env.reset(5);
+    std::vector<env_flappy::Observation> probes;
+    for (int t = 0; t < 200; ++t) {
+        env_flappy::Action action = t % 7 < 2 ? env_flappy::Action::FLAP
+                                              : env_flappy::Action::NO_FLAP;
+        env_flappy::StepResult step = env.step(action);
+        normalized.store({obs, action, step.reward, step.observation, step.done});
+        plain.store({normalize(obs), action, step.reward, normalize(step.observation),
+                     step.done});
+        probes.push_back(obs);
+        obs = step.done ? env.reset(t) : step.observation;
+        normalized.train();
+        plain.train();
+        if (t % 50 == 49) {
+            normalized.update_target_network();
+            plain.update_target_network();
+        }
+    }
+    REQUIRE(normalized.training_steps() > 100);
+
+    auto trained = normalized.network().parameters();
+    auto reference = plain.network().parameters();
+    REQUIRE(trained.size() == reference.size());
+    for (std::size_t i = 0; i < trained.size(); ++i) {
+        REQUIRE(trained[i] == Catch::Approx(reference[i]).margin(1e-5));
+    }
+
+    // Exported parameters act on raw observations without a transform, and a checkpoint
+    // of them restores the normalizing learner
+    rl_dqn::Network folded(config.layer_sizes);
+    std::span<const float> policy = normalized.policy_parameters();
+    std::copy(policy.begin(), policy.end(), folded.parameters().begin());
+    REQUIRE(!folded.has_input_transform());
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "flappyrl_normalized.ckpt").string();
+    rl_dqn::CheckpointContents contents = normalized.checkpoint_contents(true);
+    REQUIRE(normalized.policy_parameters().data() != contents.parameters.data());
+    rl_dqn::write_checkpoint(path, contents);
+    rl_dqn::DQNLearner restored(config);
+    restored.load_checkpoint(rl_dqn::Checkpoint(path));
+    std::filesystem::remove(path);
+
+    for (std::size_t k = 0; k < probes.size(); k += 10) {
+        std::vector<float> expected = plain.network().forward(input(normalize(probes[k])));
+        std::vector<float> q = normalized.network().forward(input(probes[k]));
+        std::vector<float> exported = folded.forward(input(probes[k]));
+        std::vector<float> resumed = restored.network().forward(input(probes[k]));
+        for (int a = 0; a < 2; ++a) {
+            REQUIRE(q[a] == Catch::Approx(expected[a]).margin(1e-5));
+            REQUIRE(exported[a] == Catch::Approx(expected[a]).margin(1e-4));
+            REQUIRE(resumed[a] == Catch::Approx(expected[a]).margin(1e-4));
+        }
+    }
+
+    config.layer_sizes = {3, 16, 2};
+    REQUIRE_THROWS_AS(rl_dqn::DQNLearner(config), std::invalid_argument);
+}
+
+TEST_CASE("Fixed Network Matches Runtime Network", "[dqn]") {
+    using Fixed = rl_dqn::FixedNetwork<4, 16, 8, 2>;
+    STATIC_REQUIRE(Fixed::kNumParameters == 16 * 5 + 8 * 17 + 2 * 9);
+    STATIC_REQUIRE(rl_dqn::DenseNetwork<Fixed>);
+
+    rl_dqn::Network network({4, 16, 8, 2}, 99);
+    Fixed fixed(99);
+    REQUIRE(std::equal(fixed.parameters().begin(), fixed.parameters().end(),
+                       network.parameters().begin(), network.parameters().end()));
+    REQUIRE(fixed.get_layer_sizes() == network.get_layer_sizes());
+    REQUIRE_THROWS_AS(Fixed({4, 16, 2}, 1), std::invalid_argument);
+
+    // 7 rows exercises both the tiled rows and the remainder
+    const int batch_size = 7;
+    std::vector<float> inputs(batch_size * 4);
+    std::vector<float> output_gradients(batch_size * 2);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = std::sin(0.53f * static_cast<float>(i));
+    }
+    for (std::size_t i = 0; i < output_gradients.size(); ++i) {
+        output_gradients[i] = std::cos(0.29f * static_cast<float>(i));
+    }
+
+    rl_dqn::Network::BatchCache cache;
+    rl_dqn::Network::BatchCache fixed_cache;
+    const float* expected = network.forward_batch(inputs, batch_size, cache);
+    const float* actual = fixed.forward_batch(inputs, batch_size, fixed_cache);
+    for (int i = 0; i < batch_size * 2; ++i) {
+        REQUIRE(actual[i] == Catch::Approx(expected[i]).margin(1e-5));
+    }
+
+    // backward_batch accumulates, so both start from the same non-zero gradient
+    std::vector<float> gradients(network.parameters().size(), 123.0f);
+    std::vector<float> fixed_gradients(fixed.parameters().size(), 123.0f);
+    network.backward_batch(cache, output_gradients, gradients);
+    fixed.backward_batch(fixed_cache, output_gradients, fixed_gradients);
+    for (std::size_t i = 0; i < gradients.size(); ++i) {
+        REQUIRE(fixed_gradients[i] == Catch::Approx(gradients[i]).margin(1e-4));
+    }
+
+    // Both apply an input transform the same way
+    const float scale[] = {2.0f, -0.5f, 1.5f, 4.0f};
+    const float shift[] = {-1.0f, 0.25f, 0.0f, 3.0f};
+    network.set_input_transform(scale, shift);
+    fixed.set_input_transform(scale, shift);
+    REQUIRE_THROWS_AS(fixed.set_input_transform(std::span(scale, 3), std::span(shift, 3)),
+                      std::invalid_argument);
+    expected = network.forward_batch(inputs, batch_size, cache);
+    actual = fixed.forward_batch(inputs, batch_size, fixed_cache);
+    for (int i = 0; i < batch_size * 2; ++i) {
+        REQUIRE(actual[i] == Catch::Approx(expected[i]).margin(1e-5));
+    }
+    network.backward_batch(cache, output_gradients, gradients);
+    fixed.backward_batch(fixed_cache, output_gradients, fixed_gradients);
+    for (std::size_t i = 0; i < gradients.size(); ++i) {
+        REQUIRE(fixed_gradients[i] == Catch::Approx(gradients[i]).margin(1e-4));
+    }
+}
+
+TEST_CASE("Fixed DQN Agent Follows The Runtime Agent", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.batch_size = 8;
+    config.replay_buffer_size = 64;
+
+    for (bool normalize : {false, true}) {
+        INFO("normalize_observations " << normalize);
+        config.normalize_observations = normalize;
+        rl_dqn::DQNAgent agent(config);
+        rl_dqn::FixedDQNAgent fixed_agent(config);
+        for (int i = 0; i < 32; ++i) {
+            float t = static_cast<float>(i);
+            env_flappy::Observation state{0.3f + 0.01f * t, std::sin(t), 1.0f - 0.02f * t, 0.1f};
+            env_flappy::Observation next = state;
+            next.y += 0.01f;
+            env_flappy::Action action = i % 3 == 0 ? env_flappy::Action::FLAP
+                                                   : env_flappy::Action::NO_FLAP;
+            agent.store_experience(state, action, 0.1f, next, i % 7 == 6);
+            fixed_agent.store_experience(state, action, 0.1f, next, i % 7 == 6);
+        }
+
+        // Same seeds, same replay samples: the two implementations differ only in rounding
+        for (int step = 0; step < 5; ++step) {
+            float loss = agent.train();
+            REQUIRE(fixed_agent.train() == Catch::Approx(loss).epsilon(1e-3));
+        }
+        env_flappy::Observation probe{0.5f, 0.0f, 0.4f, -0.1f};
+        std::vector<float> q = agent.get_q_values(probe);
+        std::vector<float> fixed_q = fixed_agent.get_q_values(probe);
+        REQUIRE(fixed_q[0] == Catch::Approx(q[0]).margin(1e-4));
+        REQUIRE(fixed_q[1] == Catch::Approx(q[1]).margin(1e-4));
+    }
+
+    config.layer_sizes = {4, 32, 2};
+    REQUIRE_THROWS_AS(rl_dqn::FixedDQNAgent(config), std::invalid_argument);
+}
+
+TEST_CASE("Quantized Network Tracks FP32 Q-Values", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    rl_dqn::DQNAgent agent(config);
+    rl_dqn::QuantizedNetwork quantized(agent.learner().network());
+
+    // A quarter of the weight bytes plus fp32 scales and biases
+    std::size_t fp32_bytes = agent.learner().network().parameters().size() * sizeof(float);
+    REQUIRE(quantized.size_bytes() * 3 < fp32_bytes);
+
+    // Observations from real rollouts so inputs cover the ranges actors see
+    env_flappy::FlappyEnv env(3);
+    std::vector<env_flappy::Observation> observations;
+    env_flappy::Observation obs = env.reset(3);
+    for (int t = 0; t < 600; ++t) {
+        observations.push_back(obs);
+        env_flappy::StepResult result =
+            env.step(t % 11 == 0 ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP);
+        obs = result.done ? env.reset(t) : result.observation;
+    }
+
+    rl_dqn::InferenceContext inference;
+    const float* q_int8 = inference.q_values(quantized, observations);
+    float max_error = 0.0f;
+    float max_q = 0.0f;
+    for (std::size_t i = 0; i < observations.size(); ++i) {
+        std::vector<float> q = agent.get_q_values(observations[i]);
+        for (int a = 0; a < 2; ++a) {
+            max_error = std::max(max_error, std::fabs(q_int8[i * 2 + a] - q[a]));
+            max_q = std::max(max_q, std::fabs(q[a]));
+        }
+    }
+    INFO("max error " << max_error << " max |q| " << max_q);
+    REQUIRE(max_error <= 0.02f * max_q + 1e-4f);
+
+    // Greedy actions agree wherever the fp32 Q-values are separated by more than the error
+    std::vector<env_flappy::Action> actions(observations.size());
+    inference.greedy_actions(quantized, observations, actions);
+    for (std::size_t i = 0; i < observations.size(); ++i) {
+        std::vector<float> q = agent.get_q_values(observations[i]);
+        if (std::fabs(q[1] - q[0]) > 2.0f * max_error) {
+            env_flappy::Action expected =
+                q[1] > q[0] ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP;
+            REQUIRE(actions[i] == expected);
+        }
+    }
+
+    REQUIRE_THROWS_AS(quantized.quantize(std::vector<float>(3)), std::invalid_argument);
+}
+
+TEST_CASE("DQN Network Batched Backward Matches Finite Differences", "[dqn]") {
+    rl_dqn::Network network({4, 6, 5, 2}, 4242);
+
+    const int batch_size = 3;
+    std::vector<float> inputs = {0.5f, -0.3f, 0.1f, 0.2f,
+                                 -0.4f, 0.8f, 0.6f, -0.1f,
+                                 0.9f, 0.2f, -0.7f, 0.3f};
+    std::vector<float> targets = {0.8f, 0.2f, -0.5f, 0.4f, 0.1f, 1.2f};
+
+    // Loss = 0.5 * sum (q - target)^2, so dLoss/dq = q - target
+    auto loss = [&](rl_dqn::Network& net) {
+        rl_dqn::Network::BatchCache c;
+        const float* q = net.forward_batch(inputs, batch_size, c);
+        double sum = 0.0;
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            sum += 0.5 * (q[i] - targets[i]) * (q[i] - targets[i]);
+        }
+        return sum;
+    };
+
+    rl_dqn::Network::BatchCache cache;
+    const float* q = network.forward_batch(inputs, batch_size, cache);
+    std::vector<float> output_gradients(targets.size());
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        output_gradients[i] = q[i] - targets[i];
+    }
+    std::vector<float> gradients(network.parameters().size());
+    network.backward_batch(cache, output_gradients, gradients);
+
+    auto params = network.parameters();
+    const float h = 1e-3f;
+    for (std::size_t p = 0; p < params.size(); ++p) {
+        float saved = params[p];
+        params[p] = saved + h;
+        double up = loss(network);
+        params[p] = saved - h;
+        double down = loss(network);
+        params[p] = saved;
+        double numeric = (up - down) / (2.0 * h);
+        REQUIRE(gradients[p] == Catch::Approx(numeric).margin(2e-3));
+    }
+}
+
+TEST_CASE("DQN Network Backward Accumulates Across Batches", "[dqn]") {
+    rl_dqn::Network network({4, 16, 8, 2}, 99);
+    const int batch_size = 6;
+    std::vector<float> inputs(batch_size * 4);
+    std::vector<float> output_gradients(batch_size * 2);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = std::sin(0.43f * static_cast<float>(i));
+    }
+    for (std::size_t i = 0; i < output_gradients.size(); ++i) {
+        output_gradients[i] = std::cos(0.31f * static_cast<float>(i));
+    }
+
+    rl_dqn::Network::BatchCache cache;
+    std::vector<float> whole(network.parameters().size(), 0.0f);
+    network.forward_batch(inputs, batch_size, cache);
+    network.backward_batch(cache, output_gradients, whole);
+
+    // Two half batches into one buffer sum to the gradient of the whole batch
+    const int half = batch_size / 2;
+    std::vector<float> halves(whole.size(), 0.0f);
+    for (int part = 0; part < 2; ++part) {
+        std::span<const float> in(inputs.data() + part * half * 4, half * 4);
+        std::span<const float> dq(output_gradients.data() + part * half * 2, half * 2);
+        network.forward_batch(in, half, cache);
+        network.backward_batch(cache, dq, halves);
+    }
+    for (std::size_t i = 0; i < whole.size(); ++i) {
+        REQUIRE(halves[i] == Catch::Approx(whole[i]).margin(1e-5));
+    }
+}
+
+TEST_CASE("Adam Optimizer Matches Reference Update", "[dqn]") {
+    const float lr = 0.01f, beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    rl_dqn::AdamOptimizer optimizer(lr, beta1, beta2, eps);
+
+    std::vector<float> params = {0.5f, -1.0f, 2.0f, 0.0f, 3.0f};
+    std::vector<double> expected(params.begin(), params.end());
+    std::vector<double> m(params.size(), 0.0), v(params.size(), 0.0);
+
+    for (int t = 1; t <= 3; ++t) {
+        std::vector<float> grads = {0.1f * t, -0.2f, 0.3f, 0.0f, -0.05f * t};
+        optimizer.update(params, grads);
+
+        // Textbook Adam with explicit bias correction
+        for (std::size_t i = 0; i < params.size(); ++i) {
+            m[i] = beta1 * m[i] + (1.0 - beta1) * grads[i];
+            v[i] = beta2 * v[i] + (1.0 - beta2) * grads[i] * grads[i];
+            double m_hat = m[i] / (1.0 - std::pow(beta1, t));
+            double v_hat = v[i] / (1.0 - std::pow(beta2, t));
+            expected[i] -= lr * m_hat / (std::sqrt(v_hat) + eps);
+        }
+        for (std::size_t i = 0; i < params.size(); ++i) {
+            REQUIRE(params[i] == Catch::Approx(expected[i]).margin(1e-5));
+        }
+    }
+    REQUIRE(optimizer.get_step() == 3);
+
+    std::vector<float> wrong_size(3, 0.0f);
+    REQUIRE_THROWS_AS(optimizer.update(params, wrong_size), std::invalid_argument);
+}
+
+TEST_CASE("Parallel Evaluation Is Independent Of Thread Count", "[dqn]") {
+    rl_dqn::Network network({4, 16, 2}, 7);
+    rl_dqn::EvalConfig config;
+    config.episodes = 37;  // last chunk is partial
+    config.batch = 4;
+    config.max_steps = 300;
+    config.seed = 100;
+
+    config.threads = 1;
+    std::vector<rl_dqn::EpisodeResult> serial = rl_dqn::evaluate_policy(network, config);
+    config.threads = 3;
+    std::vector<rl_dqn::EpisodeResult> parallel = rl_dqn::evaluate_policy(network, config);
+
+    REQUIRE(serial.size() == 37);
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        REQUIRE(serial[i].score == parallel[i].score);
+        REQUIRE(serial[i].pipes == parallel[i].pipes);
+        REQUIRE(serial[i].length == parallel[i].length);
+        REQUIRE(serial[i].truncated == parallel[i].truncated);
+        REQUIRE(serial[i].length <= config.max_steps);
+    }
+    REQUIRE(rl_dqn::summarize(serial).digest == rl_dqn::summarize(parallel).digest);
+
+    // Episode i is a plain greedy rollout of FlappyEnv(seed + i)
+    rl_dqn::InferenceContext inference;
+    for (std::size_t i : {std::size_t{0}, std::size_t{36}}) {
+        env_flappy::FlappyEnv env(config.seed + i);
+        env_flappy::Observation obs = env.observe();
+        float score = 0.0f;
+        int length = 0;
+        bool done = false;
+        while (!done && length < config.max_steps) {
+            env_flappy::Action action;
+            inference.greedy_actions(network, {&obs, 1}, {&action, 1});
+            env_flappy::StepResult step = env.step(action);
+            obs = step.observation;
+            score += step.reward;
+            done = step.done;
+            ++length;
+        }
+        REQUIRE(serial[i].length == length);
+        REQUIRE(serial[i].score == Catch::Approx(score));
+    }
+}
+
+TEST_CASE("Evaluation Recordings Replay Every Episode", "[dqn]") {
+    rl_dqn::Network network({4, 16, 2}, 7);
+    rl_dqn::EvalConfig config;
+    config.episodes = 9;
+    config.batch = 4;
+    config.max_steps = 300;
+    config.seed = 100;
+    config.threads = 2;
+    std::vector<env_flappy::EpisodeRecording> recordings;
+    std::vector<rl_dqn::EpisodeResult> results =
+        rl_dqn::evaluate_policy(network, config, &recordings);
+    REQUIRE(recordings.size() == results.size());
+
+    // Seed and actions alone rebuild each episode, with no network
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const env_flappy::EpisodeRecording& recording = recordings[i];
+        REQUIRE(recording.seed == config.seed + i);
+        REQUIRE(recording.length == static_cast<std::uint32_t>(results[i].length));
+        env_flappy::FlappyEnv env(recording.seed, config.env);
+        float score = 0.0f;
+        for (std::uint32_t step = 0; step < recording.length; ++step) {
+            REQUIRE_FALSE(env.done());
+            score += env.step(recording.action(step)).reward;
+        }
+        REQUIRE(env.done() == !results[i].truncated);
+        REQUIRE(score == results[i].score);
+    }
+}
+
+TEST_CASE("Evaluation Summary Percentiles", "[dqn]") {
+    std::vector<rl_dqn::EpisodeResult> results;
+    for (int i = 1; i <= 100; ++i) {
+        results.push_back({static_cast<float>(i), i, 10 * i, i == 100});
+    }
+    rl_dqn::EvalSummary summary = rl_dqn::summarize(results);
+    REQUIRE(summary.episodes == 100);
+    REQUIRE(summary.truncated == 1);
+    REQUIRE(summary.mean_score == Catch::Approx(50.5));
+    REQUIRE(summary.score_percentiles[0] == 5.0);
+    REQUIRE(summary.pipes_percentiles[2] == 50);
+    REQUIRE(summary.length_percentiles[4] == 950);
+    REQUIRE(summary.max_pipes == 100);
+}
+
+TEST_CASE("Training Steps Do Not Allocate", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.batch_size = 32;
+    config.replay_buffer_size = 256;
+    rl_dqn::DQNConfig extended = config;   // every optional path of train() at once
+    extended.prioritized_replay = true;
+    extended.double_dqn = true;
+    extended.n_step = 3;
+    extended.target_tau = 0.01f;
+    extended.normalize_observations = true;
+    rl_dqn::DQNConfig parallel = extended;
+    parallel.learner_threads = 3;
+
+    auto steady_state_allocations = [](auto& learner) {
+        for (int i = 0; i < 128; ++i) {
+            env_flappy::Observation state{0.01f * i, 0.2f, 0.8f - 0.005f * i, 0.1f};
+            env_flappy::Observation next{0.01f * i + 0.01f, 0.1f, 0.79f - 0.005f * i, 0.0f};
+            env_flappy::Action action = i % 3 == 0 ? env_flappy::Action::FLAP
+                                                   : env_flappy::Action::NO_FLAP;
+            learner.store(rl_dqn::Experience{state, action, 0.1f, next, i % 50 == 49});
+        }
+        learner.train();  // first step sizes the optimizer moments and sampler scratch
+        std::size_t before = g_allocations.load();
+        for (int i = 0; i < 50; ++i) {
+            learner.train();
+        }
+        return g_allocations.load() - before;
+    };
+
+    rl_dqn::DQNLearner learner(config);
+    rl_dqn::FixedDQNLearner fixed_learner(config);
+    rl_dqn::DQNLearner extended_learner(extended);
+    rl_dqn::FixedDQNLearner extended_fixed_learner(extended);
+    REQUIRE(steady_state_allocations(learner) == 0);
+    REQUIRE(steady_state_allocations(fixed_learner) == 0);
+    REQUIRE(steady_state_allocations(extended_learner) == 0);
+    REQUIRE(steady_state_allocations(extended_fixed_learner) == 0);
+    // Pool workers register a telemetry slot the first time they run a shard, which a helper
+    // that lost every shard to stealing so far may still do; nothing else may allocate
+    rl_dqn::FixedDQNLearner parallel_learner(parallel);
+    REQUIRE(steady_state_allocations(parallel_learner) <=
+            static_cast<std::size_t>(parallel.learner_threads - 1));
+}
+
+TEST_CASE("Data-Parallel Learner Is Deterministic Per Thread Count", "[dqn]") {
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 16, 16, 2};
+    config.batch_size = 37;  // uneven shards
+    config.replay_buffer_size = 200;
+    config.double_dqn = true;
+    rl_dqn::DQNConfig parallel = config;
+    parallel.learner_threads = 4;
+
+    rl_dqn::DQNLearner serial(config);
+    rl_dqn::DQNLearner first(parallel);
+    rl_dqn::DQNLearner second(parallel);
+    for (int i = 0; i < 150; ++i) {
+        float t = static_cast<float>(i);
+        env_flappy::Observation state{0.5f + 0.3f * std::sin(t), std::cos(t), 1.0f - 0.005f * t,
+                                      0.1f * std::sin(0.7f * t)};
+        env_flappy::Observation next{state.y + 0.01f, state.vy - 0.1f, state.dx_to_pipe - 0.01f,
+                                     state.dy_to_gap};
+        rl_dqn::Experience exp{state, i % 2 ? env_flappy::Action::FLAP
+                                            : env_flappy::Action::NO_FLAP,
+                               0.1f, next, i % 40 == 39};
+        serial.store(exp);
+        first.store(exp);
+        second.store(exp);
+    }
+
+    for (int step = 0; step < 20; ++step) {
+        float serial_loss = serial.train();
+        float loss = first.train();
+        REQUIRE(second.train() == loss);
+        REQUIRE(loss == Catch::Approx(serial_loss).epsilon(1e-4));
+    }
+
+    // Same thread count: bit-identical. Against one thread only the summation order differs.
+    auto a = first.network().parameters();
+    auto b = second.network().parameters();
+    auto reference = serial.network().parameters();
+    REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        REQUIRE(a[i] == Catch::Approx(reference[i]).margin(1e-4));
+    }
+
+    config.learner_threads = 0;
+    REQUIRE_THROWS_AS(rl_dqn::DQNLearner(config), std::invalid_argument);
+}
+
+TEST_CASE("Wire Format Round-Trips Transitions And Snapshots", "[dqn]") {
+    namespace wire = rl_dqn::wire;
+    std::vector<rl_dqn::Experience> sent;
+    for (int i = 0; i < 5; ++i) {
+        float t = static_cast<float>(i);
+        sent.push_back({{0.1f * t, -0.2f, 0.3f + t, 0.4f},
+                        i % 2 ? env_flappy::Action::FLAP : env_flappy::Action::NO_FLAP,
+                        0.5f * t - 1.0f,
+                        {0.5f, 0.6f * t, 0.7f, -0.8f},
+                        i == 3});
+    }
+    std::vector<std::byte> payload;
+    wire::encode_experiences(sent, {2, 7, 13.5}, payload);
+    REQUIRE(payload.size() == 20 + 37 * sent.size());
+
+    std::vector<rl_dqn::Experience> received;
+    wire::EpisodeStats stats = wire::decode_experiences(payload, received);
+    REQUIRE(stats.episodes == 2);
+    REQUIRE(stats.pipes == 7);
+    REQUIRE(stats.return_sum == 13.5);
+    REQUIRE(received.size() == sent.size());
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+        REQUIRE(received[i].state.dx_to_pipe == sent[i].state.dx_to_pipe);
+        REQUIRE(received[i].next_state.vy == sent[i].next_state.vy);
+        REQUIRE(received[i].reward == sent[i].reward);
+        REQUIRE(received[i].action == sent[i].action);
+        REQUIRE(received[i].done == sent[i].done);
+    }
+    payload.pop_back();
+    REQUIRE_THROWS_AS(wire::decode_experiences(payload, received), std::runtime_error);
+
+    // fp32 snapshots are exact; int8 ones are within half a quantization step per weight
+    rl_dqn::Network network({4, 64, 64, 2}, 3);
+    std::span<const float> params = network.parameters();
+    std::vector<float> decoded(params.size());
+    wire::encode_snapshot(params, {4, 64, 64, 2}, {9, 0.25f, wire::SnapshotEncoding::kFloat32},
+                          payload);
+    wire::SnapshotInfo info = wire::decode_snapshot(payload, {4, 64, 64, 2}, decoded);
+    REQUIRE(info.version == 9);
+    REQUIRE(info.epsilon == 0.25f);
+    REQUIRE(std::equal(decoded.begin(), decoded.end(), params.begin(), params.end()));
+
+    std::size_t fp32_bytes = payload.size();
+    wire::encode_snapshot(params, {4, 64, 64, 2}, {10, 0.25f, wire::SnapshotEncoding::kInt8},
+                          payload);
+    REQUIRE(payload.size() < fp32_bytes / 2);
+    info = wire::decode_snapshot(payload, {4, 64, 64, 2}, decoded);
+    REQUIRE(info.encoding == wire::SnapshotEncoding::kInt8);
+    rl_dqn::QuantizedNetwork quantized(network);
+    for (std::size_t l = 0; l < network.num_layers(); ++l) {
+        rl_dqn::ConstLayerView layer = network.layer(l);
+        const float* w = decoded.data() + network.layer_offset(l);
+        for (int o = 0; o < layer.fan_out; ++o) {
+            float step = quantized.scales(l)[o];
+            for (int j = 0; j < layer.fan_in; ++j) {
+                std::size_t k = static_cast<std::size_t>(o) * layer.fan_in + j;
+                REQUIRE(std::fabs(w[k] - layer.weights[k]) <= 0.5f * step + 1e-7f);
+            }
+            REQUIRE(w[layer.fan_out * layer.fan_in + o] == layer.biases[o]);
+        }
+    }
+
+    wire::ActorConfig config;
+    config.actor_id = 4;
+    config.seed = 77;
+    config.n_step = 3;
+    config.encoding = wire::SnapshotEncoding::kInt8;
+    config.layer_sizes = {4, 16, 2};
+    wire::encode_config(config, payload);
+    wire::ActorConfig round_trip = wire::decode_config(payload);
+    REQUIRE(round_trip.actor_id == 4);
+    REQUIRE(round_trip.seed == 77);
+    REQUIRE(round_trip.n_step == 3);
+    REQUIRE(round_trip.encoding == wire::SnapshotEncoding::kInt8);
+    REQUIRE(round_trip.layer_sizes == config.layer_sizes);
+
+    // Layer sizes are capped, and so is the snapshot the network would need
+    config.layer_sizes = {4, std::numeric_limits<std::int32_t>::max(), 2};
+    wire::encode_config(config, payload);
+    REQUIRE_THROWS_AS(wire::decode_config(payload), std::runtime_error);
+    config.layer_sizes = {4, 8192, 8192, 2};
+    wire::encode_config(config, payload);
+    REQUIRE_THROWS_AS(wire::decode_config(payload), std::runtime_error);
+}
+
+TEST_CASE("Remote Actors Stream Transitions To The Learner", "[dqn]") {
+    // Poll `done` for up to five seconds; the I/O threads run on their own schedule
+    auto eventually = [](auto done) {
+        for (int i = 0; i < 5000 && !done(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+
+    rl_dqn::DQNConfig config;
+    config.layer_sizes = {4, 8, 2};
+    rl_dqn::wire::ActorConfig actor_config;
+    actor_config.layer_sizes = config.layer_sizes;
+    auto server = std::make_unique<rl_dqn::ActorServer>(0, actor_config, 5);
+    rl_dqn::LearnerClient client("127.0.0.1", server->port(), 1);
+    REQUIRE(client.config().actor_id == 5);
+    REQUIRE(client.config().layer_sizes == config.layer_sizes);
+
+    rl_dqn::Network network(config.layer_sizes, 11);
+    server->broadcast(network.parameters(), 0.5f);
+    REQUIRE(eventually([&] { return client.snapshot().version() == 1; }));
+    REQUIRE(client.epsilon() == 0.5f);
+    rl_dqn::Policy policy(config, 1);
+    client.snapshot().read(policy);
+    auto a = policy.network().parameters();
+    auto b = network.parameters();
+    REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    const int count = 3000;  // more than one frame
+    for (int i = 0; i < count; ++i) {
+        env_flappy::Observation state{static_cast<float>(i), 0.0f, 0.0f, 0.0f};
+        REQUIRE(client.push({state, env_flappy::Action::FLAP, 1.0f, state, false}));
+    }
+    client.add_episode(4.5, 2);
+    REQUIRE(client.push({{}, env_flappy::Action::NO_FLAP, 0.0f, {}, true}));
+
+    std::vector<rl_dqn::Experience> received(count + 1);
+    std::size_t total = 0;
+    REQUIRE(eventually([&] {
+        total += server->poll(received.data() + total, received.size() - total);
+        return total == received.size();
+    }));
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(received[i].state.y == static_cast<float>(i));
+    }
+    REQUIRE(received[count].done);
+    REQUIRE(eventually([&] { return server->stats().episodes == 1; }));
+    REQUIRE(server->stats().return_sum == 4.5);
+    REQUIRE(server->num_connections() == 1);
+
+    // Shutting the learner down disconnects its actors
+    server.reset();
+    REQUIRE(eventually([&] { return !client.connected(); }));
+}
+
+TEST_CASE("Sweep Specs Expand Into Grid And Random Trials", "[dqn]") {
+    std::istringstream grid_text("# grid\n"
+                                 "gamma = 0.9, 0.99\n"
+                                 "  hidden = 16, 32, 64   # both hidden layers\n"
+                                 "double_dqn = true\n");
+    rl_dqn::SweepSpec grid = rl_dqn::parse_sweep_spec(grid_text);
+    REQUIRE(grid.parameters.size() == 3);
+    REQUIRE(!grid.is_random());
+
+    rl_dqn::DQNConfig base;
+    base.seed = 100;
+    std::vector<rl_dqn::SweepTrial> trials = rl_dqn::expand_sweep(grid, base, 5, 1);
+    REQUIRE(trials.size() == 6);
+    // Values as applied: gamma is stored as a float
+    REQUIRE(trials[1].values == std::vector<double>{0.9f, 32.0, 1.0});
+    REQUIRE(trials[5].config.gamma == 0.99f);
+    REQUIRE(trials[5].config.layer_sizes == std::vector<int>{4, 64, 64, 2});
+    REQUIRE(trials[5].config.double_dqn);
+    REQUIRE(trials[5].config.seed == 105);
+
+    std::istringstream random_text("learning_rate = log_uniform(1e-5, 1e-3)\n"
+                                   "batch_size = uniform(16, 128)\n"
+                                   "double_dqn = false, true\n");
+    rl_dqn::SweepSpec random = rl_dqn::parse_sweep_spec(random_text);
+    REQUIRE(random.is_random());
+    std::vector<rl_dqn::SweepTrial> samples = rl_dqn::expand_sweep(random, base, 64, 7);
+    REQUIRE(samples.size() == 64);
+    int double_dqn = 0;
+    for (const rl_dqn::SweepTrial& trial : samples) {
+        REQUIRE(trial.config.learning_rate >= 1e-5f);
+        REQUIRE(trial.config.learning_rate <= 1e-3f);
+        REQUIRE(trial.config.batch_size >= 16);
+        REQUIRE(trial.config.batch_size <= 128);
+        REQUIRE(trial.values[1] == static_cast<double>(trial.config.batch_size));
+        double_dqn += trial.config.double_dqn ? 1 : 0;
+    }
+    REQUIRE(double_dqn > 0);
+    REQUIRE(double_dqn < 64);
+    REQUIRE(rl_dqn::expand_sweep(random, base, 64, 7)[9].values == samples[9].values);
+
+    for (const char* bad : {"gamma 0.9\n", "gamma = 1.5\n", "lr = 0.1\n",
+                            "gamma = 0.9\ngamma = 0.99\n", "learning_rate = log_uniform(0, 1)\n",
+                            "batch_size = uniform(64, 32)\n", "double_dqn = 2\n"}) {
+        std::istringstream text(bad);
+        REQUIRE_THROWS_AS(rl_dqn::parse_sweep_spec(text), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Median Stopping Rule Stops Trials Below The Round Median", "[dqn]") {
+    rl_dqn::MedianStoppingRule rule(3, 1);
+    // Round 0 is a grace round
+    REQUIRE(rule.report(0, -5.0));
+    for (double score : {1.0, 2.0, 3.0}) {
+        REQUIRE(rule.report(1, score));     // too few reports to compare against
+    }
+    REQUIRE(rule.report(1, 2.0));           // at the median of {1, 2, 3}
+    REQUIRE(!rule.report(1, 1.5));          // below the median of {1, 2, 2, 3}
+    REQUIRE(rule.report(2, -10.0));         // a new round starts without reports
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include "env_flappy/env_flappy.h"
+#include "env_flappy/recording.h"
+#include "env_flappy/vec_env.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using env_flappy::Action;
+using env_flappy::Observation;
+
+TEST_CASE("FlappyEnv copies are independent snapshots", "[env]") {
+    STATIC_REQUIRE(std::is_trivially_copyable_v<env_flappy::FlappyEnv>);
+
+    env_flappy::FlappyEnv env(7);
+    for (int t = 0; t < 150 && !env.done(); ++t) {
+        env.step(t % 9 == 0 ? Action::FLAP : Action::NO_FLAP);
+    }
+    env_flappy::FlappyEnv snapshot = env;
+
+    // Both copies must continue identically, including across pipe retirement and respawn
+    for (int t = 0; t < 400; ++t) {
+        Action action = t % 9 == 0 ? Action::FLAP : Action::NO_FLAP;
+        env_flappy::StepResult a = env.step(action);
+        env_flappy::StepResult b = snapshot.step(action);
+        REQUIRE(a.reward == b.reward);
+        REQUIRE(a.done == b.done);
+        REQUIRE(a.observation.dx_to_pipe == b.observation.dx_to_pipe);
+        REQUIRE(a.observation.dy_to_gap == b.observation.dy_to_gap);
+        if (a.done) {
+            env.reset(t);
+            snapshot.reset(t);
+        }
+    }
+}
+
+TEST_CASE("Saved env states branch and restore exactly", "[env]") {
+    STATIC_REQUIRE(std::is_trivially_copyable_v<env_flappy::EnvState>);
+    STATIC_REQUIRE(sizeof(env_flappy::EnvState) <= 128);
+
+    // Flap when below the gap and not already rising fast
+    auto steer = [](const Observation& o) {
+        return o.dy_to_gap > 0.0f && o.vy < 0.2f ? Action::FLAP : Action::NO_FLAP;
+    };
+    env_flappy::FlappyEnv env(11);
+    Observation observation = env.observe();
+    for (int t = 0; t < 120; ++t) {
+        observation = env.step(steer(observation)).observation;
+    }
+    REQUIRE(!env.done());
+    const env_flappy::EnvState root = env.save_state();
+
+    // Roll out both first actions from the same root, across pipe respawns (new gap samples)
+    auto rollout = [&](env_flappy::FlappyEnv& e, Action first) {
+        std::vector<Observation> trajectory{e.step(first).observation};
+        while (trajectory.size() < 300 && !e.done()) {
+            trajectory.push_back(e.step(steer(trajectory.back())).observation);
+        }
+        return trajectory;
+    };
+    env.restore_state(root);
+    std::vector<Observation> flap = rollout(env, Action::FLAP);
+    env.restore_state(root);
+    std::vector<Observation> glide = rollout(env, Action::NO_FLAP);
+    REQUIRE(flap.front().vy != glide.front().vy);
+
+    // Restoring into an env with another seed continues the saved episode, not its own
+    env_flappy::FlappyEnv other(999);
+    other.restore_state(root);
+    REQUIRE(other.steps() == 120);
+    std::vector<Observation> replayed = rollout(other, Action::FLAP);
+    REQUIRE(replayed.size() == flap.size());
+    for (std::size_t t = 0; t < flap.size(); ++t) {
+        REQUIRE(replayed[t].y == flap[t].y);
+        REQUIRE(replayed[t].dx_to_pipe == flap[t].dx_to_pipe);
+        REQUIRE(replayed[t].dy_to_gap == flap[t].dy_to_gap);
+    }
+}
+
+TEST_CASE("FlappyVecEnv matches independent FlappyEnv instances", "[env]") {
+    const std::size_t num_envs = 7;
+    const std::uint64_t seed = 99;
+    env_flappy::FlappyVecEnv vec_env(num_envs, seed);
+
+    std::vector<env_flappy::FlappyEnv> envs;
+    std::vector<std::uint64_t> expected_seeds;
+    for (std::size_t i = 0; i < num_envs; ++i) {
+        REQUIRE(vec_env.episode_seed(i) == seed + i);
+        envs.emplace_back(seed + i);
+        expected_seeds.push_back(seed + i);
+    }
+
+    std::vector<Action> actions(num_envs);
+    std::vector<Observation> observations(num_envs);
+    std::vector<float> rewards(num_envs);
+    std::vector<std::uint8_t> dones(num_envs);
+
+    std::uint32_t lcg = 12345;
+    std::uint64_t episodes = 0;
+    for (int t = 0; t < 2000; ++t) {
+        for (std::size_t i = 0; i < num_envs; ++i) {
+            lcg = lcg * 1664525u + 1013904223u;
+            actions[i] = (lcg >> 28) < 3 ? Action::FLAP : Action::NO_FLAP;
+        }
+        vec_env.step(actions, observations, rewards, dones);
+
+        for (std::size_t i = 0; i < num_envs; ++i) {
+            INFO("step " << t << " env " << i);
+            env_flappy::StepResult expected = envs[i].step(actions[i]);
+            REQUIRE(rewards[i] == expected.reward);
+            REQUIRE(static_cast<bool>(dones[i]) == expected.done);
+
+            Observation reference = expected.observation;
+            if (expected.done) {
+                expected_seeds[i] += num_envs;
+                REQUIRE(vec_env.episode_seed(i) == expected_seeds[i]);
+                reference = envs[i].reset(vec_env.episode_seed(i));
+                ++episodes;
+            }
+            REQUIRE(observations[i].y == reference.y);
+            REQUIRE(observations[i].vy == reference.vy);
+            REQUIRE(observations[i].dx_to_pipe == reference.dx_to_pipe);
+            REQUIRE(observations[i].dy_to_gap == reference.dy_to_gap);
+            REQUIRE(vec_env.steps(i) == envs[i].steps());
+        }
+    }
+
+    REQUIRE(episodes > 0);
+    REQUIRE(vec_env.episodes_completed() == episodes);
+}
+
+TEST_CASE("FlappyVecEnv writes observation matrix rows in schema order", "[env]") {
+    using Schema = env_flappy::ObservationSchema;
+    STATIC_REQUIRE(Schema::kSize == 4);
+    STATIC_REQUIRE(Schema::kNames[Schema::kDxToPipe] == "dx_to_pipe");
+    STATIC_REQUIRE(Schema::scale(Schema::kY) * Schema::kLow[Schema::kY] +
+                       Schema::shift(Schema::kY) == -1.0f);
+    STATIC_REQUIRE(Schema::scale(Schema::kY) * Schema::kHigh[Schema::kY] +
+                       Schema::shift(Schema::kY) == 1.0f);
+
+    const std::size_t num_envs = 5;
+    env_flappy::FlappyVecEnv structs(num_envs, 17);
+    env_flappy::FlappyVecEnv matrix(num_envs, 17);
+    std::vector<Observation> observations(num_envs);
+    std::vector<float> rows(num_envs * Schema::kSize);
+    std::vector<Action> actions(num_envs);
+    std::vector<float> rewards(num_envs);
+    std::vector<float> matrix_rewards(num_envs);
+    std::vector<std::uint8_t> dones(num_envs);
+    std::vector<std::uint8_t> matrix_dones(num_envs);
+
+    structs.reset(3, observations);
+    matrix.reset(3, rows);
+    for (int t = 0; t < 600; ++t) {
+        for (std::size_t i = 0; i < num_envs; ++i) {
+            INFO("step " << t << " env " << i);
+            const float* row = rows.data() + i * Schema::kSize;
+            REQUIRE(row[Schema::kY] == observations[i].y);
+            REQUIRE(row[Schema::kVy] == observations[i].vy);
+            REQUIRE(row[Schema::kDxToPipe] == observations[i].dx_to_pipe);
+            REQUIRE(row[Schema::kDyToGap] == observations[i].dy_to_gap);
+            actions[i] = (t + i) % 9 < 2 ? Action::FLAP : Action::NO_FLAP;
+        }
+        structs.step(actions, observations, rewards, dones);
+        matrix.step(actions, rows, matrix_rewards, matrix_dones);
+        REQUIRE(rewards == matrix_rewards);
+        REQUIRE(dones == matrix_dones);
+    }
+    REQUIRE(matrix.episodes_completed() > 0);
+
+    std::vector<float> observed(rows.size());
+    matrix.observe(observed);
+    REQUIRE(observed == rows);
+    REQUIRE_THROWS_AS(matrix.observe(std::span<float>(observed.data(), 4)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Configs that overflow the pipe ring are rejected", "[env]") {
+    env_flappy::Config config;
+    config.pipe_spacing = 0.1f;
+    REQUIRE_THROWS_AS(env_flappy::FlappyEnv(1, config), std::invalid_argument);
+    REQUIRE_THROWS_AS(env_flappy::FlappyVecEnv(4, 1, config), std::invalid_argument);
+    REQUIRE_THROWS_AS(env_flappy::FlappyVecEnv(0, 1), std::invalid_argument);
+}
+
+TEST_CASE("Recordings round-trip seeds, actions and the config", "[env]") {
+    std::vector<env_flappy::EpisodeRecording> episodes(3);
+    for (std::size_t e = 0; e < episodes.size(); ++e) {
+        episodes[e].seed = 1000 + e;
+        for (std::size_t step = 0; step < 64 * e + 7; ++step) {  // 7, 71 and 135 steps
+            episodes[e].push(step % (e + 2) == 0 ? Action::FLAP : Action::NO_FLAP);
+        }
+    }
+    REQUIRE(episodes[2].action_bits.size() == 3);
+
+    env_flappy::Config config;
+    config.pipe_gap = 0.3f;
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "flappy_test.recording").string();
+    env_flappy::write_recording(path, config, episodes);
+    env_flappy::Recording loaded = env_flappy::read_recording(path);
+    REQUIRE(loaded.config.pipe_gap == 0.3f);
+    REQUIRE(loaded.episodes.size() == 3);
+    for (std::size_t e = 0; e < episodes.size(); ++e) {
+        REQUIRE(loaded.episodes[e].seed == episodes[e].seed);
+        REQUIRE(loaded.episodes[e].length == episodes[e].length);
+        for (std::size_t step = 0; step < episodes[e].length; ++step) {
+            REQUIRE(loaded.episodes[e].action(step) ==
+                    (step % (e + 2) == 0 ? Action::FLAP : Action::NO_FLAP));
+        }
+    }
+
+    // Cut into the last episode's actions
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS_AS(env_flappy::read_recording(path), std::runtime_error);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a recording at all";
+    REQUIRE_THROWS_AS(env_flappy::read_recording(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,197 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "rl_dqn/kernels.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+std::vector<float> make_data(std::size_t n, float phase) {
+    std::vector<float> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = std::sin(0.71f * static_cast<float>(i) + phase);
+    }
+    return v;
+}
+
+void require_close(const std::vector<float>& a, const std::vector<float>& b) {
+    REQUIRE(a.size() == b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        REQUIRE(a[i] == Catch::Approx(b[i]).margin(1e-4));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Kernel dispatch picks a supported table", "[kernels]") {
+    auto tables = rl_dqn::kernels::available();
+    REQUIRE(!tables.empty());
+    REQUIRE(std::strcmp(tables.front()->name, "scalar") == 0);
+    REQUIRE(rl_dqn::kernels::find(rl_dqn::kernels::active().name) != nullptr);
+    REQUIRE(rl_dqn::kernels::find("no-such-isa") == nullptr);
+}
+
+TEST_CASE("SIMD kernels match the scalar reference", "[kernels]") {
+    const rl_dqn::kernels::KernelTable& ref = *rl_dqn::kernels::find("scalar");
+
+    // Narrow, wide, odd and tail-heavy shapes
+    const int shapes[][3] = {{1, 4, 128}, {7, 4, 128}, {5, 128, 128},
+                             {8, 128, 2}, {9, 17, 13}, {3, 5, 3}};
+
+    for (const rl_dqn::kernels::KernelTable* table : rl_dqn::kernels::available()) {
+        for (const auto& shape : shapes) {
+            const int batch = shape[0], in = shape[1], out = shape[2];
+            INFO(table->name << " batch=" << batch << " in=" << in << " out=" << out);
+
+            auto w = make_data(static_cast<std::size_t>(out) * in, 0.1f);
+            auto b = make_data(out, 0.2f);
+            auto x = make_data(static_cast<std::size_t>(batch) * in, 0.3f);
+            auto dy = make_data(static_cast<std::size_t>(batch) * out, 0.4f);
+            dy[0] = 0.0f;  // exercise the skipped-zero path
+
+            for (bool relu : {false, true}) {
+                std::vector<float> y_ref(static_cast<std::size_t>(batch) * out);
+                std::vector<float> y(y_ref.size());
+                ref.dense_forward(w.data(), b.data(), x.data(), y_ref.data(), batch, in, out, relu);
+                table->dense_forward(w.data(), b.data(), x.data(), y.data(), batch, in, out, relu);
+                require_close(y, y_ref);
+            }
+
+            // Parameter kernels accumulate, so both start from the same non-zero gradient
+            std::vector<float> dw_ref(w.size(), 9.0f), db_ref(b.size(), 9.0f);
+            std::vector<float> dw(w.size(), 9.0f), db(b.size(), 9.0f);
+            ref.dense_backward_params(x.data(), dy.data(), dw_ref.data(), db_ref.data(),
+                                      batch, in, out);
+            table->dense_backward_params(x.data(), dy.data(), dw.data(), db.data(),
+                                         batch, in, out);
+            require_close(dw, dw_ref);
+            require_close(db, db_ref);
+
+            for (bool mask : {false, true}) {
+                std::vector<float> dx_ref(x.size()), dx(x.size(), 9.0f);
+                ref.dense_backward_input(w.data(), x.data(), dy.data(), dx_ref.data(),
+                                         batch, in, out, mask);
+                table->dense_backward_input(w.data(), x.data(), dy.data(), dx.data(),
+                                            batch, in, out, mask);
+                require_close(dx, dx_ref);
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD quantized kernels match the scalar reference", "[kernels]") {
+    const rl_dqn::kernels::KernelTable& ref = *rl_dqn::kernels::find("scalar");
+    const int shapes[][3] = {{1, 4, 128}, {7, 4, 128}, {5, 128, 128},
+                             {8, 128, 2}, {9, 37, 13}, {3, 5, 19}};
+
+    for (const rl_dqn::kernels::KernelTable* table : rl_dqn::kernels::available()) {
+        for (const auto& shape : shapes) {
+            const int batch = shape[0], in = shape[1], out = shape[2];
+            INFO(table->name << " batch=" << batch << " in=" << in << " out=" << out);
+
+            std::vector<std::int8_t> w(static_cast<std::size_t>(out) * in);
+            for (std::size_t i = 0; i < w.size(); ++i) {
+                w[i] = static_cast<std::int8_t>(static_cast<int>(i * 37 % 255) - 127);
+            }
+            auto scales = make_data(out, 0.7f);
+            auto b = make_data(out, 0.2f);
+            auto x = make_data(static_cast<std::size_t>(batch) * in, 0.3f);
+
+            for (bool relu : {false, true}) {
+                std::vector<float> y_ref(static_cast<std::size_t>(batch) * out);
+                std::vector<float> y(y_ref.size(), 9.0f);
+                ref.quantized_dense_forward(w.data(), scales.data(), b.data(), x.data(),
+                                            y_ref.data(), batch, in, out, relu);
+                table->quantized_dense_forward(w.data(), scales.data(), b.data(), x.data(),
+                                               y.data(), batch, in, out, relu);
+                REQUIRE(y.size() == y_ref.size());
+                for (std::size_t i = 0; i < y.size(); ++i) {
+                    REQUIRE(y[i] == Catch::Approx(y_ref[i]).epsilon(1e-5).margin(1e-3));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Fixed-shape kernels match the general kernels", "[kernels]") {
+    using rl_dqn::kernels::kFixedTopology;
+    const int batch = 6;
+
+    for (const rl_dqn::kernels::KernelTable* table : rl_dqn::kernels::available()) {
+        for (int l = 0; l < rl_dqn::kernels::kNumFixedLayers; ++l) {
+            const int in = kFixedTopology[l], out = kFixedTopology[l + 1];
+            const bool relu = l + 1 < rl_dqn::kernels::kNumFixedLayers;
+            const rl_dqn::kernels::FixedLayerKernels& fixed = table->fixed.layers[l];
+            INFO(table->name << " layer " << l);
+
+            auto w = make_data(static_cast<std::size_t>(out) * in, 0.1f);
+            auto b = make_data(out, 0.2f);
+            auto x = make_data(static_cast<std::size_t>(batch) * in, 0.3f);
+            auto dy = make_data(static_cast<std::size_t>(batch) * out, 0.4f);
+
+            std::vector<float> y_ref(static_cast<std::size_t>(batch) * out), y(y_ref.size());
+            table->dense_forward(w.data(), b.data(), x.data(), y_ref.data(), batch, in, out, relu);
+            fixed.forward(w.data(), b.data(), x.data(), y.data(), batch);
+            require_close(y, y_ref);
+
+            // Parameter kernels accumulate, so both start from the same non-zero gradient
+            std::vector<float> dw_ref(w.size(), 9.0f), db_ref(b.size(), 9.0f);
+            std::vector<float> dw(w.size(), 9.0f), db(b.size(), 9.0f);
+            table->dense_backward_params(x.data(), dy.data(), dw_ref.data(), db_ref.data(),
+                                         batch, in, out);
+            fixed.backward_params(x.data(), dy.data(), dw.data(), db.data(), batch);
+            require_close(dw, dw_ref);
+            require_close(db, db_ref);
+
+            if (l == 0) {
+                REQUIRE(fixed.backward_input == nullptr);
+                continue;
+            }
+            std::vector<float> dx_ref(x.size()), dx(x.size(), 9.0f);
+            table->dense_backward_input(w.data(), x.data(), dy.data(), dx_ref.data(), batch, in,
+                                        out, true);
+            fixed.backward_input(w.data(), x.data(), dy.data(), dx.data(), batch);
+            require_close(dx, dx_ref);
+        }
+    }
+}
+
+TEST_CASE("SIMD Adam kernels match the scalar reference", "[kernels]") {
+    const rl_dqn::kernels::KernelTable& ref = *rl_dqn::kernels::find("scalar");
+    rl_dqn::kernels::AdamStep step{0.9f, 0.999f, 1e-3f, 1e-8f};
+
+    for (const rl_dqn::kernels::KernelTable* table : rl_dqn::kernels::available()) {
+        INFO(table->name);
+        const std::size_t n = 37;  // not a multiple of any vector width
+        auto grads = make_data(n, 0.5f);
+        auto p_ref = make_data(n, 0.6f);
+        auto p = p_ref;
+        std::vector<float> m_ref(n, 0.01f), v_ref(n, 0.02f);
+        auto m = m_ref;
+        auto v = v_ref;
+
+        ref.adam_update(p_ref.data(), grads.data(), m_ref.data(), v_ref.data(), n, step);
+        table->adam_update(p.data(), grads.data(), m.data(), v.data(), n, step);
+        require_close(p, p_ref);
+        require_close(m, m_ref);
+        require_close(v, v_ref);
+    }
+}
+
+TEST_CASE("SIMD Polyak kernels match the scalar reference", "[kernels]") {
+    const rl_dqn::kernels::KernelTable& ref = *rl_dqn::kernels::find("scalar");
+
+    for (const rl_dqn::kernels::KernelTable* table : rl_dqn::kernels::available()) {
+        INFO(table->name);
+        const std::size_t n = 37;  // not a multiple of any vector width
+        auto source = make_data(n, 0.5f);
+        auto target_ref = make_data(n, 0.6f);
+        auto target = target_ref;
+
+        ref.polyak_update(target_ref.data(), source.data(), n, 0.005f);
+        table->polyak_update(target.data(), source.data(), n, 0.005f);
+        require_close(target, target_ref);
+    }
+}